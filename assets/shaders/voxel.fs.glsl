@@ -0,0 +1,18 @@
+#version 460
+
+layout(location =  4) uniform sampler2D noise;
+layout(location =  5) uniform vec2 chunk_origin;
+layout(location =  6) uniform float chunk_extent;
+
+in vec2 grid_pos;
+in vec3 out_back;
+in vec3 out_spot;
+in float out_fac;
+
+out vec4 frag_color;
+
+void main() {
+    // the tiered noise is baked per chunk (see bake_tiered_perlin); the texture starts at the corner of the first tile
+    float value = texture(noise, (grid_pos - chunk_origin + 0.5) / chunk_extent).r;
+    frag_color = vec4(mix(out_back, out_spot, out_fac * value), 1.0);
+}
\ No newline at end of file
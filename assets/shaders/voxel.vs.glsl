@@ -0,0 +1,23 @@
+#version 460
+
+layout(location =  0) in vec2 pos;
+layout(location =  1) in vec3 back;
+layout(location =  2) in vec3 spot;
+layout(location =  3) in float fac;
+layout(location =  4) in vec2 center;
+
+layout(location =  1) uniform mat4 view;
+layout(location =  2) uniform mat4 projection;
+
+out vec2 grid_pos;
+out vec3 out_back;
+out vec3 out_spot;
+out float out_fac;
+
+void main() {
+    grid_pos = pos + center;
+    gl_Position = projection * view * vec4(grid_pos.x, 0.0, grid_pos.y, 1.0);
+    out_back = back;
+    out_spot = spot;
+    out_fac = fac;
+}
\ No newline at end of file
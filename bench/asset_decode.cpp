@@ -0,0 +1,64 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <functional>
+
+#include "bench_util.hpp"
+#include "worker_pool.hpp"
+#include "renderer/object.hpp"
+#include "renderer/collider.hpp"
+#include "renderer/shader.hpp"
+#include "renderer/texture.hpp"
+
+using namespace openvtt;
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief The decode step of every asset a map can load (one entry per asset kind).
+ *
+ * Only decoding is measured: the GL upload needs a context, and it runs on the GL thread in both the serial and the
+ * parallel path anyway.
+ */
+std::vector<std::function<void()>> decode_jobs(const size_t count) {
+  const std::vector<std::function<void()>> kinds{
+    [] { do_not_optimize(render_object::decode("suzanne").vertices.size()); },
+    [] { do_not_optimize(render_object::decode("axis").vertices.size()); },
+    [] { do_not_optimize(collider::decode("suzanne_collider").vertices.size()); },
+    [] { do_not_optimize(texture::decode("plasma").width); },
+    [] { do_not_optimize(shader::decode("phong", "phong").vs.size()); },
+    [] { do_not_optimize(shader::decode("phong_instanced", "phong_instanced").vs.size()); },
+    [] { do_not_optimize(shader::decode("basic_mvp", "collider").vs.size()); },
+  };
+
+  std::vector<std::function<void()>> jobs;
+  jobs.reserve(count);
+  for (size_t i = 0; i < count; i++) jobs.push_back(kinds[i % kinds.size()]);
+  return jobs;
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t assets = argc > 1 ? std::stoul(argv[1]) : 60;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 5;
+  const auto jobs = decode_jobs(assets);
+  auto &pool = worker_pool::shared();
+
+  const auto serial = measure(std::format("serial decode, {} assets", assets), runs, [&] {
+    for (const auto &job : jobs) job();
+  });
+
+  const auto parallel = measure(std::format("parallel decode, {} assets", assets), runs, [&] {
+    std::vector<std::future<void>> futures;
+    futures.reserve(jobs.size());
+    for (const auto &job : jobs) futures.push_back(pool.submit(job));
+    for (auto &f : futures) f.get();
+  });
+
+  std::cout << std::format("Worker pool: {} threads\n", pool.size());
+  report(serial);
+  report(parallel);
+  report_speedup(serial, parallel);
+}
@@ -0,0 +1,104 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+#include <algorithm>
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Namespace for the benchmark helpers.
+ */
+namespace openvtt::bench {
+/**
+ * @brief Structure holding the timings of a benchmarked function.
+ */
+struct timing {
+  std::string name; //!< The name of the benchmark.
+  double min_ms; //!< The fastest run (in milliseconds).
+  double median_ms; //!< The median run (in milliseconds).
+  double mean_ms; //!< The mean run (in milliseconds).
+};
+
+/**
+ * @brief Prevents the compiler from optimizing away a value.
+ * @tparam T The type of the value.
+ * @param x The value.
+ */
+template <typename T>
+inline void do_not_optimize(const T &x) {
+  asm volatile("" : : "r,m"(x) : "memory");
+}
+
+/**
+ * @brief Summarizes a set of timings.
+ * @param name The name of the benchmark.
+ * @param ms The timings of the individual runs (in milliseconds; at least one).
+ * @return The summary.
+ */
+inline timing summarize(const std::string &name, std::vector<double> ms) {
+  std::ranges::sort(ms);
+  double total = 0.0;
+  for (const double x : ms) total += x;
+  return { name, ms.front(), ms[ms.size() / 2], total / static_cast<double>(ms.size()) };
+}
+
+/**
+ * @brief Runs a function a number of times, and collects its timings.
+ * @tparam F The function type (with signature `() -> void`).
+ * @param name The name of the benchmark.
+ * @param runs The number of (timed) runs; one extra warm-up run is performed first.
+ * @param f The function to benchmark.
+ * @return The timings.
+ */
+template <std::invocable<> F>
+timing measure(const std::string &name, const size_t runs, F &&f) {
+  using clock = std::chrono::steady_clock;
+  f();
+
+  std::vector<double> ms;
+  ms.reserve(runs);
+  for (size_t i = 0; i < runs; i++) {
+    const auto start = clock::now();
+    f();
+    ms.push_back(std::chrono::duration<double, std::milli>(clock::now() - start).count());
+  }
+
+  return summarize(name, std::move(ms));
+}
+
+/**
+ * @brief Prints a single timing.
+ * @param t The timing.
+ */
+inline void report(const timing &t) {
+  std::cout << std::format("{:<40} min {:>10.3f} ms | median {:>10.3f} ms | mean {:>10.3f} ms\n",
+    t.name, t.min_ms, t.median_ms, t.mean_ms);
+}
+
+/**
+ * @brief Prints the throughput of a timing (based on the median).
+ * @param t The timing.
+ * @param bytes The amount of bytes processed per run.
+ */
+inline void report_throughput(const timing &t, const size_t bytes) {
+  std::cout << std::format("{:<40} {:>10.1f} MB/s\n", t.name, static_cast<double>(bytes) / 1e6 / (t.median_ms / 1e3));
+}
+
+/**
+ * @brief Prints the speedup of one timing relative to another (based on the medians).
+ * @param base The baseline timing.
+ * @param other The timing to compare.
+ */
+inline void report_speedup(const timing &base, const timing &other) {
+  std::cout << std::format("{} vs {}: {:.2f}x\n", other.name, base.name, base.median_ms / other.median_ms);
+}
+}
+
+#endif //BENCH_UTIL_HPP
@@ -0,0 +1,85 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <cmath>
+#include <generator>
+#include <unordered_set>
+
+#include "bench_util.hpp"
+#include "map/scanline.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+using point = std::pair<int, int>;
+
+struct point_hash {
+  size_t operator()(const point &p) const noexcept {
+    return std::hash<uint64_t>{}(static_cast<uint64_t>(static_cast<uint32_t>(p.first)) << 32 | static_cast<uint32_t>(p.second));
+  }
+};
+
+/**
+ * @brief The previous implementation of `border`: every selected point is extended (through a coroutine), and the
+ * results are deduplicated in a hash set.
+ */
+std::vector<point> per_point_border(const std::vector<point> &selected, const int width) {
+  const auto extend = [&width](const point &p) -> std::generator<point> {
+    const auto [x0, y0] = p;
+    for (int x = x0 - width; x <= x0 + width; x++) {
+      for (int y = y0 - width; y <= y0 + width; y++) {
+        const float dist = std::sqrt(static_cast<float>((x - x0) * (x - x0) + (y - y0) * (y - y0)));
+        if (dist <= static_cast<float>(width)) co_yield point{x, y};
+      }
+    }
+  };
+
+  const std::unordered_set<point, point_hash> original{selected.begin(), selected.end()};
+  std::unordered_set<point, point_hash> result;
+  for (const auto &p : selected) {
+    for (const auto &ext : extend(p)) {
+      if (!original.contains(ext)) result.insert(ext);
+    }
+  }
+  return {result.begin(), result.end()};
+}
+
+/**
+ * @brief Generates a (filled) region: a regular polygon approximating a disc.
+ */
+std::vector<point> disc(const int radius) {
+  std::vector<point> outline;
+  for (int i = 0; i < 64; i++) {
+    const float angle = static_cast<float>(i) * 2.0f * 3.14159265f / 64.0f;
+    outline.emplace_back(static_cast<int>(static_cast<float>(radius) * std::cos(angle)), static_cast<int>(static_cast<float>(radius) * std::sin(angle)));
+  }
+  return span_points(scanline_fill(outline));
+}
+}
+
+int main(const int argc, const char **argv) {
+  const int radius = argc > 1 ? std::stoi(argv[1]) : 64;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 5;
+  const auto region = disc(radius);
+  std::cout << std::format("Region of {} points (disc of radius {})\n", region.size(), radius);
+
+  for (const int width : {1, 4, 16, 64, 256}) {
+    auto expected = per_point_border(region, width);
+    auto actual = border(region, width);
+    std::ranges::sort(expected);
+    std::ranges::sort(actual);
+    std::cout << std::format("--- width {}: {} border points{}\n", width, actual.size(), expected == actual ? "" : " (MISMATCH)");
+
+    const auto per_point = measure(std::format("width {}: per-point hash set", width), runs, [&] {
+      do_not_optimize(per_point_border(region, width).data());
+    });
+    const auto bitmap = measure(std::format("width {}: distance transform", width), runs, [&] {
+      do_not_optimize(border(region, width).data());
+    });
+    report(per_point);
+    report(bitmap);
+    report_speedup(per_point, bitmap);
+  }
+}
@@ -0,0 +1,110 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <random>
+
+#include "bench_util.hpp"
+#include "renderer/collider.hpp"
+#include "renderer/gl_backend.hpp"
+#include "renderer/transform.hpp"
+
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief The previous implementation of `collider::ray_intersect` (past its AABB test): every triangle is transformed
+ * into world space, and solved with four determinants.
+ */
+float brute_force(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices, const ray &r, const glm::mat4 &model) {
+  float hit_min = INFINITY;
+  const auto c = r.dir();
+  for (size_t i = 0; i < indices.size(); i += 3) {
+    const glm::vec3 p1 = model * glm::vec4(vertices[indices[i]], 1.0f);
+    const glm::vec3 p2 = model * glm::vec4(vertices[indices[i + 1]], 1.0f);
+    const glm::vec3 p3 = model * glm::vec4(vertices[indices[i + 2]], 1.0f);
+
+    const auto a = p2 - p1;
+    const auto b = p2 - p3;
+    const auto d = p2 - r.point();
+
+    const float alpha = determinant(glm::mat3{a, b, c});
+    const float beta = determinant(glm::mat3{d, b, c}) / alpha;
+    const float gamma = determinant(glm::mat3{a, d, c}) / alpha;
+    const float t0 = determinant(glm::mat3{a, b, d}) / alpha;
+
+    if (beta >= 0 && gamma >= 0 && beta + gamma <= 1 && std::isfinite(t0) && t0 >= 0 && t0 < hit_min) hit_min = t0;
+  }
+  return hit_min;
+}
+
+/**
+ * @brief Generates a detailed terrain collider: a height field of `side x side` quads (two triangles each).
+ */
+std::pair<std::vector<glm::vec3>, std::vector<unsigned int>> terrain(const int side, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> height{0.0f, 0.25f};
+  std::vector<glm::vec3> vertices;
+  std::vector<unsigned int> indices;
+  for (int z = 0; z <= side; z++) {
+    for (int x = 0; x <= side; x++) vertices.emplace_back(x, height(rng), z);
+  }
+  for (int z = 0; z < side; z++) {
+    for (int x = 0; x < side; x++) {
+      const auto a = static_cast<unsigned int>(z * (side + 1) + x), b = a + 1, c = a + side + 1, d = c + 1;
+      indices.insert(indices.end(), {a, c, b, b, c, d});
+    }
+  }
+  return {std::move(vertices), std::move(indices)};
+}
+}
+
+int main(const int argc, const char **argv) {
+  const int side = argc > 1 ? std::stoi(argv[1]) : 256;
+  const size_t rays = argc > 2 ? std::stoul(argv[2]) : 1000;
+  const size_t runs = argc > 3 ? std::stoul(argv[3]) : 5;
+
+  // colliders create (wireframe) buffers, which only need to be counted here
+  gl_backend::use_null();
+
+  std::mt19937 rng{42};
+  const auto [vertices, indices] = terrain(side, rng);
+  transform xf;
+  xf.set({-side / 4.0f, 0, -side / 4.0f}, {0, 30, 0}, {0.5f, 1, 0.5f});
+  const glm::mat4 &model = xf.world();
+
+  triangle_bvh built;
+  const auto build = measure(std::format("building a BVH over {} triangles", indices.size() / 3), runs, [&] {
+    built = triangle_bvh{vertices, indices};
+  });
+  const collider coll{vertices, indices, std::move(built)};
+
+  // mouse rays from a camera hovering above the terrain (see `camera`)
+  std::uniform_real_distribution<float> spread{-0.5f, 0.5f};
+  std::vector<ray> mouse;
+  mouse.reserve(rays);
+  for (size_t i = 0; i < rays; i++) mouse.emplace_back(glm::vec3{0, 11, 18}, glm::normalize(glm::vec3{spread(rng), -0.6f, -1.0f + spread(rng)}));
+
+  float sum = 0.0f;
+  const auto brute = measure(std::format("{} rays, every triangle", rays), runs, [&] {
+    for (const auto &r : mouse) sum += std::min(brute_force(vertices, indices, r, model), 1e6f);
+    do_not_optimize(sum);
+  });
+  const auto bvh = measure(std::format("{} rays, BVH", rays), runs, [&] {
+    for (const auto &r : mouse) sum += std::min(coll.ray_intersect(r, model), 1e6f);
+    do_not_optimize(sum);
+  });
+
+  report(build);
+  report(brute);
+  report(bvh);
+  report_speedup(brute, bvh);
+
+  size_t hits = 0, mismatches = 0;
+  for (const auto &r : mouse) {
+    const float expected = brute_force(vertices, indices, r, model), actual = coll.ray_intersect(r, model);
+    if (std::isfinite(expected)) hits++;
+    if (expected != actual && std::abs(expected - actual) > 1e-3f * std::max(1.0f, expected)) mismatches++;
+  }
+  std::cout << std::format("{} of {} rays hit the terrain; {} mismatches\n", hits, rays, mismatches);
+}
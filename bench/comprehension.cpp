@@ -0,0 +1,73 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_interpreter.hpp"
+#include "map/map_optimizer.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Generates a map placing `instances` transforms on a grid, as one literal list.
+ */
+std::string literal_map(const size_t instances) {
+  std::stringstream strm;
+  strm << "objects {\n  ts = [\n";
+  for (size_t i = 0; i < instances; i++) {
+    strm << std::format("    @transform(({}, 0, {}), (0, 90, 0), (1, 1, 1)){}\n", i % 100, i / 100, i + 1 < instances ? "," : "");
+  }
+  strm << "  ];\n}\n";
+  return strm.str();
+}
+
+/**
+ * @brief Generates a map placing the same transforms as `literal_map`, using a comprehension.
+ */
+std::string comprehension_map(const size_t instances) {
+  return std::format("objects {{\n  ts = [@transform((i % 100, 0, i / 100), (0, 90, 0), (1, 1, 1)) for i in 0..{}];\n}}\n", instances);
+}
+
+/**
+ * @brief Parses, compiles and runs a map; the result is only used to keep the work from being optimized away.
+ */
+size_t parse_and_run(const std::string &source) {
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  mapParser parser(&tokens);
+  auto prog = map_compiler::compile(parser.program(), "(synthetic)");
+  fold_constants(prog);
+  resolve_slots(prog);
+  bind_builtins(prog);
+
+  map_interpreter i;
+  i.file = "(synthetic)";
+  i.run(prog);
+  return prog.code.size();
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t instances = argc > 1 ? std::stoul(argv[1]) : 2000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+
+  const auto literal = literal_map(instances);
+  const auto comprehension = comprehension_map(instances);
+  std::cout << std::format("{} transforms: literal map is {} bytes, comprehension is {} bytes\n",
+    instances, literal.size(), comprehension.size());
+
+  const auto lit = measure("literal list (parse + run)", runs, [&] { do_not_optimize(parse_and_run(literal)); });
+  const auto comp = measure("comprehension (parse + run)", runs, [&] { do_not_optimize(parse_and_run(comprehension)); });
+
+  report(lit);
+  report(comp);
+  report_speedup(lit, comp);
+}
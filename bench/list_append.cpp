@@ -0,0 +1,78 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_interpreter.hpp"
+#include "map/map_visitor.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Generates a map that builds a list of transforms by appending one element per statement.
+ */
+std::string append_map(const size_t elements) {
+  std::stringstream strm;
+  strm << "objects {\n  all = [];\n";
+  for (size_t i = 0; i < elements; i++) {
+    strm << std::format("  all = all + @transform(({}, 0, {}), (0, 90, 0), (1, 1, 1));\n", i % 100, i / 100);
+  }
+  strm << "}\n";
+  return strm.str();
+}
+
+/**
+ * @brief Benchmarks building a list with the given amount of elements.
+ */
+std::pair<timing, timing> run(const size_t elements, const size_t runs) {
+  const std::string file = "(synthetic)";
+  const std::string source = append_map(elements);
+
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  mapParser parser(&tokens);
+  auto *tree = parser.program();
+
+  const auto visitor = measure(std::format("visitor, {} appends", elements), runs, [&] {
+    map_visitor v;
+    v.file = file;
+    v.visit(tree);
+    do_not_optimize(v.show_axes);
+  });
+
+  auto prog = map_compiler::compile(tree, file);
+  resolve_slots(prog);
+  const auto interpret = measure(std::format("interpret, {} appends", elements), runs, [&] {
+    map_interpreter i;
+    i.file = file;
+    i.run(prog);
+    do_not_optimize(i.show_axes);
+  });
+
+  return {visitor, interpret};
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t elements = argc > 1 ? std::stoul(argv[1]) : 50000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 5;
+
+  // with structurally shared lists, doubling the amount of appends should (roughly) double the time
+  const auto [half_v, half_i] = run(elements / 2, runs);
+  const auto [full_v, full_i] = run(elements, runs);
+
+  report(half_v);
+  report(full_v);
+  report(half_i);
+  report(full_i);
+  std::cout << std::format("Scaling (2x appends): visitor {:.2f}x, interpreter {:.2f}x\n",
+    full_v.median_ms / half_v.median_ms, full_i.median_ms / half_i.median_ms);
+}
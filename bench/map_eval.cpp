@@ -0,0 +1,92 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_interpreter.hpp"
+#include "map/map_visitor.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Generates a synthetic map with (roughly) the requested amount of statements.
+ *
+ * The map only uses arithmetic, lists, pairs, and `@transform`, so it can be evaluated without an OpenGL context.
+ */
+std::string synthetic_map(const size_t statements) {
+  std::stringstream strm;
+  strm << "objects {\n  acc = 0;\n  all = [];\n";
+  for (size_t i = 0; i < statements / 6; i++) {
+    strm << std::format("  a{0} = 1 + {0} * 3 % 7;\n", i);
+    strm << std::format("  b{0} = a{0} ^ 2 / 4.5;\n", i);
+    strm << std::format("  c{0} = b{0} >= 10.0;\n", i);
+    strm << std::format("  p{0} = (a{0}, \"item{0}\");\n", i);
+    strm << std::format("  t{0} = @transform((a{0}, 0, b{0}), (0, 90, 0), (1, 1, 1));\n", i);
+    strm << std::format("  acc = acc + a{0};\n", i);
+  }
+  strm << "  all = [acc, 1, 2, 3];\n}\n";
+  return strm.str();
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t statements = argc > 1 ? std::stoul(argv[1]) : 30000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+  const std::string file = "(synthetic)";
+  const std::string source = synthetic_map(statements);
+
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  mapParser parser(&tokens);
+  auto *tree = parser.program();
+
+  std::cout << std::format("Synthetic map: {} statements, {} bytes\n", statements, source.size());
+
+  const auto visitor = measure("tree-walking visitor", runs, [&] {
+    map_visitor v;
+    v.file = file;
+    v.visit(tree);
+    do_not_optimize(v.show_axes);
+  });
+
+  const auto compile = measure("compile", runs, [&] {
+    auto prog = map_compiler::compile(tree, file);
+    resolve_slots(prog);
+    do_not_optimize(prog.code.size());
+  });
+
+  auto prog = map_compiler::compile(tree, file);
+  resolve_slots(prog);
+  const auto interpret = measure("interpret", runs, [&] {
+    map_interpreter i;
+    i.file = file;
+    i.run(prog);
+    do_not_optimize(i.show_axes);
+  });
+
+  const auto both = measure("compile + interpret", runs, [&] {
+    map_interpreter i;
+    i.file = file;
+    auto p = map_compiler::compile(tree, file);
+    resolve_slots(p);
+    i.run(p);
+    do_not_optimize(i.show_axes);
+  });
+
+  std::cout << std::format("Program: {} instructions, {} constants, {} names\n",
+    prog.code.size(), prog.constants.size(), prog.names.size());
+  report(visitor);
+  report(compile);
+  report(interpret);
+  report(both);
+  report_speedup(visitor, interpret);
+  report_speedup(visitor, both);
+}
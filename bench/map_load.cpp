@@ -0,0 +1,85 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <filesystem>
+
+#include "bench_util.hpp"
+#include "filesys.hpp"
+#include "map/map_fast_parser.hpp"
+#include "map/map_optimizer.hpp"
+#include "map/map_parser.hpp"
+#include "map/program_cache.hpp"
+#include "renderer/gl_backend.hpp"
+
+using namespace openvtt;
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Releases the renderables of a loaded map, so repeated loads don't grow the render cache.
+ */
+void release(const map_desc &desc) {
+  for (const auto &r : desc.scene) render_cache::release(r);
+  for (const auto &r : desc.scene_instances) render_cache::release(r);
+}
+
+/**
+ * @brief Stores the compiled program of a map file in a (temporary) cache file, and loads it back.
+ * @return `true` if the load hits, and gives back the same program.
+ */
+bool cache_round_trip(const std::string &path) {
+  const mapped_file source(path);
+  if (!source.is_open()) return false;
+  auto prog = map_fast_parser::compile(source.text(), path);
+  if (!prog.has_value()) return false;
+  fold_constants(*prog); // like `load_program` does, before storing
+
+  const auto cache_path = (std::filesystem::temp_directory_path() / "openvtt_bench_map_load.ovmc").string();
+  const auto key = program_cache::key_for(path, source.text());
+  if (!program_cache::store(cache_path, key, *prog)) return false;
+  const auto loaded = program_cache::load(cache_path, key);
+  std::filesystem::remove(cache_path);
+  return loaded.has_value() && loaded->disassemble() == prog->disassemble();
+}
+}
+
+int main(const int argc, const char **argv) {
+  const std::string map = argc > 1 ? argv[1] : "examples/suzannes";
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+
+  // the whole pipeline runs as usual, but no window is opened, and OpenGL calls are only counted
+  gl_backend::use_null();
+
+  const auto start = std::chrono::steady_clock::now();
+  const auto first = map_desc::parse_from(map);
+  const double cold_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  if (first.sources.empty()) {
+    std::cout << std::format("Can't open map {}\n", map);
+    return 1;
+  }
+  release(first);
+
+  std::cout << std::format("Map {}: {} renderables, {} instanced renderables; first load took {:.3f} ms\n",
+    map, first.scene.size(), first.scene_instances.size(), cold_ms);
+
+  const auto warm = measure("load (assets deduplicated)", runs, [&] {
+    const auto desc = map_desc::parse_from(map);
+    do_not_optimize(desc.scene.size());
+    release(desc);
+  });
+  report(warm);
+
+  size_t calls = 0;
+  for (const auto &[call, count] : gl_backend::calls()) calls += count;
+  std::cout << std::format("{} OpenGL calls recorded\n", calls);
+
+  // a cache that rejects what it writes would silently recompile every map, so this is checked here
+  if (!cache_round_trip(asset_path<asset_type::MAP>(map))) {
+    std::cout << std::format("Program cache round trip failed for map {}\n", map);
+    return 1;
+  }
+  std::cout << "Program cache round trip hits\n";
+}
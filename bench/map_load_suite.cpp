@@ -0,0 +1,290 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "filesys.hpp"
+#include "map/map_builtins.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_fast_parser.hpp"
+#include "map/map_interpreter.hpp"
+#include "map/map_optimizer.hpp"
+#include "map/program_cache.hpp"
+#include "renderer/gl_backend.hpp"
+
+using namespace openvtt;
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+using clock = std::chrono::steady_clock;
+
+/**
+ * @brief The parameters of a synthetic map.
+ */
+struct map_config {
+  size_t variables = 2000; //!< The amount of (arithmetic) variable assignments.
+  size_t spawns = 200; //!< The amount of spawned renderables.
+  size_t instances = 5000; //!< The amount of instance transforms (of a single instanced renderable).
+  size_t list_size = 16; //!< The amount of elements per level of the nested lists.
+  size_t nesting = 2; //!< The nesting depth of the nested lists (`list_size ^ nesting` elements in total).
+
+  /**
+   * @brief Scales all sizes (except the nesting depth) by a factor.
+   */
+  [[nodiscard]] map_config scaled(const size_t f) const {
+    return {variables * f, spawns * f, instances * f, list_size * f, nesting};
+  }
+
+  [[nodiscard]] std::string json() const {
+    return std::format(R"({{"variables": {}, "spawns": {}, "instances": {}, "list_size": {}, "nesting": {}}})",
+      variables, spawns, instances, list_size, nesting);
+  }
+};
+
+/**
+ * @brief Generates a synthetic map.
+ *
+ * Only assets shipped with the repository are used, so the map loads on any checkout.
+ */
+std::string synthetic_map(const map_config &cfg) {
+  std::stringstream strm;
+  strm << "// synthetic map (generated by bench_map_load_suite)\nobjects {\n";
+  strm << "  tex = @texture(\"plasma\");\n  mesh = @object(\"suzanne\");\n";
+  strm << "  sh = @shader(\"phong\", \"phong\");\n  sh_i = @shader(\"phong_instanced\", \"phong_instanced\");\n";
+  strm << "  textures = [(4, tex), (5, tex)];\n";
+
+  strm << "  v0 = 1;\n";
+  for (size_t i = 1; i < cfg.variables; i++) {
+    strm << std::format("  v{} = v{} * 3 % 97 + {};\n", i, i - 1, i);
+  }
+
+  for (size_t i = 0; i < cfg.spawns; i++) {
+    strm << std::format("  s{0} = @spawn(\"s{0}\", mesh, sh, textures);\n", i);
+    strm << std::format("  @transform_obj(s{0}, ({1}, 0, {2}), (0, {0}, 0), (0.25, 0.25, 0.25));\n", i, i % 50, i / 50);
+  }
+
+  if (cfg.instances > 0) {
+    strm << std::format("  ts = [@transform((i % 100, 0, i / 100), (0, i, 0), (0.2, 0.2, 0.2)) for i in 0..{}];\n", cfg.instances);
+    strm << "  inst = @spawn*(\"instances\", @object*(\"suzanne\", ts), sh_i, textures);\n";
+  }
+
+  if (cfg.nesting > 0) {
+    std::string nested = "i0 * 0.5";
+    for (size_t d = 0; d < cfg.nesting; d++) {
+      nested = std::format("[{} for i{} in 0..{}]", nested, d, cfg.list_size);
+    }
+    strm << std::format("  nested = {};\n", nested);
+  }
+
+  strm << "}\n";
+  return strm.str();
+}
+
+/**
+ * @brief The time spent in (and the amount of calls to) each builtin.
+ */
+struct builtin_timer {
+  std::array<double, std::size(builtins)> ms{};
+  std::array<size_t, std::size(builtins)> calls{};
+};
+builtin_timer timer;
+
+/**
+ * @brief An entry point for builtin `I`, which times the builtin (see `time_builtins`).
+ */
+template <size_t I>
+value timed_builtin(const std::span<const value> args, map_state &state, const loc &at) {
+  const auto start = clock::now();
+  auto res = builtins[I].invoke(args, state, at);
+  timer.ms[I] += std::chrono::duration<double, std::milli>(clock::now() - start).count();
+  timer.calls[I]++;
+  return res;
+}
+
+constexpr auto timed_entries = []<size_t ... Is>(std::index_sequence<Is...>) {
+  return std::array<builtin_fn, sizeof...(Is)>{ &timed_builtin<Is>... };
+}(std::make_index_sequence<std::size(builtins)>{});
+
+/**
+ * @brief Rebinds all builtins in a (bound) program to their timed entry points.
+ */
+void time_builtins(program &prog) {
+  for (size_t n = 0; n < prog.names.size(); n++) {
+    if (prog.bound[n] == nullptr) continue;
+    const auto it = std::ranges::find(builtins, prog.names[n], &builtin_desc::name);
+    prog.bound[n] = timed_entries[it - std::ranges::begin(builtins)];
+  }
+}
+
+/**
+ * @brief Gets the time elapsed since a given time point, in milliseconds.
+ */
+double ms_since(const clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(clock::now() - start).count();
+}
+
+/**
+ * @brief Releases everything a map spawned, and evicts its assets, so the next run starts cold again.
+ */
+template <typename Scene, typename Instances>
+void release(const Scene &scene, const Instances &instances) {
+  for (const auto &r : scene) render_cache::release(r);
+  for (const auto &r : instances) render_cache::release(r);
+  render_cache::evict_unused();
+}
+
+/**
+ * @brief The phases of loading a map, in pipeline order.
+ */
+constexpr std::string_view phases[] = {
+  "lex",          // ANTLR lexer
+  "parse",        // ANTLR parser (SLL), on the lexed tokens
+  "compile",      // map_compiler, on the ANTLR tree
+  "fast_parse",   // hand-written parser (lexes, parses and compiles in one go; used by default)
+  "optimize",     // fold_constants, resolve_slots, bind_builtins
+  "eval",         // the interpreter, excluding the time spent in builtins
+  "builtins",     // the builtins (including the cost of timing them)
+  "assets",       // waiting for the asset decoders, and uploading the assets (render_cache::flush)
+  "parse_from",   // map_desc::parse_from, end-to-end (without program cache)
+};
+
+/**
+ * @brief Runs the pipeline once, on a map file, and times each phase.
+ * @return The timings, indexed like `phases`.
+ */
+std::array<double, std::size(phases)> run_once(const std::string &asset, const std::string &path, const std::string &source) {
+  std::array<double, std::size(phases)> ms{};
+  timer = {};
+
+  auto start = clock::now();
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  tokens.fill();
+  ms[0] = ms_since(start);
+
+  start = clock::now();
+  mapParser parser(&tokens);
+  parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+  auto *tree = parser.program();
+  ms[1] = ms_since(start);
+
+  start = clock::now();
+  do_not_optimize(map_compiler::compile(tree, path).code.size());
+  ms[2] = ms_since(start);
+
+  start = clock::now();
+  auto prog = *map_fast_parser::compile(source, path);
+  ms[3] = ms_since(start);
+
+  start = clock::now();
+  fold_constants(prog);
+  resolve_slots(prog);
+  bind_builtins(prog);
+  ms[4] = ms_since(start);
+
+  time_builtins(prog);
+  map_interpreter interpreter;
+  interpreter.file = path;
+  start = clock::now();
+  interpreter.run(prog);
+  const double eval = ms_since(start);
+  for (const double b : timer.ms) ms[6] += b;
+  ms[5] = eval - ms[6];
+
+  start = clock::now();
+  render_cache::flush();
+  ms[7] = ms_since(start);
+  release(interpreter.spawned, interpreter.spawned_instances);
+
+  std::filesystem::remove(program_cache::path_for(path));
+  start = clock::now();
+  const auto desc = map_desc::parse_from(asset);
+  ms[8] = ms_since(start);
+  release(desc.scene, desc.scene_instances);
+
+  return ms;
+}
+}
+
+int main(const int argc, const char **argv) {
+  map_config base{};
+  size_t sweep = 3;
+  size_t runs = 5;
+  std::string json_path = "map_load_suite.json";
+
+  for (int i = 1; i < argc; i++) {
+    const std::string_view arg = argv[i];
+    const auto eq = arg.find('=');
+    if (eq == std::string_view::npos) {
+      std::cerr << std::format("Ignoring argument {} (expected key=value)\n", arg);
+      continue;
+    }
+    const auto key = arg.substr(0, eq);
+    const std::string val{arg.substr(eq + 1)};
+    if (key == "json") json_path = val;
+    else if (key == "variables") base.variables = std::stoul(val);
+    else if (key == "spawns") base.spawns = std::stoul(val);
+    else if (key == "instances") base.instances = std::stoul(val);
+    else if (key == "list_size") base.list_size = std::stoul(val);
+    else if (key == "nesting") base.nesting = std::stoul(val);
+    else if (key == "sweep") sweep = std::max<size_t>(std::stoul(val), 1);
+    else if (key == "runs") runs = std::max<size_t>(std::stoul(val), 1);
+    else std::cerr << std::format("Ignoring unknown parameter {}\n", key);
+  }
+
+  // the whole pipeline runs without a window; OpenGL calls are only counted
+  gl_backend::use_null();
+  const std::string asset = "bench/synthetic";
+  const auto path = asset_path<asset_type::MAP>(asset);
+  std::filesystem::create_directories(std::filesystem::path(path).parent_path());
+
+  std::stringstream json;
+  json << "[\n";
+  for (size_t s = 0; s < sweep; s++) {
+    const auto cfg = base.scaled(size_t{1} << s);
+    const auto source = synthetic_map(cfg);
+    std::ofstream(path, std::ios::binary) << source;
+    std::cout << std::format("--- {} bytes, config {}\n", source.size(), cfg.json());
+
+    run_once(asset, path, source); // warm-up
+    std::array<std::vector<double>, std::size(phases)> samples;
+    for (size_t r = 0; r < runs; r++) {
+      const auto ms = run_once(asset, path, source);
+      for (size_t p = 0; p < std::size(phases); p++) samples[p].push_back(ms[p]);
+    }
+
+    json << std::format(R"(  {{"config": {}, "bytes": {}, "runs": {}, "phases": {{)", cfg.json(), source.size(), runs);
+    for (size_t p = 0; p < std::size(phases); p++) {
+      const auto t = summarize(std::string{phases[p]}, samples[p]);
+      report(t);
+      json << std::format(R"({}"{}": {{"min_ms": {:.4f}, "median_ms": {:.4f}, "mean_ms": {:.4f}}})",
+        p == 0 ? "" : ", ", phases[p], t.min_ms, t.median_ms, t.mean_ms);
+    }
+
+    // the builtin breakdown of the last run
+    json << "}, \"builtins\": {";
+    bool first = true;
+    for (size_t b = 0; b < std::size(builtins); b++) {
+      if (timer.calls[b] == 0) continue;
+      json << std::format(R"({}"{}": {{"calls": {}, "ms": {:.4f}}})", first ? "" : ", ", builtins[b].name, timer.calls[b], timer.ms[b]);
+      first = false;
+    }
+    json << "}}" << (s + 1 < sweep ? "," : "") << "\n";
+  }
+  json << "]\n";
+
+  std::filesystem::remove(path);
+  std::filesystem::remove(program_cache::path_for(path));
+  std::ofstream(json_path) << json.str();
+  std::cout << std::format("Results written to {}\n", json_path);
+}
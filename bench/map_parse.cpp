@@ -0,0 +1,151 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "filesys.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_errors.hpp"
+#include "map/map_fast_parser.hpp"
+
+using namespace openvtt;
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Generates a synthetic map with (roughly) the requested amount of statements, using every kind of expression.
+ */
+std::string synthetic_map(const size_t statements) {
+  std::stringstream strm;
+  strm << "// synthetic map\nobjects {\n  acc = 0;\n";
+  for (size_t i = 0; i < statements / 8; i++) {
+    strm << std::format("  a{0} = 1 + {0} * 3 % 7 - -2;\n", i);
+    strm << std::format("  b{0} = (a{0} ^ 2 / 4.5) >= .5 == true; // comment {0}\n", i);
+    strm << std::format("  p{0} = (a{0}, \"item {0}\");\n", i);
+    strm << std::format("  t{0} = @transform((a{0}, 0, +1.25), (0, 90, 0), (1, 1, 1));\n", i);
+    strm << std::format("  l{0} = [t{0}, @transform((0, 0, 0), (0, 0, 0), (1, 1, 1))] + [];\n", i);
+    strm << std::format("  r{0} = [x * 2 for x in 0..{0} + 1] + [0..3];\n", i);
+    strm << std::format("  (acc = acc + a{0});\n", i);
+    strm << std::format("  (a{0});\n", i);
+  }
+  strm << "}\n";
+  return strm.str();
+}
+
+/**
+ * @brief Small sources exercising the corners of the grammar (valid or not).
+ */
+constexpr std::string_view edge_cases[] = {
+  "objects {}",
+  "objects { x; (x); ((x)); (x = 1); ((x = 1)); x = y = 2; }",
+  "objects { 2 ^ x = 1 + 2; (1) + 2; ((1 + 2)); a * x = 2 + 3; }",
+  "objects { [[j for j in 0..i] for i in 0..3]; [0..3]; [1, 2, 3]; []; (1, 2); (1, 2, 3); }",
+  "objects { 1 < 2 == 3 <= 4 != 5 > 6 >= 7; 1...5; }",
+  "objects { \"caf\xc3\xa9\"; x = 1; }",
+  "objects {\r\n\tx = 1;\r\n}",
+  "objects { a+1; }",
+  "objects { @f(); }",
+  "objects { \"abc; }",
+  "objects { [1, 2,]; }",
+  "objects { (1, 2, 3, 4); }",
+  "objects { 99999999999; }",
+  "objects { # }",
+  "objects {} trailing",
+};
+
+/**
+ * @brief Parses and compiles a map using ANTLR (and `map_compiler`).
+ * @return The program, and whether it was compiled without syntax errors.
+ */
+std::pair<program, bool> compile_antlr(const std::string_view source, const std::string &file) {
+  lexer_error_listener lex_error{file};
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  lexer.removeErrorListeners();
+  lexer.addErrorListener(&lex_error);
+  antlr4::CommonTokenStream tokens(&lexer);
+  mapParser parser(&tokens);
+  parser.removeErrorListeners();
+  auto prog = map_compiler::compile(parser.program(), file);
+  return {std::move(prog), lex_error.error_count == 0 && parser.getNumberOfSyntaxErrors() == 0};
+}
+
+/**
+ * @brief Checks that both parsers agree on a source.
+ * @return `true` if they agree (both reject it, or both generate the same program).
+ */
+bool differential(const std::string_view source, const std::string &name) {
+  std::optional<std::pair<program, bool>> reference;
+  try { reference = compile_antlr(source, name); }
+  catch (const std::exception &) {} // e.g. out of range integer literals
+  const auto fast = map_fast_parser::compile(source, name);
+
+  const bool clean = reference.has_value() && reference->second;
+  if (!clean || !fast.has_value()) {
+    if (clean == fast.has_value()) return true;
+    std::cout << std::format("MISMATCH on {}: ANTLR {} it, the fast parser {} it\n", name,
+      clean ? "accepts" : "rejects", fast.has_value() ? "accepts" : "rejects");
+    return false;
+  }
+
+  const auto &expected = reference->first;
+  if (expected.disassemble() == fast->disassemble() && expected.names == fast->names &&
+      expected.constants.size() == fast->constants.size() && expected.locs == fast->locs) return true;
+  std::cout << std::format("MISMATCH on {}:\n--- ANTLR ---\n{}--- fast ---\n{}", name,
+    expected.disassemble(), fast->disassemble());
+  return false;
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t statements = argc > 1 ? std::stoul(argv[1]) : 40000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+  const std::string file = "(synthetic)";
+  const std::string source = synthetic_map(statements);
+
+  // differential check: both parsers should generate exactly the same programs
+  bool agree = differential(source, file);
+  for (size_t i = 0; i < std::size(edge_cases); i++) agree &= differential(edge_cases[i], std::format("(edge case {})", i));
+  for (int i = 3; i < argc; i++) {
+    const mapped_file map(asset_path<asset_type::MAP>(argv[i]));
+    if (map.is_open()) agree &= differential(map.text(), argv[i]);
+    else std::cout << std::format("Can't open map {} (skipped)\n", argv[i]);
+  }
+  std::cout << (agree ? "Both parsers agree on all inputs\n" : "The parsers disagree\n");
+
+  std::cout << std::format("Synthetic map: {} statements, {} bytes\n", statements, source.size());
+  const auto antlr = measure("ANTLR + map_compiler", runs, [&] {
+    const auto res = compile_antlr(source, file);
+    do_not_optimize(res.first.code.size());
+  });
+  const auto sll = measure("ANTLR (SLL, bail) + map_compiler", runs, [&] {
+    antlr4::ANTLRInputStream input(source);
+    mapLexer lexer(&input);
+    antlr4::CommonTokenStream tokens(&lexer);
+    mapParser parser(&tokens);
+    parser.removeErrorListeners();
+    parser.setErrorHandler(std::make_shared<antlr4::BailErrorStrategy>());
+    parser.getInterpreter<antlr4::atn::ParserATNSimulator>()->setPredictionMode(antlr4::atn::PredictionMode::SLL);
+    const auto prog = map_compiler::compile(parser.program(), file);
+    do_not_optimize(prog.code.size());
+  });
+  const auto fast = measure("map_fast_parser", runs, [&] {
+    const auto res = map_fast_parser::compile(source, file);
+    do_not_optimize(res->code.size());
+  });
+
+  report(antlr);
+  report(sll);
+  report(fast);
+  report_throughput(antlr, source.size());
+  report_throughput(sll, source.size());
+  report_throughput(fast, source.size());
+  report_speedup(antlr, sll);
+  report_speedup(antlr, fast);
+  return agree ? 0 : 1;
+}
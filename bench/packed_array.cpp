@@ -0,0 +1,39 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include "bench_util.hpp"
+#include "map/map_builtins.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+int main(const int argc, const char **argv) {
+  const size_t instances = argc > 1 ? std::stoul(argv[1]) : 10000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 100;
+  const loc at{"(synthetic)", 1, 1};
+
+  std::vector<value> elems;
+  elems.reserve(instances);
+  for (size_t i = 0; i < instances; i++) {
+    const glm::vec3 pos{static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)};
+    elems.emplace_back(renderer::instanced_object::model_for({0.0f, 90.0f, 0.0f}, glm::vec3{1.0f}, pos), at);
+  }
+  const value boxed{value_list{std::vector{elems}}, at};
+  const value packed = value::make_list(std::move(elems), at);
+  std::cout << std::format("{} transforms: boxed list is {}, packed list is {}\n", instances, boxed.type_name(), packed.type_name());
+
+  // what `@object*` and `@collider*` have to do with their transforms argument before handing it to the renderer
+  const auto unbox = measure("boxed list -> mat4 vector", runs, [&] {
+    const auto res = type_check<mat4_array>(boxed);
+    do_not_optimize(res.right().data());
+  });
+  const auto direct = measure("packed list -> mat4 span", runs, [&] {
+    const auto res = type_check<mat4_array>(packed);
+    do_not_optimize(res.right().data());
+  });
+
+  report(unbox);
+  report(direct);
+  report_speedup(unbox, direct);
+}
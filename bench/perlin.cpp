@@ -0,0 +1,105 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <ranges>
+
+#include "bench_util.hpp"
+#include "renderer/perlin.hpp"
+
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Values of `perlin()` in `perlin.fs.glsl`, at fixed points.
+ *
+ * The points avoid lattice corners whose gradient lies exactly on an edge of the octahedron (where `gz == 0`, so
+ * `step(gz, 0.0)` depends on rounding), so the values don't depend on how the noise is rounded.
+ */
+const std::pair<glm::vec3, float> shader_values[] = {
+  {{-3.42f, 0.29f, -0.54f}, -0.134914f},
+  {{-3.63f, 2.87f, -0.84f}, 0.078301f},
+  {{-3.06f, -0.66f, 1.03f}, -0.157205f},
+  {{1.35f, 2.12f, 0.29f}, 0.012584f},
+  {{-3.06f, -3.53f, 1.07f}, 0.067371f},
+  {{2.97f, -3.36f, -0.2f}, -0.028636f},
+  {{-84.74f, 230.52f, 7.32f}, -0.020634f},
+  {{-174.74f, -202.62f, -2.56f}, 0.171780f},
+  {{-148.65f, -91.57f, -2.17f}, 0.047069f},
+  {{197.31f, -203.14f, -7.63f}, -0.086055f},
+  {{287.1f, 218.0f, 3.14f}, -0.022215f},
+  {{290.96f, 211.58f, 4.9f}, -0.087947f},
+  {{191.0f, 143.92f, -4.37f}, 0.142022f},
+  {{-81.22f, -167.72f, -4.37f}, -0.036394f},
+  {{-181.98f, -177.38f, 1.99f}, 0.014897f},
+  {{150.08f, -13.18f, -5.14f}, -0.004618f},
+};
+
+constexpr float tolerance = 1e-4f; //!< The largest difference allowed with the shader values.
+}
+
+int main(const int argc, const char **argv) {
+  const size_t points = argc > 1 ? std::stoul(argv[1]) : 1 << 20;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> coord{-500.0f, 500.0f};
+  std::vector<glm::vec3> ps(points);
+  for (auto &p : ps) p = {coord(rng), coord(rng), coord(rng) / 10.0f};
+
+  std::vector<float> scalar_out(points), batch_out(points);
+  const auto scalar = measure(std::format("perlin, {} points, one by one", points), runs, [&] {
+    for (size_t i = 0; i < points; i++) scalar_out[i] = perlin(ps[i]);
+    do_not_optimize(scalar_out.data());
+  });
+  const auto batch = measure(std::format("perlin, {} points, batched", points), runs, [&] {
+    perlin(ps, batch_out);
+    do_not_optimize(batch_out.data());
+  });
+
+  float max_diff = 0.0f;
+  for (size_t i = 0; i < points; i++) max_diff = std::max(max_diff, std::abs(scalar_out[i] - batch_out[i]));
+
+  report(scalar);
+  report(batch);
+  report_speedup(scalar, batch);
+  std::cout << std::format("Largest difference between both: {}\n", max_diff);
+
+  // a chunk of voxel terrain (32x32 tiles at 8 texels per tile), with three tiers
+  const glm::mat4x3 tiers{ {1.0f, 0.25f, 0.3f}, {0.5f, 1.0f, -0.7f}, {0.25f, 4.0f, 0.1f}, {0.0f, 0.0f, 0.0f} };
+  std::vector<float> baked;
+  const auto bake = measure("baking a 256x256 chunk texture (3 tiers)", runs, [&] {
+    baked = bake_tiered_perlin(tiers, {-0.5f, -0.5f}, 32.0f, 256);
+  });
+  float bake_diff = 0.0f;
+  for (int row = 0; row < 256; row++) {
+    for (int col = 0; col < 256; col++) {
+      const glm::vec2 at{-0.5f + (col + 0.5f) / 8.0f, -0.5f + (row + 0.5f) / 8.0f};
+      bake_diff = std::max(bake_diff, std::abs(baked[row * 256 + col] - tiered_perlin(tiers, at)));
+    }
+  }
+  report(bake);
+  std::cout << std::format("Largest difference with tiered_perlin: {}\n", bake_diff);
+
+  // both the scalar and the batched evaluation are checked against the shader
+  std::vector<glm::vec3> golden_ps;
+  for (const auto &p : shader_values | std::views::keys) golden_ps.push_back(p);
+  std::vector<float> golden_out(golden_ps.size());
+  perlin(golden_ps, golden_out);
+  float shader_diff = 0.0f;
+  for (size_t i = 0; i < golden_ps.size(); i++) {
+    const float expected = shader_values[i].second;
+    shader_diff = std::max({shader_diff, std::abs(perlin(golden_ps[i]) - expected), std::abs(golden_out[i] - expected)});
+  }
+  std::cout << std::format("Largest difference with the shader values: {}\n", shader_diff);
+
+  if (shader_diff > tolerance) {
+    std::cout << std::format("perlin doesn't match the shader (tolerance {})\n", tolerance);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,107 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <random>
+
+#include "bench_util.hpp"
+#include "renderer/gl_backend.hpp"
+#include "renderer/render_cache.hpp"
+
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Spawns a renderable (like a token on the map); its assets are never dereferenced, so no OpenGL is needed.
+ */
+render_ref spawn(const size_t i) {
+  return render_cache::construct<renderable>(
+    std::format("token #{}", i), object_ref::invalid(), shader_ref::invalid(), uniforms{0, 0, 0, 0},
+    std::vector<std::pair<unsigned int, texture_ref>>{}
+  );
+}
+
+/**
+ * @brief Gives a renderable its own (single-triangle) collider.
+ */
+void add_collider(const render_ref &r) {
+  static const std::vector<glm::vec3> vertices{{0, 0, 0}, {1, 0, 0}, {0, 0, 1}};
+  static const std::vector<unsigned int> indices{0, 1, 2};
+  r->coll = render_cache::construct<collider>(vertices, indices);
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t count = argc > 1 ? std::stoul(argv[1]) : 100'000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+
+  // colliders create (wireframe) buffers, which only need to be counted here
+  gl_backend::use_null();
+
+  std::vector<render_ref> live;
+  live.reserve(count);
+
+  const auto spawn_despawn = measure(std::format("spawn and despawn {} renderables", count), runs, [&] {
+    for (size_t i = 0; i < count; i++) live.push_back(spawn(i));
+    for (const auto &r : live) render_cache::release(r);
+    live.clear();
+  });
+
+  // keep a full scene alive, and replace a random tenth of it every "frame"
+  for (size_t i = 0; i < count; i++) live.push_back(spawn(i));
+  std::mt19937 rng{42};
+  std::uniform_int_distribution<size_t> pick{0, count - 1};
+  std::vector<render_ref> stale;
+  const auto churn = measure(std::format("replace {} of {} renderables", count / 10, count), runs, [&] {
+    stale.clear();
+    for (size_t i = 0; i < count / 10; i++) {
+      auto &r = live[pick(rng)];
+      render_cache::release(r);
+      stale.push_back(r);
+      r = spawn(i);
+    }
+  });
+
+  float sum = 0.0f;
+  const auto deref = measure(std::format("dereference {} renderables", count), runs, [&] {
+    for (const auto &r : live) sum += r->xform.position().x;
+    do_not_optimize(sum);
+  });
+
+  // tokens with colliders: the colliders of released tokens are destroyed by the next eviction
+  std::vector<collider_ref> dead_colliders;
+  const auto with_colliders = measure(std::format("spawn, despawn and evict {} with colliders", count / 10), runs, [&] {
+    dead_colliders.clear();
+    std::vector<render_ref> tokens;
+    tokens.reserve(count / 10);
+    for (size_t i = 0; i < count / 10; i++) {
+      tokens.push_back(spawn(i));
+      add_collider(tokens.back());
+    }
+    for (const auto &r : tokens) {
+      dead_colliders.push_back(*r->coll);
+      render_cache::release(r);
+    }
+    render_cache::evict_unused();
+  });
+
+  report(spawn_despawn);
+  report(churn);
+  report(deref);
+  report(with_colliders);
+
+  size_t detected = 0;
+  for (const auto &r : stale) {
+    if (!render_cache::contains(r)) detected++;
+  }
+  std::cout << std::format("{} live renderables in {} slots; {} of {} released references detected as stale\n",
+    live.size(), render_cache::slot_count<renderable>(), detected, stale.size());
+
+  size_t dead = 0;
+  for (const auto &c : dead_colliders) {
+    if (!render_cache::contains(c)) dead++;
+  }
+  std::cout << std::format("{} collider slots after {} runs; {} of {} evicted colliders detected as stale\n",
+    render_cache::slot_count<collider>(), runs + 1, dead, dead_colliders.size());
+}
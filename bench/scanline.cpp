@@ -0,0 +1,141 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <cmath>
+#include <numbers>
+#include <random>
+
+#include "bench_util.hpp"
+#include "map/scanline.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+using point = std::pair<int, int>;
+
+/**
+ * @brief The previous implementation of `scanline_fill` (without its logging): every edge is tested against every
+ * row, and every interior point is returned separately.
+ */
+std::vector<point> per_row_fill(const std::vector<point> &points) {
+  using edge = std::pair<point, point>;
+  int y_min = std::numeric_limits<int>::max();
+  int y_max = std::numeric_limits<int>::min();
+
+  std::vector<edge> edges;
+  for (size_t i = 0; i < points.size(); i++) {
+    const auto &[x1, y1] = points[i];
+    const auto &[x2, y2] = points[(i + 1) % points.size()];
+    if (y1 > y2) edges.emplace_back(point{x1, y1}, point{x2, y2});
+    else if (y2 > y1) edges.emplace_back(point{x2, y2}, point{x1, y1});
+    y_min = std::min({y_min, y1, y2});
+    y_max = std::max({y_max, y1, y2});
+  }
+
+  const auto between = [](const float x, const int a, const int b) {
+    return (x >= static_cast<float>(a) && x <= static_cast<float>(b)) || (x >= static_cast<float>(b) && x <= static_cast<float>(a));
+  };
+
+  std::vector<point> result;
+  for (int y = y_min; y <= y_max; y++) {
+    std::vector<std::pair<float, edge>> intersections;
+    for (const auto &[p1, p2] : edges) {
+      const auto &[x1, y1] = p1;
+      const auto &[x2, y2] = p2;
+      if (y > y1 || y < y2) continue;
+      const float x_int = static_cast<float>(x1) + static_cast<float>(y - y1) * static_cast<float>(x2 - x1) / static_cast<float>(y2 - y1);
+      if (between(x_int, x1, x2)) intersections.emplace_back(x_int, edge{p1, p2});
+    }
+    std::ranges::sort(intersections, {}, &std::pair<float, edge>::first);
+
+    bool filling = true;
+    for (size_t i = 0; i + 1 < intersections.size(); i++) {
+      const auto &[x1, edge1] = intersections[i];
+      const auto &[x2, edge2] = intersections[i + 1];
+      if (x2 - x1 <= 1e-6f) {
+        if (std::min({edge1.first.second, edge1.second.second, edge2.first.second, edge2.second.second, y}) == y)
+          result.emplace_back(static_cast<int>(std::round(x1)), y);
+      }
+      else if (filling) {
+        const int xb = static_cast<int>(std::abs(std::round(x1) - x1) < 1e-6f ? std::floor(x1) : std::ceil(x1));
+        const int xe = static_cast<int>(std::abs(std::round(x2) - x2) < 1e-6f ? std::floor(x2 - 1.0f) : std::floor(x2));
+        for (int x = xb; x <= xe; x++) result.emplace_back(x, y);
+        filling = false;
+      }
+      else filling = true;
+    }
+  }
+  return result;
+}
+
+/**
+ * @brief Generates a star-shaped polygon (vertices at increasing angles, at random distances from the center).
+ */
+std::vector<point> star(const size_t vertices, const int grid, std::mt19937 &rng) {
+  std::uniform_real_distribution<float> radius{0.1f, 0.5f};
+  std::vector<point> res;
+  res.reserve(vertices);
+  for (size_t i = 0; i < vertices; i++) {
+    const float angle = 2.0f * std::numbers::pi_v<float> * static_cast<float>(i) / static_cast<float>(vertices);
+    const float r = radius(rng) * static_cast<float>(grid - 1);
+    res.emplace_back(grid / 2 + static_cast<int>(r * std::cos(angle)), grid / 2 + static_cast<int>(r * std::sin(angle)));
+  }
+  return res;
+}
+
+/**
+ * @brief Generates a comb (vertical teeth hanging from a bar at the top), so every row crosses many edges.
+ */
+std::vector<point> comb(const size_t vertices, const int grid) {
+  const int teeth = static_cast<int>(vertices / 4);
+  const int width = grid / teeth;
+  std::vector<point> res;
+  res.reserve(vertices);
+  for (int t = 0; t < teeth; t++) {
+    res.emplace_back(t * width, grid - 1);
+    res.emplace_back(t * width, 0);
+    res.emplace_back(t * width + width / 2, 0);
+    res.emplace_back(t * width + width / 2, grid - 16);
+  }
+  res.emplace_back(teeth * width, grid - 1); // closing the bar
+  return res;
+}
+}
+
+int main(const int argc, const char **argv) {
+  const size_t vertices = argc > 1 ? std::stoul(argv[1]) : 1000;
+  const int grid = argc > 2 ? std::stoi(argv[2]) : 4096;
+  const size_t runs = argc > 3 ? std::stoul(argv[3]) : 10;
+
+  std::mt19937 rng{42};
+  const std::pair<std::string, std::vector<point>> polygons[] = {
+    {"star", star(vertices, grid, rng)},
+    {"comb", comb(vertices, grid)},
+  };
+
+  for (const auto &[name, polygon] : polygons) {
+    const auto spans = scanline_fill(polygon);
+    size_t filled = 0;
+    for (const auto &s : spans) filled += static_cast<size_t>(s.size());
+    std::cout << std::format("--- {}: {} vertices on a {}x{} grid; {} spans, {} points (previous fill: {} points)\n",
+      name, polygon.size(), grid, grid, spans.size(), filled, per_row_fill(polygon).size());
+
+    const auto per_row = measure(name + ": per-row edge tests, points", runs, [&] {
+      do_not_optimize(per_row_fill(polygon).data());
+    });
+    const auto aet = measure(name + ": active edge table, spans", runs, [&] {
+      do_not_optimize(scanline_fill(polygon).data());
+    });
+    const auto aet_points = measure(name + ": active edge table, points", runs, [&] {
+      do_not_optimize(span_points(scanline_fill(polygon)).data());
+    });
+
+    report(per_row);
+    report(aet);
+    report(aet_points);
+    report_speedup(per_row, aet);
+    report_speedup(per_row, aet_points);
+  }
+}
@@ -0,0 +1,72 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <random>
+
+#include "bench_util.hpp"
+#include "renderer/transform.hpp"
+
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+int main(const int argc, const char **argv) {
+  const size_t count = argc > 1 ? std::stoul(argv[1]) : 100'000;
+  const size_t moving = argc > 2 ? std::stoul(argv[2]) : count / 100;
+  const size_t runs = argc > 3 ? std::stoul(argv[3]) : 20;
+
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> coord{-50.0f, 50.0f}, angle{0.0f, 360.0f}, size{0.5f, 2.0f};
+  std::vector<transform> scene(count);
+  for (auto &t : scene) t.set({coord(rng), 0, coord(rng)}, {0, angle(rng), 0}, glm::vec3{size(rng)});
+
+  // what every draw used to do: rebuild the model matrix, and invert it for the normals
+  glm::mat4 m_sum{0.0f};
+  glm::mat3 n_sum{0.0f};
+  const auto rebuild = measure(std::format("rebuild {} model/normal matrices", count), runs, [&] {
+    for (const auto &t : scene) {
+      const auto &p = t.position(), &r = t.rotation(), &s = t.scale();
+      const auto m = glm::mat4(1.0f) | translation(p) | rescale(s) | roll(r.z) | pitch(r.x) | yaw(r.y);
+      m_sum += m;
+      n_sum += glm::mat3(transpose(inverse(m)));
+    }
+    do_not_optimize(m_sum);
+    do_not_optimize(n_sum);
+  });
+
+  const auto cached = measure(std::format("cached matrices, {} static", count), runs, [&] {
+    for (const auto &t : scene) {
+      m_sum += t.world();
+      n_sum += t.normal();
+    }
+    do_not_optimize(m_sum);
+    do_not_optimize(n_sum);
+  });
+
+  std::uniform_int_distribution<size_t> pick{0, count - 1};
+  const auto some_moving = measure(std::format("cached matrices, {} moving", moving), runs, [&] {
+    for (size_t i = 0; i < moving; i++) {
+      auto &t = scene[pick(rng)];
+      t.set_position(t.position() + glm::vec3{0.1f, 0, 0});
+    }
+    for (const auto &t : scene) {
+      m_sum += t.world();
+      n_sum += t.normal();
+    }
+    do_not_optimize(m_sum);
+    do_not_optimize(n_sum);
+  });
+
+  report(rebuild);
+  report(cached);
+  report(some_moving);
+  report_speedup(rebuild, cached);
+  report_speedup(rebuild, some_moving);
+
+  float error = 0.0f;
+  for (const auto &t : scene) {
+    const glm::mat3 expected = transpose(inverse(glm::mat3(t.world())));
+    for (int c = 0; c < 3; c++) error = std::max(error, glm::length(expected[c] - t.normal()[c]));
+  }
+  std::cout << std::format("max deviation of the cached normal matrix from transpose(inverse(model)): {}\n", error);
+}
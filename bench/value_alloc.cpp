@@ -0,0 +1,102 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sstream>
+#include <mapLexer.h>
+#include <mapParser.h>
+
+#include "bench_util.hpp"
+#include "map/map_compiler.hpp"
+#include "map/map_interpreter.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::bench;
+
+namespace {
+std::atomic<size_t> allocations{0};
+std::atomic<size_t> allocated_bytes{0};
+
+/**
+ * @brief Snapshot of the global allocation counters.
+ */
+struct alloc_stats {
+  size_t count; //!< The amount of allocations.
+  size_t bytes; //!< The total amount of allocated bytes.
+
+  static alloc_stats now() { return {allocations.load(), allocated_bytes.load()}; }
+  alloc_stats operator-(const alloc_stats &other) const { return {count - other.count, bytes - other.bytes}; }
+};
+
+/**
+ * @brief Generates a map holding a single list literal with the requested amount of elements.
+ *
+ * The elements alternate between numbers and pairs, so both inline values and pairs are measured.
+ */
+std::string list_map(const size_t elements) {
+  std::stringstream strm;
+  strm << "objects {\n  all = [";
+  for (size_t i = 0; i < elements; i++) {
+    if (i != 0) strm << ", ";
+    if (i % 2 == 0) strm << i;
+    else strm << std::format("({}, \"item{}\")", i, i);
+  }
+  strm << "];\n}\n";
+  return strm.str();
+}
+}
+
+void *operator new(const size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) return ptr;
+  throw std::bad_alloc{};
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t) noexcept { std::free(ptr); }
+
+int main(const int argc, const char **argv) {
+  const size_t elements = argc > 1 ? std::stoul(argv[1]) : 100000;
+  const size_t runs = argc > 2 ? std::stoul(argv[2]) : 10;
+  const std::string file = "(synthetic)";
+  const std::string source = list_map(elements);
+
+  antlr4::ANTLRInputStream input(source);
+  mapLexer lexer(&input);
+  antlr4::CommonTokenStream tokens(&lexer);
+  mapParser parser(&tokens);
+  auto *tree = parser.program();
+
+  std::cout << std::format("sizeof(value) = {}, sizeof(loc) = {}, sizeof(value_pair) = {}\n",
+    sizeof(value), sizeof(loc), sizeof(value_pair));
+  std::cout << std::format("List map: {} elements, {} bytes\n", elements, source.size());
+
+  const auto before_compile = alloc_stats::now();
+  auto prog = map_compiler::compile(tree, file);
+  resolve_slots(prog);
+  const auto compiled = alloc_stats::now() - before_compile;
+
+  const auto before_run = alloc_stats::now();
+  {
+    map_interpreter i;
+    i.file = file;
+    i.run(prog);
+    do_not_optimize(i.show_axes);
+  }
+  const auto ran = alloc_stats::now() - before_run;
+
+  std::cout << std::format("compile + resolve: {} allocations, {} bytes ({:.2f} allocations/element)\n",
+    compiled.count, compiled.bytes, static_cast<double>(compiled.count) / static_cast<double>(elements));
+  std::cout << std::format("interpret:         {} allocations, {} bytes ({:.2f} allocations/element)\n",
+    ran.count, ran.bytes, static_cast<double>(ran.count) / static_cast<double>(elements));
+
+  report(measure("interpret", runs, [&] {
+    map_interpreter i;
+    i.file = file;
+    i.run(prog);
+    do_not_optimize(i.show_axes);
+  }));
+}
@@ -0,0 +1,83 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <random>
+#include <glm/ext/matrix_clip_space.hpp>
+#include <glm/ext/matrix_transform.hpp>
+
+#include "bench_util.hpp"
+#include "renderer/object.hpp"
+
+using namespace openvtt::renderer;
+using namespace openvtt::bench;
+
+namespace {
+/**
+ * @brief Generates a square outdoor-like terrain: large uniform areas (grass, sand, water), with some detailed tiles.
+ * @param side The amount of tiles along each side.
+ * @param detail The fraction of detailed (non-uniform) tiles.
+ */
+std::vector<voxel_tile> terrain(const int side, const float detail) {
+  constexpr glm::vec3 palette[] = { {0.2f, 0.6f, 0.2f}, {0.8f, 0.7f, 0.4f}, {0.1f, 0.3f, 0.7f} };
+  std::mt19937 rng{42};
+  std::uniform_real_distribution<float> unit{0.0f, 1.0f};
+
+  std::vector<voxel_tile> tiles;
+  tiles.reserve(static_cast<size_t>(side) * side);
+  for (int y = 0; y < side; y++) {
+    for (int x = 0; x < side; x++) {
+      const auto &color = palette[(x / 48 + y / 80) % std::size(palette)];
+      voxel_tile t{{x, y}, {}, {}, {}};
+      t.back.fill(color);
+      t.spot.fill(color * 0.8f);
+      t.fac.fill(0.5f);
+      if (unit(rng) < detail) t.fac[4] = 1.0f;
+      tiles.push_back(t);
+    }
+  }
+  return tiles;
+}
+}
+
+int main(const int argc, const char **argv) {
+  const int side = argc > 1 ? std::stoi(argv[1]) : 1024;
+  const float detail = argc > 2 ? std::stof(argv[2]) : 0.02f;
+  const size_t runs = argc > 3 ? std::stoul(argv[3]) : 5;
+
+  const auto tiles = terrain(side, detail);
+  // (alpha, beta, delta) per tier
+  const glm::mat4x3 tiers{ {1.0f, 0.25f, 0.3f}, {0.5f, 1.0f, -0.7f}, {0.25f, 4.0f, 0.1f}, {0.0f, 0.0f, 0.0f} };
+  voxel_terrain::decoded meshed;
+  const auto mesh = measure(std::format("meshing and baking {}x{} tiles", side, side), runs, [&] {
+    meshed = voxel_terrain::decode(tiles, tiers);
+  });
+  report(mesh);
+
+  size_t merged = 0, patches = 0, triangles = 0;
+  for (const auto &c : meshed.chunks) {
+    merged += c.merged;
+    patches += c.patches;
+    triangles += c.indices.size() / 3;
+  }
+  std::cout << std::format("{} tiles in {} chunks: {} merged quads, {} detailed tiles; {} triangles (voxel group: {})\n",
+    tiles.size(), meshed.chunks.size(), merged, patches, triangles, tiles.size() * 16);
+
+  // a camera like the default one, hovering above the terrain (see `camera`)
+  const glm::mat4 projection = glm::perspective(glm::radians(45.0f), 16.0f / 9.0f, 0.1f, 100.0f);
+  for (const glm::vec3 pos : {glm::vec3{0, 11, 18}, glm::vec3{side / 2.0f, 11, side / 2.0f + 18}, glm::vec3{side / 2.0f, 60, side / 2.0f + 60}}) {
+    const auto view = frustum::from(projection * lookAt(pos, pos + glm::normalize(glm::vec3{0, -11, -18}), {0, 1, 0}));
+    size_t visible = 0, visible_triangles = 0;
+    const auto cull = measure(std::format("culling at ({}, {}, {})", pos.x, pos.y, pos.z), runs * 20, [&] {
+      visible = visible_triangles = 0;
+      for (const auto &c : meshed.chunks) {
+        if (!view.intersects(c.min, c.max)) continue;
+        visible++;
+        visible_triangles += c.indices.size() / 3;
+      }
+      do_not_optimize(visible);
+    });
+    report(cull);
+    std::cout << std::format("  -> {} of {} chunks drawn, {} triangles\n", visible, meshed.chunks.size(), visible_triangles);
+  }
+}
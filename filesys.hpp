@@ -6,8 +6,19 @@
 #define FILESYS_HPP
 
 #include <string>
+#include <vector>
+#include <span>
+#include <fstream>
 #include <whereami.h>
 
+#if __has_include(<sys/mman.h>)
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OPENVTT_HAS_MMAP
+#endif
+
 /**
 * @brief Main namespace for the OpenVTT project.
 */
@@ -79,6 +90,88 @@ inline std::string asset_path(const std::string &asset_name) {
 
   return exe_dir() + "/assets" + type_to_dir(type) + asset_name + "." + type_to_ext(type);
 }
+
+/**
+* @brief A read-only view of a file's contents.
+*
+* On POSIX systems, the file is memory-mapped (so opening it doesn't copy anything). Elsewhere, the file is read into
+* memory in one go. In both cases, the contents remain valid for the lifetime of the object.
+*/
+class mapped_file {
+public:
+  /**
+  * @brief Opens (and maps) a file.
+  * @param path The path to the file.
+  *
+  * If the file can't be opened, the object is empty (see `is_open`).
+  */
+  explicit mapped_file(const std::string &path) {
+#ifdef OPENVTT_HAS_MMAP
+    const int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat st{};
+    if (fstat(fd, &st) == 0) {
+      len = static_cast<size_t>(st.st_size);
+      opened = true;
+      if (len > 0) {
+        void *ptr = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr == MAP_FAILED) { len = 0; opened = false; }
+        else data = static_cast<const std::byte *>(ptr);
+      }
+    }
+    close(fd);
+#else
+    std::ifstream strm(path, std::ios::binary | std::ios::ate);
+    if (!strm.is_open()) return;
+    buffer.resize(static_cast<size_t>(strm.tellg()));
+    strm.seekg(0);
+    strm.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    data = buffer.data();
+    len = buffer.size();
+    opened = true;
+#endif
+  }
+
+  mapped_file(const mapped_file &) = delete;
+  mapped_file(mapped_file &&) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+  mapped_file &operator=(mapped_file &&) = delete;
+
+  /**
+  * @brief Checks if the file was opened successfully.
+  * @return `true` if the file could be opened, `false` otherwise.
+  */
+  [[nodiscard]] bool is_open() const { return opened; }
+
+  /**
+  * @brief Gets the contents of the file as raw bytes.
+  * @return A view of the contents.
+  */
+  [[nodiscard]] std::span<const std::byte> bytes() const { return {data, len}; }
+
+  /**
+  * @brief Gets the contents of the file as text.
+  * @return A view of the contents.
+  */
+  [[nodiscard]] std::string_view text() const { return {reinterpret_cast<const char *>(data), len}; }
+
+  /**
+  * @brief Unmaps the file.
+  */
+  ~mapped_file() {
+#ifdef OPENVTT_HAS_MMAP
+    if (data != nullptr) munmap(const_cast<std::byte *>(data), len);
+#endif
+  }
+
+private:
+  const std::byte *data = nullptr;
+  size_t len = 0;
+  bool opened = false;
+#ifndef OPENVTT_HAS_MMAP
+  std::vector<std::byte> buffer;
+#endif
+};
 }
 
 #endif //FILESYS_HPP
@@ -25,6 +25,9 @@ expr: x=IDENTIFIER                                  #idExpr
     | '(' x=expr ',' y=expr ',' z=expr ')'          #vec3Expr
     | '[' ']'                                       #emptyListExpr
     | '[' exprs=exprList ']'                        #listExpr
+    | '[' from=expr '..' to=expr ']'                #rangeExpr
+    | '[' elem=expr 'for' var=IDENTIFIER 'in' from=expr '..' to=expr ']'
+                                                    #comprehensionExpr
     // parenthesized
     | '(' e=expr ')'                                #parenExpr
     // operators
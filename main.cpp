@@ -1,7 +1,10 @@
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <glm/gtc/random.hpp>
 
 #include "renderer/window.hpp"
+#include "renderer/gl_backend.hpp"
 #include "renderer/fps_counter.hpp"
 #include "renderer/log_view.hpp"
 #include "renderer/renderable.hpp"
@@ -9,24 +12,61 @@
 #include "renderer/hover_highlighter.hpp"
 
 #include "map/map_parser.hpp"
+#include "map/map_watcher.hpp"
+#include "map/region_streamer.hpp"
 #include "renderer/gizmos.hpp"
 
 using namespace openvtt::map;
 using namespace openvtt::renderer;
 
 constexpr size_t point_light_count = 10;
+constexpr size_t max_resident_regions = 16;
+
+/**
+ * @brief Loads a map on the null backend (without opening a window), and reports what it did.
+ * @param map_asset The map to load.
+ * @param opts The options for loading the map.
+ * @return The exit code.
+ */
+int run_headless(const std::string &map_asset, const parse_options &opts) {
+  gl_backend::use_null();
+  const auto start = std::chrono::steady_clock::now();
+  const auto desc = map_desc::parse_from(map_asset, opts);
+  const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+  std::cout << std::format("Loaded map {} in {:.3f} ms: {} renderables, {} instanced renderables, {} regions\n",
+    map_asset, elapsed, desc.scene.size(), desc.scene_instances.size(), desc.regions.size());
+
+  std::vector<std::pair<std::string_view, size_t>> calls(gl_backend::calls().begin(), gl_backend::calls().end());
+  std::ranges::sort(calls);
+  for (const auto &[call, count] : calls) std::cout << std::format("  {:<28} {}\n", call, count);
+  return desc.sources.empty() ? 1 : 0;
+}
 
 int main(int argc, const char **argv) {
   using cache = render_cache;
+
+  parse_options map_opts{};
+  bool watch = false;
+  bool headless = false;
+  std::string map_asset = "examples/suzannes";
+  for (int i = 1; i < argc; i++) {
+    if (const std::string_view arg = argv[i]; arg == "--dump-map-program") map_opts.dump_program = true;
+    else if (arg == "--watch") watch = true;
+    else if (arg == "--antlr-parser") map_opts.antlr_parser = true;
+    else if (arg == "--headless") headless = true;
+    else if (arg == "--map" && i + 1 < argc) map_asset = argv[++i];
+    else std::cerr << std::format("Unknown argument {} (ignored)\n", arg);
+  }
+
+  if (headless) return run_headless(map_asset, map_opts);
+
   auto &win = window::get();
-  const auto [
-    scene,
-    scene_instances,
-    requires_highlight,
-    requires_instanced_highlight,
-    highlight_binding,
-    enable_axes
-  ] = map_desc::parse_from("examples/suzannes");
+  auto desc = map_desc::parse_from(map_asset, map_opts);
+  map_watcher watcher;
+  if (watch) watcher.watch(desc.sources);
+  region_streamer streamer(max_resident_regions, map_opts);
+  streamer.reset(desc.regions);
 
   auto cam = camera{};
 
@@ -49,19 +89,32 @@ int main(int argc, const char **argv) {
   std::vector<std::pair<render_ref, single_highlight>> set_highlight;
   std::vector<std::pair<instanced_render_ref, instanced_highlight>> set_inst_highlight;
 
-  for (const auto &r: scene) {
-    if (const auto it = requires_highlight.find(r->sh); it != requires_highlight.end())
-      set_highlight.emplace_back(r, it->second);
-    else
-      set_base.emplace_back(r);
-  }
+  const auto partition_scene = [&] {
+    set_base.clear();
+    set_inst_base.clear();
+    set_highlight.clear();
+    set_inst_highlight.clear();
+
+    const auto partition = [&](const map_desc &d) {
+      for (const auto &r: d.scene) {
+        if (const auto it = d.requires_highlight.find(r->sh); it != d.requires_highlight.end())
+          set_highlight.emplace_back(r, it->second);
+        else
+          set_base.emplace_back(r);
+      }
 
-  for (const auto &i: scene_instances) {
-    if (const auto it = requires_instanced_highlight.find(i->sh); it != requires_instanced_highlight.end())
-      set_inst_highlight.emplace_back(i, it->second);
-    else
-      set_inst_base.emplace_back(i);
-  }
+      for (const auto &i: d.scene_instances) {
+        if (const auto it = d.requires_instanced_highlight.find(i->sh); it != d.requires_instanced_highlight.end())
+          set_inst_highlight.emplace_back(i, it->second);
+        else
+          set_inst_base.emplace_back(i);
+      }
+    };
+
+    partition(desc);
+    for (const auto *region : streamer.resident()) partition(*region);
+  };
+  partition_scene();
 
   // requires static - otherwise lambda captures get invalidated for some reason
   static single_highlight curr_single{0,0};
@@ -86,21 +139,33 @@ int main(int argc, const char **argv) {
   while (!win.should_close()) {
     if (!win.frame_pre()) continue;
 
+    if (watch && watcher.changed()) {
+      desc = map_desc::reload_from(map_asset, desc, map_opts);
+      watcher.watch(desc.sources);
+      streamer.reset(desc.regions);
+      partition_scene();
+    }
+
     highlighter::reset();
 
     cam.handle_input();
+    if (streamer.update(cam.position)) partition_scene();
 
     highlighter::highlight_checking(cam);
 
-    if (highlight_binding.has_value()) {
-      highlighter::bind_highlight_tex(*highlight_binding);
-
-      for (const auto &[s, idx] : requires_highlight) {
-        s->set_int(idx.uniform_tex, *highlight_binding);
-      }
-      for (const auto &[s, idx] : requires_instanced_highlight) {
-        s->set_int(idx.uniform_tex, *highlight_binding);
-      }
+    if (desc.highlight_binding.has_value()) {
+      highlighter::bind_highlight_tex(*desc.highlight_binding);
+
+      const auto bind_highlight = [&](const map_desc &d) {
+        for (const auto &[s, idx] : d.requires_highlight) {
+          s->set_int(idx.uniform_tex, *desc.highlight_binding);
+        }
+        for (const auto &[s, idx] : d.requires_instanced_highlight) {
+          s->set_int(idx.uniform_tex, *desc.highlight_binding);
+        }
+      };
+      bind_highlight(desc);
+      for (const auto *region : streamer.resident()) bind_highlight(*region);
     }
 
     for (const auto &r : set_base) r->draw(cam, lighting_default);
@@ -116,7 +181,7 @@ int main(int argc, const char **argv) {
 
     cache::draw_colliders(cam);
 
-    if (enable_axes) ax.draw(cam);
+    if (desc.show_axes) ax.draw(cam);
 
     const auto mouse = cache::mouse_y0(cam);
     // ax.draw(cam, {mouse.x, 0, mouse.y}, 0.25f);
@@ -5,8 +5,14 @@
 #ifndef MAP_BUILTINS_HPP
 #define MAP_BUILTINS_HPP
 
+#include <algorithm>
+#include <span>
+#include <sstream>
+
 #include "either.hpp"
 #include "object_cache.hpp"
+#include "map_state.hpp"
+#include "map_program.hpp"
 #include "map_visitor.hpp"
 #include "renderer/log_view.hpp"
 #include "scanline.hpp"
@@ -20,19 +26,6 @@ namespace openvtt::map {
  */
 template <typename T> using or_error = either<std::string, T>;
 
-/**
- * @brief Checks if a function is called with the correct number of arguments.
- * @param args The provided arguments.
- * @param n The expected number of arguments.
- * @param function The function name.
- * @param pos The positions of the call
- * @return Either the arguments (again) or an error message.
- */
-inline or_error<std::vector<value>> n_args(const std::vector<value> &args, const size_t n, const std::string &function, const loc &pos) {
-  if (args.size() != n) return left(std::format("Function {} expects {} arguments, but got {} at {}.", function, n, args.size(), pos.str()));
-  return right(args);
-}
-
 /**
  * @brief Type-checks a value.
  * @tparam T The expected type.
@@ -40,6 +33,8 @@ inline or_error<std::vector<value>> n_args(const std::vector<value> &args, const
  * @return The contained value, or and error message.
  *
  * If the provided value is of the required type, returns that value as a `right(value)`.
+ * Lists are converted where possible: any list is accepted as a `value_list` (boxing packed lists), and a `value_list`
+ * whose elements all have the right type is accepted as a packed list.
  * Otherwise, an error message is returned as a `left(error)`.
  */
 template <valid_value T>
@@ -48,6 +43,20 @@ inline or_error<T> type_check(const value &v) {
   if constexpr(std::same_as<T, float>) {
     if (v.is<int>()) return right(static_cast<float>(v.as<int>()));
   }
+  if constexpr(std::same_as<T, value_list>) {
+    if (v.is_list()) return right(v.as_list());
+  }
+  if constexpr(packed_array<T>) {
+    if (v.is<value_list>()) {
+      std::vector<typename T::value_type> res;
+      res.reserve(v.as<value_list>().size());
+      for (const auto &x : v.as<value_list>()) {
+        if (const auto y = type_check<typename T::value_type>(x); y.is_right()) res.push_back(y.right());
+        else return left(y.left());
+      }
+      return right(T{std::move(res)});
+    }
+  }
   return left(std::format("Expected a value of type {}, but got {} at {}.", type_name<T>(), v.type_name(), v.pos().str()));
 }
 
@@ -71,7 +80,7 @@ or_error<std::tuple<Ts...>> type_check_multi(const std::array<value, sizeof...(T
 }
 
 /**
- * @brief Check if all values in the vector have the same type.
+ * @brief Check if all values in the list have the same type.
  * @tparam T The expected type.
  * @param vs The values to check.
  * @return A vector with the contained values, or an error message.
@@ -81,7 +90,7 @@ or_error<std::tuple<Ts...>> type_check_multi(const std::array<value, sizeof...(T
  * Otherwise, all values are "unwrapped" and returned as a new vector.
  */
 template <typename T>
-inline or_error<std::vector<T>> type_check_vector(const std::vector<value> &vs) {
+inline or_error<std::vector<T>> type_check_vector(const value_list &vs) {
   std::vector<T> res;
   res.reserve(vs.size());
   for (const auto &v: vs) {
@@ -109,7 +118,7 @@ inline or_error<std::vector<T>> type_check_vector(const std::vector<value> &vs)
  */
 template <std::invocable<const value_pair &> F>
 requires(is_either<res_t<F, const value_pair &>>)
-inline or_error<std::vector<typename either_traits<res_t<F, const value_pair &>>::right_t>> type_check_pair_vector(const std::vector<value> &vs, F &&f) {
+inline or_error<std::vector<typename either_traits<res_t<F, const value_pair &>>::right_t>> type_check_pair_vector(const value_list &vs, F &&f) {
   using mapped_t = typename either_traits<res_t<F, const value_pair &>>::right_t;
   std::vector<mapped_t> res;
   res.reserve(vs.size());
@@ -124,547 +133,500 @@ inline or_error<std::vector<typename either_traits<res_t<F, const value_pair &>>
 }
 
 /**
- * @brief Checks if a function is called with exactly one argument of the provided type.
- * @tparam T The expected argument type.
- * @param args The provided arguments.
- * @param function The function name.
- * @param pos The position of the call.
- * @return Either the first (and only) value in the list, or an error message.
- *
- * This is a convenience function wrapping `n_args` (for 1 argument) and `type_check<T>`.
+ * @brief Gets a human-readable description of a scope (for error messages).
+ * @param scope The scope.
+ * @return The description.
  */
-template <valid_value T>
-or_error<T> ready_arg(const std::vector<value> &args, const std::string &function, const loc &pos) {
-  return n_args(args, 1, function, pos) >> [](const std::vector<value> &a) { return type_check<T>(a[0]); };
+constexpr std::string_view scope_name(const map_state::scope scope) {
+  switch (scope) {
+    case map_state::scope::NONE: return "(no scope)";
+    case map_state::scope::VOXEL: return "a voxel scope";
+    case map_state::scope::OBJECTS: return "an objects scope";
+  }
+  OPENVTT_UNREACHABLE;
 }
 
 /**
- * @brief Checks if a function is called with the exact amount of arguments of the provided types.
- * @tparam Ts The expected argument types.
- * @param args The provided arguments.
- * @param function The function name.
- * @param pos The position of the call.
- * @return Either a tuple of the contained values, or an error message.
- *
- * This is a convenience function wrapping `n_args` (for `sizeof...(Ts)` arguments) and `type_check_multi<Ts...>`.
+ * @brief Logs a (recoverable) error reported by a builtin function.
+ * @param err The error message.
  */
-template <valid_value ... Ts>
-or_error<std::tuple<Ts...>> ready_args(const std::vector<value> &args, const std::string &function, const loc &pos) {
-  constexpr static auto lambda = []<size_t ... idxs>(const std::vector<value> &a, std::index_sequence<idxs...>) {
-    return type_check_multi<Ts...>({a[idxs]...});
-  };
+inline void builtin_warning(const std::string &err) {
+  renderer::log<renderer::log_type::WARNING>("map_loader", err);
+}
 
-  return n_args(args, sizeof...(Ts), function, pos)
-    >> [](const std::vector<value> &a) { return lambda(a, std::make_index_sequence<sizeof...(Ts)>{}); };
+/**
+ * @brief Type-checks the texture bindings passed to `spawn` and `spawn*`.
+ * @param textures The list of `(int, texture)` pairs.
+ * @return Either the texture bindings, or an error message.
+ */
+inline or_error<map_state::texture_list> texture_bindings(const value_list &textures) {
+  return type_check_pair_vector(textures, [](const value_pair &vp) {
+    return type_check_multi<int, renderer::texture_ref>({vp.first(), vp.second()}) |
+      [](const std::pair<int, renderer::texture_ref> &p) { return std::pair{static_cast<unsigned int>(p.first), p.second}; };
+  });
 }
 
 /**
- * @brief Handles the result of a function call.
- * @tparam T The provided value.
- * @param res The result to be unwrapped.
- * @param pos The position of the call.
- * @param backup The value to be returned in case of errors.
- * @return Either the contained value, or the backup value.
- *
- * If the provided value (which is expected to be the result of invoking a builtin function) is an error, the error is
- * logged, and the default (backup) value is returned instead.
- * Otherwise, the (successful) return value of the function is passed along.
+ * @brief The builtin `object` function: loads an object (mesh) from an asset file.
+ * @param asset The asset file.
+ * @return A reference to the (loaded) object.
  */
-template <valid_value T>
-value handle(const or_error<T> &res, const loc &pos, const T &backup = {}) {
-  return fold(
-    map_left(res, [&backup](const std::string &err){ renderer::log<renderer::log_type::WARNING>("map_loader", err); return backup; }),
-    [&pos](const T &x) -> value { return value{x, pos}; },
-    [&pos](const T &x) -> value { return value{x, pos}; }
-  );
+inline renderer::object_ref builtin_object(map_state &, const loc &, const std::string &asset) {
+  return renderer::render_cache::load<renderer::render_object>(asset);
 }
 
 /**
- * @brief Handles the result of a function call that returns no value.
- * @tparam T The provided value (ignored).
- * @param res The result to be unwrapped.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate` (void).
+ * @brief The builtin `object*` function: loads an object (mesh) from an asset file, and creates a set of instances.
+ * @param asset The asset file.
+ * @param transforms The transforms of the instances.
+ * @return A reference to the (loaded) instanced object.
  *
- * If the provided value is an error, the error is logged.
- * After the check, this function returns a value of type `std::monostate` (which is used to indicate "no value").
+ * Packed lists (`mat4[]`) are passed to the renderer as-is, without unboxing or copying.
  */
-template <typename T>
-value handle_no_value(const or_error<T> &res, const loc &pos) {
-  map_left(res, [](const std::string &err) { renderer::log<renderer::log_type::WARNING>("map_loader", err); return std::monostate{}; });
-  return value{std::monostate{}, pos};
+inline renderer::instanced_object_ref builtin_object_star(map_state &, const loc &, const std::string &asset, const mat4_array &transforms) {
+  return renderer::render_cache::load<renderer::instanced_object>(asset, transforms.span());
 }
 
 /**
- * @brief Verifies if a builtin function running in the given visitor is executed with the correct scope.
- * @tparam s The expected scope.
- * @param func The function name.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either an empty success value (`either_tag`), or an error message.
- */
-template <map_visitor::scope s>
-inline or_error<either_tag> requires_scope(const std::string &func, const map_visitor &v, const loc &pos) {
-  constexpr static auto scope_name = [](const map_visitor::scope &scope) -> std::string {
-    switch (scope) {
-      case map_visitor::scope::NONE: return "(no scope)";
-      case map_visitor::scope::VOXEL: return "a voxel scope";
-      case map_visitor::scope::OBJECTS: return "an objects scope";
-    }
-    OPENVTT_UNREACHABLE;
-  };
-
-  if (v.current_scope != s) return left(std::format("Function {} requires {} (at {})", func, scope_name(s), pos.str()));
-  return right(either_tag{});
+ * @brief The builtin `shader` function: loads a shader pair (vertex and fragment) from the respective asset files.
+ * @param vs The vertex shader asset.
+ * @param fs The fragment shader asset.
+ * @return A reference to the (loaded) shader.
+ */
+inline renderer::shader_ref builtin_shader(map_state &, const loc &, const std::string &vs, const std::string &fs) {
+  return renderer::render_cache::load<renderer::shader>(vs, fs);
 }
 
 /**
- * @brief Invokes the builtin `object` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) object, or an invalid reference.
- *
- * The `object` builtin loads an object (mesh) from an asset file.
- * This function expects a single `string` argument.
+ * @brief The builtin `texture` function: loads a texture from an asset file.
+ * @param asset The asset file.
+ * @return A reference to the (loaded) texture.
  */
-inline value invoke_object(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-    requires_scope<map_visitor::scope::OBJECTS>("@object", v, pos) >>
-    [&args, &pos] { return ready_arg<std::string>(args, "@object", pos); } |
-    [](const std::string &asset) { return renderer::render_cache::load<renderer::render_object>(asset); },
+inline renderer::texture_ref builtin_texture(map_state &, const loc &, const std::string &asset) {
+  return renderer::render_cache::load<renderer::texture>(asset);
+}
 
-    pos, renderer::object_ref::invalid());
+/**
+ * @brief The builtin `collider` function: loads a collider (mesh) from an asset file.
+ * @param asset The asset file.
+ * @return A reference to the (loaded) collider.
+ */
+inline renderer::collider_ref builtin_collider(map_state &, const loc &, const std::string &asset) {
+  return renderer::render_cache::load<renderer::collider>(asset);
 }
 
 /**
- * @brief Invokes the builtin `object*` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) instanced object, or an invalid reference.
+ * @brief The builtin `collider*` function: loads a collider (mesh) from an asset file, and creates a set of instances.
+ * @param asset The asset file.
+ * @param transforms The transforms of the instances.
+ * @return A reference to the (loaded) instanced collider.
  *
- * The `object*` builtin loads an object (mesh) from an asset file, and creates a set of instances from it.
- * This function expects a `string` argument (the asset file) and a vector of `mat4` values (the transforms).
- */
-inline value invoke_object_star(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@object*", v, pos) >>
-    [&args, &pos] { return ready_args<std::string, std::vector<value>>(args, "@object*", pos); } >>
-    [](const std::tuple<std::string, std::vector<value>> &tup) {
-      const auto &[asset, transforms] = tup;
-      return type_check_vector<glm::mat4>(transforms) | [&asset](const auto &mats) { return std::pair{asset, mats}; };
-    } |
-    [](const std::pair<std::string, std::vector<glm::mat4>> &p) {
-      const auto &[asset, transforms] = p;
-      return renderer::render_cache::load<renderer::instanced_object>(asset, transforms);
-    },
-
-    pos, renderer::instanced_object_ref::invalid()
-  );
-}
-
-/**
- * @brief Invokes the builtin `shader` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) shader, or an invalid reference.
- *
- * The `shader` builtin loads a shader pair (vertex and fragment) from the respective asset files.
- * This function expects two `string` arguments.
+ * Packed lists (`mat4[]`) are passed to the renderer as-is, without unboxing or copying.
  */
-inline value invoke_shader(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@shader", v, pos) >>
-    [&args, &pos] { return ready_args<std::string, std::string>(args, "@shader", pos); } |
-    [](const std::tuple<std::string, std::string> &vf) { return renderer::render_cache::load<renderer::shader>(std::get<0>(vf), std::get<1>(vf)); },
+inline renderer::instanced_collider_ref builtin_collider_star(map_state &, const loc &, const std::string &asset, const mat4_array &transforms) {
+  return renderer::render_cache::load<renderer::instanced_collider>(asset, transforms.span());
+}
 
-    pos, renderer::shader_ref::invalid()
-  );
+/**
+ * @brief The builtin `transform` function: constructs a model matrix.
+ * @param pos The position.
+ * @param rot The rotation (yaw-pitch-roll).
+ * @param scale The scale.
+ * @return The model matrix.
+ */
+inline glm::mat4 builtin_transform(map_state &, const loc &, const glm::vec3 &pos, const glm::vec3 &rot, const glm::vec3 &scale) {
+  return renderer::instanced_object::model_for(rot, scale, pos);
 }
 
 /**
- * @brief Invokes the builtin `texture` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) texture, or an invalid reference.
- *
- * The `texture` builtin loads texture from an asset file.
- * This function expects a single `string` argument (the asset file).
+ * @brief The builtin `spawn` function: creates a new renderable object.
+ * @param state The map state.
+ * @param name The name of the renderable.
+ * @param obj The object to render.
+ * @param sh The shader to use.
+ * @param textures A list of `(int, texture)` pairs (indicating which textures are bound to which shader uniforms).
+ * @return A reference to the spawned object, or an invalid reference.
  */
-inline value invoke_texture(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@texture", v, pos) >>
-    [&args, &pos] { return ready_arg<std::string>(args, "@texture", pos); } |
-    [](const std::string &asset) { return renderer::render_cache::construct<renderer::texture>(asset); },
+inline renderer::render_ref builtin_spawn(
+  map_state &state, const loc &, const std::string &name, const renderer::object_ref &obj, const renderer::shader_ref &sh,
+  const value_list &textures
+) {
+  const auto tex = texture_bindings(textures);
+  if (tex.is_left()) {
+    builtin_warning(tex.left());
+    return renderer::render_ref::invalid();
+  }
+  return state.spawn(name, obj, sh, tex.right());
+}
 
-    pos, renderer::texture_ref::invalid()
-  );
+/**
+ * @brief The builtin `spawn*` function: creates a new instanced renderable object.
+ * @param state The map state.
+ * @param name The name of the renderable.
+ * @param obj The instanced object to render.
+ * @param sh The shader to use.
+ * @param textures A list of `(int, texture)` pairs (indicating which textures are bound to which shader uniforms).
+ * @return A reference to the spawned instanced object, or an invalid reference.
+ */
+inline renderer::instanced_render_ref builtin_spawn_star(
+  map_state &state, const loc &, const std::string &name, const renderer::instanced_object_ref &obj,
+  const renderer::shader_ref &sh, const value_list &textures
+) {
+  const auto tex = texture_bindings(textures);
+  if (tex.is_left()) {
+    builtin_warning(tex.left());
+    return renderer::instanced_render_ref::invalid();
+  }
+  return state.spawn(name, obj, sh, tex.right());
 }
 
 /**
- * @brief Invokes the builtin `collider` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) collider, or an invalid reference.
- *
- * The `collider` builtin loads a collider (mesh) from an asset file.
- * This function expects a single `string` argument (the asset file).
+ * @brief The builtin `transform_obj` function: sets the position, rotation, and scale of a renderable object.
+ * @param rr The renderable.
+ * @param p The position.
+ * @param r The rotation.
+ * @param s The scale.
  */
-inline value invoke_collider(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@collider", v, pos) >>
-    [&args, &pos] { return ready_arg<std::string>(args, "@collider", pos); } |
-    [](const std::string &asset) { return renderer::render_cache::load<renderer::collider>(asset); },
+inline std::monostate builtin_transform_obj(
+  map_state &, const loc &, const renderer::render_ref &rr, const glm::vec3 &p, const glm::vec3 &r, const glm::vec3 &s
+) {
+  rr->xform.set(p, r, s);
+  return {};
+}
 
-    pos, renderer::collider_ref::invalid()
-  );
+/**
+ * @brief The builtin `enable_highlight` function: sets the uniforms in a shader for highlighting.
+ * @param state The map state.
+ * @param sh The shader.
+ * @param uniform_tex The uniform to bind the highlighting FBO texture to.
+ * @param uniform_toggle The uniform determining if this object is the main object to be highlighted.
+ */
+inline std::monostate builtin_enable_highlight(
+  map_state &state, const loc &, const renderer::shader_ref &sh, const std::string &uniform_tex, const std::string &uniform_toggle
+) {
+  state.requires_highlight[sh] = {sh->loc_for(uniform_tex), sh->loc_for(uniform_toggle)};
+  return {};
 }
 
 /**
- * @brief Invokes the builtin `collider*` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a reference to the (loaded) instanced collider, or an invalid reference.
- *
- * The `collider*` builtin loads a collider (mesh) from an asset file, and creates a set of instances from it.
- * This function expects a `string` argument (the asset file) and a vector of `mat4` values (the transforms).
- */
-inline value invoke_collider_star(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@collider*", v, pos) >>
-    [&args, &pos] { return ready_args<std::string, std::vector<value>>(args, "@collider*", pos); } >>
-    [](const std::tuple<std::string, std::vector<value>> &tup) {
-      const auto &[asset, transforms] = tup;
-      return type_check_vector<glm::mat4>(transforms) | [&asset](const auto &mats) { return std::pair{asset, mats}; };
-    } |
-    [](const std::pair<std::string, std::vector<glm::mat4>> &p) {
-      const auto &[asset, transforms] = p;
-      return renderer::render_cache::load<renderer::instanced_collider>(asset, transforms);
-    },
-
-    pos, renderer::instanced_collider_ref::invalid()
-  );
-}
-
-/**
- * @brief Invokes the builtin `transform` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return Either a model matrix, or the identity matrix.
- *
- * The `transform` builtin constructs a model matrix from the provided position, rotation, and scale vectors.
- * This function expects three `vec3` arguments.
+ * @brief The builtin `enable_highlight*` function: sets the uniforms in a shader for instanced highlighting.
+ * @param state The map state.
+ * @param sh The shader.
+ * @param uniform_tex The uniform to bind the highlighting FBO texture to.
+ * @param uniform_toggle The uniform determining if this object is the main object to be highlighted.
+ * @param uniform_highlight_id The uniform determining the highlighted instance ID.
  */
-inline value invoke_transform(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@transform", v, pos) >>
-    [&args, &pos] { return ready_args<glm::vec3, glm::vec3, glm::vec3>(args, "@transform", pos); } |
-    [](const std::tuple<glm::vec3, glm::vec3, glm::vec3> &tup) {
-      const auto &[pos, rot, scale] = tup;
-      return renderer::instanced_object::model_for(rot, scale, pos);
-    },
+inline std::monostate builtin_enable_highlight_star(
+  map_state &state, const loc &, const renderer::shader_ref &sh, const std::string &uniform_tex,
+  const std::string &uniform_toggle, const std::string &uniform_highlight_id
+) {
+  state.requires_instanced_highlight[sh] = {sh->loc_for(uniform_tex), sh->loc_for(uniform_toggle), sh->loc_for(uniform_highlight_id)};
+  return {};
+}
 
-    pos, glm::mat4(1.0f)
-  );
+/**
+ * @brief The builtin `highlight_bind` function: sets the texture slot to which the highlighting FBO texture is bound.
+ * @param state The map state.
+ * @param idx The texture slot.
+ */
+inline std::monostate builtin_highlight_bind(map_state &state, const loc &, const int &idx) {
+  state.highlight_binding = idx;
+  return {};
 }
 
 /**
- * @brief Invokes the builtin `spawn` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
- * @param pos The position of the call.
- * @return Either a reference to the spawned object, or an invalid reference.
- *
- * The `spawn` builtin creates a new renderable object from the provided object, shader, and textures list.
- * This function expects a `string` (name), an `object` reference, a `shader` reference, and a vector of
- * `(int, texture)` pairs (indicating which textures are to be bound to which uniforms in the shader).
- */
-inline value invoke_spawn(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@spawn", cache, pos) >>
-    // check arguments
-    [&args, &pos] { return ready_args<std::string, renderer::object_ref, renderer::shader_ref, std::vector<value>>(args, "@spawn", pos); } >>
-    [&cache](const auto &a) -> or_error<renderer::render_ref> {
-      // check textures
-      const auto &[name, obj, sh, textures] = a;
-
-      return type_check_pair_vector(textures, [](const value_pair &vp) {
-        return type_check_multi<int, renderer::texture_ref>({vp.first(), vp.second()}) |
-          [](const std::pair<int, renderer::texture_ref> &p) { return std::pair{static_cast<unsigned int>(p.first), p.second}; };
-      }) |
-      // insert into render cache
-      [&name, &obj, &sh](const std::vector<std::pair<unsigned int, renderer::texture_ref>> &tex) {
-        return renderer::render_cache::construct<renderer::renderable>(name, obj, sh, renderer::uniforms::from_shader(sh), tex);
-      } |
-      // insert into spawn cache
-      [&cache](const renderer::render_ref &rr) { cache.spawned.insert(rr); return rr; };
-    },
-
-    pos, renderer::render_ref::invalid()
-  );
-}
-
-/**
- * @brief Invokes the builtin `spawn*` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
- * @param pos The position of the call.
- * @return Either a reference to the spawned instanced object, or an invalid reference.
- *
- * The `spawn*` builtin creates a new instanced renderable object from the provided instanced object, shader, and
- * textures list.
- * This function expects a `string` (name), an `object*` reference, a `shader` reference, and a vector of
- * `(int, texture)` pairs (indicating which textures are to be bound to which uniforms in the shader).
- */
-inline value invoke_spawn_star(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle(
-  requires_scope<map_visitor::scope::OBJECTS>("@spawn*", cache, pos) >>
-    // check arguments
-    [&args, &pos] { return ready_args<std::string, renderer::instanced_object_ref, renderer::shader_ref, std::vector<value>>(args, "@spawn*", pos); } >>
-    [](const auto &a) -> or_error<renderer::instanced_render_ref> {
-      // check textures
-      const auto &[asset, obj, sh, textures] = a;
-      return type_check_pair_vector(textures, [](const value_pair &vp) {
-        return type_check_multi<int, renderer::texture_ref>({vp.first(), vp.second()}) |
-          [](const std::pair<int, renderer::texture_ref> &p) { return std::pair{static_cast<unsigned int>(p.first), p.second}; };
-      }) |
-      // insert into render cache
-      [&asset, &obj, &sh](const std::vector<std::pair<unsigned int, renderer::texture_ref>> &tex) {
-        return renderer::render_cache::construct<renderer::instanced_renderable>(asset, obj, sh, renderer::instanced_uniforms::from_shader(sh), tex);
-      };
-    } |
-    // insert into spawn cache
-    [&cache](const renderer::instanced_render_ref &rr) { cache.spawned_instances.insert(rr); return rr; },
-
-    pos, renderer::instanced_render_ref::invalid()
-  );
-}
-
-/**
- * @brief Invokes the builtin `transform_obj` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
- *
- * The `transform_obj` builtin sets the position, rotation, and scale of the provided renderable object.
- * This function expects a `renderable` reference, and three `vec3` arguments (position, rotation, and scale).
+ * @brief The builtin `add_collider` function: sets the collider for a renderable object.
+ * @param rr The renderable.
+ * @param coll The collider.
  */
-inline value invoke_transform_obj(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@transform_obj", v, pos) >>
-    [&args, &pos] { return ready_args<renderer::render_ref, glm::vec3, glm::vec3, glm::vec3>(args, "@transform_obj", pos); } |
-    []<typename ... Ts>(const std::tuple<Ts...> &tup) {
-      const auto &[rr, p, r, s] = tup;
-      rr->position = p; rr->rotation = r; rr->scale = s;
-      return std::monostate{};
-    },
+inline std::monostate builtin_add_collider(map_state &, const loc &, const renderer::render_ref &rr, const renderer::collider_ref &coll) {
+  rr->coll = coll;
+  return {};
+}
 
-    pos
-  );
+/**
+ * @brief The builtin `add_collider*` function: sets the collider for an instanced renderable object.
+ * @param rr The instanced renderable.
+ * @param coll The instanced collider.
+ */
+inline std::monostate builtin_add_collider_star(
+  map_state &, const loc &, const renderer::instanced_render_ref &rr, const renderer::instanced_collider_ref &coll
+) {
+  rr->coll = coll;
+  return {};
 }
 
 /**
- * @brief Invokes the builtin `enable_highlight` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
- *
- * The `enable_highlight` builtin sets the uniforms in the provided shader for highlighting.
- * This function expects a `shader` reference, and two `string` arguments (the uniform names).
- * The first of the uniforms is used to bind the highlighting FBO texture, and the second is used to determine if this
- * object is the main object to be highlighted.
+ * @brief The builtin `axes` function: toggles the display of the axes in the map (at the origin).
+ * @param state The map state.
+ * @param draw Whether to draw the axes.
  */
-inline value invoke_enable_highlight(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@enable_highlight", cache, pos) >>
-    [&args, &pos] { return ready_args<renderer::shader_ref, std::string, std::string>(args, "@enable_highlight", pos); } |
-    [&cache]<typename ... Ts>(const std::tuple<Ts...> &tup) {
-      const auto &[sh, uniform_tex, uniform_toggle] = tup;
-      cache.requires_highlight[sh] = {sh->loc_for(uniform_tex), sh->loc_for(uniform_toggle)};
-      return std::monostate{};
-    },
+inline std::monostate builtin_axes(map_state &state, const loc &, const bool &draw) {
+  state.show_axes = draw;
+  return {};
+}
 
-    pos
-  );
+/**
+ * @brief The builtin `region` function: declares a streamed region, whose contents are only loaded near the camera.
+ * @param state The map state.
+ * @param asset The map file with the contents of the region.
+ * @param center The center of the region.
+ * @param radius The distance from the center within which the region is loaded.
+ */
+inline std::monostate builtin_region(map_state &state, const loc &, const std::string &asset, const glm::vec3 &center, const float &radius) {
+  state.regions.push_back({asset, center, radius});
+  return {};
 }
 
 /**
- * @brief Invokes the builtin `enable_highlight*` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
+ * @brief The builtin `print` function: logs all values passed to it as a single informational message.
  * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
- *
- * The `enable_highlight*` builtin sets the uniforms in the provided shader for instanced highlighting.
- * This function expects a `shader` reference, and three `string` arguments (the uniform names).
- * The first of the uniforms is used to bind the highlighting FBO texture, the second is used to determine if this
- * object is the main object to be highlighted, and the third is used to determine the highlighted instance ID.
+ * @param args The values to log (any amount, of any type).
  */
-inline value invoke_enable_highlight_star(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@enable_highlight*", cache, pos) >>
-    [&args, &pos] { return ready_args<renderer::shader_ref, std::string, std::string, std::string>(args, "@enable_highlight*", pos); } |
-    [&cache]<typename ... Ts>(const std::tuple<Ts...> &tup) {
-      const auto &[sh, uniform_tex, uniform_toggle, uniform_highlight_id] = tup;
-      cache.requires_instanced_highlight[sh] = {sh->loc_for(uniform_tex), sh->loc_for(uniform_toggle), sh->loc_for(uniform_highlight_id)};
-      return std::monostate{};
-    },
-
-    pos
-  );
+inline std::monostate builtin_print(map_state &, const loc &pos, const std::span<const value> args) {
+  if (args.empty()) return {};
+  std::stringstream strm;
+  strm << static_cast<std::string>(args[0]);
+  for (size_t i = 1; i < args.size(); i++) strm << ' ' << static_cast<std::string>(args[i]);
+  renderer::log<renderer::log_type::INFO>("@print", "({}) {}", pos.str(), strm.str());
+  return {};
 }
 
 /**
- * @brief Invokes the builtin `highlight_bind` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
+ * @brief Type trait describing the signature of a typed builtin function.
+ * @tparam F The function pointer type, `R (*)(map_state &, const loc &, Ts...)`.
  *
- * The `highlight_bind` builtin sets the texture slot to which the highlighting FBO texture is bound.
- * This function expects a single `int` argument.
+ * A builtin taking a single `std::span<const value>` is variadic: it receives all arguments, without any checks.
  */
-inline value invoke_highlight_bind(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@object", cache, pos) >>
-    [&args, &pos] { return ready_arg<int>(args, "@highlight_bind", pos); } |
-    [&cache](const int idx) {
-      cache.highlight_binding = idx;
-      return std::monostate{};
-    },
-
-    pos
-  );
-}
+template <typename F> struct builtin_signature;
+template <typename R, typename ... Ts>
+struct builtin_signature<R (*)(map_state &, const loc &, Ts...)> {
+  using result_t = R; //!< The result type.
+  using params_t = std::tuple<std::remove_cvref_t<Ts>...>; //!< The (decayed) parameter types.
+  constexpr static bool variadic = std::same_as<params_t, std::tuple<std::span<const value>>>; //!< Whether the function is variadic.
+};
 
 /**
- * @brief Invokes the builtin `add_collider` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
+ * @brief An argument bound to a typed parameter.
+ * @tparam T The parameter type.
  *
- * The `add_collider` builtin sets the collider for the provided renderable object.
- * This function expects a `renderable` reference, and a `collider` reference.
+ * If the argument already has the right type, the parameter refers to it directly. Otherwise, the converted argument
+ * (e.g. an `int` passed as a `float`, or a list passed as a packed list) is stored in the binding.
  */
-inline value invoke_add_collider(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@add_collider", v, pos) >>
-    [&args, &pos] { return ready_args<renderer::render_ref, renderer::collider_ref>(args, "@add_collider", pos); } |
-    []<typename ... Ts>(const std::tuple<Ts...> &tup) {
-      const auto &[rr, coll] = tup;
-      rr->coll = coll;
-      return std::monostate{};
-    },
+template <valid_value T>
+struct bound_arg {
+  const T *ptr = nullptr; //!< The argument, if it has the right type.
+  std::optional<T> converted = std::nullopt; //!< The converted argument, otherwise.
+
+  /**
+   * @brief Gets the bound argument.
+   * @return A reference to the argument.
+   */
+  [[nodiscard]] const T &get() const { return ptr != nullptr ? *ptr : *converted; }
+};
 
-    pos
-  );
+/**
+ * @brief Binds an argument to a typed parameter.
+ * @tparam T The parameter type.
+ * @param v The argument.
+ * @param out The binding.
+ * @return An error message if the argument can't be converted to the parameter type, `std::nullopt` otherwise.
+ */
+template <valid_value T>
+std::optional<std::string> bind_arg(const value &v, bound_arg<T> &out) {
+  if (v.is<T>()) {
+    out.ptr = &v.as<T>();
+    return std::nullopt;
+  }
+
+  auto checked = type_check<T>(v);
+  if (checked.is_left()) return std::move(checked.left());
+  out.converted = std::move(checked.right());
+  return std::nullopt;
 }
 
 /**
- * @brief Invokes the builtin `add_collider*` function.
- * @param args The arguments from the parser.
- * @param v The map visitor.
+ * @brief A fixed-size string, usable as template argument (for the names of builtins).
+ * @tparam N The size of the string (including the terminator).
+ */
+template <size_t N>
+struct builtin_name {
+  char str[N]{}; //!< The characters.
+
+  /**
+   * @brief Creates a name from a string literal.
+   * @param s The string literal.
+   */
+  constexpr builtin_name(const char (&s)[N]) { std::copy_n(s, N, str); } // NOLINT(*-explicit-constructor)
+
+  /**
+   * @brief Gets the name.
+   * @return A view of the name (without terminator).
+   */
+  [[nodiscard]] constexpr std::string_view view() const { return {str, N - 1}; }
+};
+
+/**
+ * @brief Invokes a typed builtin function, checking its scope, arity and argument types first.
+ * @tparam Name The name of the builtin.
+ * @tparam Scope The scope the builtin requires (`scope::NONE` if it can be called anywhere).
+ * @tparam F The typed builtin function.
+ * @param args The arguments.
+ * @param state The map state.
  * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
+ * @return The result of the builtin, or the default value of its result type if the checks failed.
  *
- * The `add_collider*` builtin sets the collider for the provided instanced renderable object.
- * This function expects a `instanced_renderable` reference, and a `instanced_collider` reference.
+ * Arguments with the right type are passed by reference; only arguments that need a conversion are copied. If any of
+ * the checks fail, a warning is logged instead of calling the builtin.
  */
-inline value invoke_add_collider_star(const std::vector<value> &args, map_visitor &v, const loc &pos) {
-  return handle_no_value(
-  requires_scope<map_visitor::scope::OBJECTS>("@collider*", v, pos) >>
-    [&args, &pos] { return ready_args<renderer::instanced_render_ref, renderer::instanced_collider_ref>(args, "@add_collider*", pos); } |
-    []<typename ... Ts>(const std::tuple<Ts...> &tup) {
-      const auto &[rr, coll] = tup;
-      rr->coll = coll;
-      return std::monostate{};
-    },
+template <builtin_name Name, map_state::scope Scope, auto F>
+value invoke_typed(const std::span<const value> args, map_state &state, const loc &pos) {
+  using sig = builtin_signature<decltype(F)>;
+  using result_t = typename sig::result_t;
+  const auto fail = [&pos](const std::string &err) {
+    builtin_warning(err);
+    return value{default_value_v<result_t>, pos};
+  };
+
+  if constexpr (Scope != map_state::scope::NONE) {
+    if (state.current_scope != Scope)
+      return fail(std::format("Function {} requires {} (at {})", Name.view(), scope_name(Scope), pos.str()));
+  }
 
-    pos
-  );
+  if constexpr (sig::variadic) {
+    return value{F(state, pos, args), pos};
+  }
+  else {
+    using params_t = typename sig::params_t;
+    constexpr size_t n = std::tuple_size_v<params_t>;
+    if (args.size() != n)
+      return fail(std::format("Function {} expects {} arguments, but got {} at {}.", Name.view(), n, args.size(), pos.str()));
+
+    return [&]<size_t ... idxs>(std::index_sequence<idxs...>) {
+      std::tuple<bound_arg<std::tuple_element_t<idxs, params_t>>...> bound;
+      std::optional<std::string> err = std::nullopt;
+      // bind from left to right, stopping at the first mismatch
+      (void)(((err = bind_arg(args[idxs], std::get<idxs>(bound))), !err.has_value()) && ...);
+      if (err.has_value()) return fail(*err);
+      return value{F(state, pos, std::get<idxs>(bound).get()...), pos};
+    }(std::make_index_sequence<n>{});
+  }
 }
 
 /**
- * @brief Invokes the builtin `axes` function.
- * @param args The arguments from the parser.
- * @param cache The map visitor cache.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
- *
- * The `axes` builtin toggles the display of the axes in the map (at the origin).
- * This function expects a single `bool` argument.
+ * @brief Checks whether a typed builtin function accepts the given arguments (without reporting any errors).
+ * @tparam Scope The scope the builtin requires (`scope::NONE` if it can be called anywhere).
+ * @tparam F The typed builtin function.
+ * @param args The arguments.
+ * @param state The map state.
+ * @return `true` if invoking the builtin would pass all checks of `invoke_typed`.
  */
-inline value invoke_axes(const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  return handle_no_value(
-    requires_scope<map_visitor::scope::OBJECTS>("@axes", cache, pos) >>
-    [&args, &pos] { return ready_arg<bool>(args, "@axes", pos); } |
-    [&cache](const bool &draw) {
-      cache.show_axes = draw;
-      return std::monostate{};
-    }, pos
-  );
+template <map_state::scope Scope, auto F>
+bool accepts_typed(const std::span<const value> args, const map_state &state) {
+  using sig = builtin_signature<decltype(F)>;
+  if (Scope != map_state::scope::NONE && state.current_scope != Scope) return false;
+  if constexpr (sig::variadic) return true;
+  else {
+    using params_t = typename sig::params_t;
+    return args.size() == std::tuple_size_v<params_t> && [&]<size_t ... idxs>(std::index_sequence<idxs...>) {
+      return (type_check<std::tuple_element_t<idxs, params_t>>(args[idxs]).is_right() && ...);
+    }(std::make_index_sequence<std::tuple_size_v<params_t>>{});
+  }
 }
 
 /**
- * @brief Invokes the builtin `print` function.
- * @param args The arguments from the parser.
- * @param pos The position of the call.
- * @return A value wrapping `std::monostate`.
+ * @brief Structure describing a builtin function.
+ */
+struct builtin_desc {
+  std::string_view name; //!< The name of the builtin (including the `@`).
+  bool pure; //!< Whether the builtin only computes a value from its arguments (so calls can be constant-folded).
+  builtin_fn invoke; //!< The entry point, which checks the arguments before invoking the typed function.
+  bool (*accepts)(std::span<const value>, const map_state &); //!< Checks the arguments, without reporting errors.
+};
+
+/**
+ * @brief Declares a builtin function.
+ * @tparam Name The name of the builtin (including the `@`).
+ * @tparam Scope The scope the builtin requires (`scope::NONE` if it can be called anywhere).
+ * @tparam F The typed builtin function (see `builtin_signature`).
+ * @tparam Pure Whether the builtin is pure (see `builtin_desc::pure`).
+ * @return The description of the builtin.
+ */
+template <builtin_name Name, map_state::scope Scope, auto F, bool Pure = false>
+constexpr builtin_desc declare_builtin() {
+  return { Name.view(), Pure, &invoke_typed<Name, Scope, F>, &accepts_typed<Scope, F> };
+}
+
+/**
+ * @brief The table of all builtin functions.
  *
- * The `print` builtin logs all values passed to it as a single informational message.
+ * Calls in a compiled program are bound to an entry of this table once (see `bind_builtins`), so the interpreter never
+ * looks builtins up by name.
  */
-inline value invoke_print(const std::vector<value> &args, map_visitor &, const loc &pos) {
-  std::stringstream strm;
-  if (args.empty()) return value{std::monostate{}, pos};
-  strm << static_cast<std::string>(args[0]);
-  for (size_t i = 1; i < args.size(); i++) strm << ' ' << static_cast<std::string>(args[i]);
-  renderer::log<renderer::log_type::INFO>("@print", "({}) {}", pos.str(), strm.str());
-  return value{std::monostate{}, pos};
+inline constexpr builtin_desc builtins[] = {
+  declare_builtin<"@object", map_state::scope::OBJECTS, builtin_object>(),
+  declare_builtin<"@object*", map_state::scope::OBJECTS, builtin_object_star>(),
+  declare_builtin<"@shader", map_state::scope::OBJECTS, builtin_shader>(),
+  declare_builtin<"@texture", map_state::scope::OBJECTS, builtin_texture>(),
+  declare_builtin<"@collider", map_state::scope::OBJECTS, builtin_collider>(),
+  declare_builtin<"@collider*", map_state::scope::OBJECTS, builtin_collider_star>(),
+  declare_builtin<"@transform", map_state::scope::OBJECTS, builtin_transform, true>(),
+  declare_builtin<"@spawn", map_state::scope::OBJECTS, builtin_spawn>(),
+  declare_builtin<"@spawn*", map_state::scope::OBJECTS, builtin_spawn_star>(),
+  declare_builtin<"@transform_obj", map_state::scope::OBJECTS, builtin_transform_obj>(),
+  declare_builtin<"@enable_highlight", map_state::scope::OBJECTS, builtin_enable_highlight>(),
+  declare_builtin<"@enable_highlight*", map_state::scope::OBJECTS, builtin_enable_highlight_star>(),
+  declare_builtin<"@highlight_bind", map_state::scope::OBJECTS, builtin_highlight_bind>(),
+  declare_builtin<"@add_collider", map_state::scope::OBJECTS, builtin_add_collider>(),
+  declare_builtin<"@add_collider*", map_state::scope::OBJECTS, builtin_add_collider_star>(),
+  declare_builtin<"@print", map_state::scope::NONE, builtin_print>(),
+  declare_builtin<"@axes", map_state::scope::OBJECTS, builtin_axes>(),
+  declare_builtin<"@region", map_state::scope::OBJECTS, builtin_region>(),
+};
+
+/**
+ * @brief Looks up a builtin function by name.
+ * @param name The name of the builtin.
+ * @return The description of the builtin, or `nullptr` if it doesn't exist.
+ */
+inline const builtin_desc *find_builtin(const std::string_view name) {
+  const auto it = std::ranges::find(builtins, name, &builtin_desc::name);
+  return it == std::ranges::end(builtins) ? nullptr : &*it;
 }
 
 /**
- * @brief The type of builtin functions: (const std::vector<value> &, map_visitor &, const loc &) -> value.
+ * @brief Checks whether a builtin call can be evaluated ahead of time (during constant folding).
+ * @param name The function to be invoked.
+ * @param args The (constant) arguments to the function.
+ * @param cache The map state at the call.
+ * @return `true` if the builtin is pure, and invoking it with these arguments can't report an error.
+ *
+ * Pure builtins only compute a value from their arguments; they don't touch the map state (besides checking the scope)
+ * or the render cache.
  */
-using builtin_f = value (*)(const std::vector<value> &, map_visitor &, const loc &);
+inline bool can_fold_builtin(const std::string &name, const std::vector<value> &args, const map_state &cache) {
+  const auto *desc = find_builtin(name);
+  return desc != nullptr && desc->pure && desc->accepts(args, cache);
+}
 
 /**
  * @brief Invokes the required builtin function, if it exists.
  * @param name The function to be invoked.
  * @param args The arguments to the function.
- * @param cache The map visitor cache.
+ * @param cache The map state.
  * @param pos The position of the call.
  * @return The return value of the function, or `std::monostate` (void) if the function does not exist.
+ *
+ * This looks the builtin up by name on each call; compiled programs bind their calls up front instead.
  */
-inline value invoke_builtin(const std::string &name, const std::vector<value> &args, map_visitor &cache, const loc &pos) {
-  const static std::unordered_map<std::string, builtin_f> builtins {
-    {"@object", invoke_object}, {"@object*", invoke_object_star},
-    {"@shader", invoke_shader}, {"@texture", invoke_texture},
-    {"@collider", invoke_collider}, {"@collider*", invoke_collider_star},
-    {"@transform", invoke_transform},
-    {"@spawn", invoke_spawn}, {"@spawn*", invoke_spawn_star},
-    {"@transform_obj", invoke_transform_obj},
-    {"@enable_highlight", invoke_enable_highlight}, {"@enable_highlight*", invoke_enable_highlight_star},
-    {"@highlight_bind", invoke_highlight_bind},
-    {"@add_collider", invoke_add_collider}, {"@add_collider*", invoke_add_collider_star},
-    {"@print", invoke_print}, {"@axes", invoke_axes}
-  };
-
-  const auto it = builtins.find(name);
-  if (it == builtins.end()) {
+inline value invoke_builtin(const std::string &name, const std::vector<value> &args, map_state &cache, const loc &pos) {
+  const auto *desc = find_builtin(name);
+  if (desc == nullptr) {
     renderer::log<renderer::log_type::ERROR>("map_loader", std::format("Unknown builtin function {} at {}.", name, pos.str()));
     return value{std::monostate{}, pos};
   }
 
-  return it->second(args, cache, pos);
+  return desc->invoke(args, cache, pos);
 }
 }
 
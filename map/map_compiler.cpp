@@ -0,0 +1,240 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include "map_compiler.hpp"
+#include "map_state.hpp"
+#include "renderer/log_view.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+
+program map_compiler::compile(mapParser::ProgramContext *ctx, const std::string &file) {
+  map_compiler compiler;
+  compiler.file = file;
+  compiler.file_id = loc::intern(file);
+  compiler.visit(ctx);
+  return compiler.builder.finish();
+}
+
+void map_compiler::emit_value(antlr4::ParserRuleContext *c, const loc &at) {
+  if (c == nullptr) {
+    log<log_type::ERROR>("map_compiler", std::format("Unexpected null-node at {}", at.str()));
+    builder.emit(opcode::PUSH_NONE, at);
+    return;
+  }
+  visit(c);
+}
+
+void map_compiler::emit_discarded(mapParser::ExprContext *c, const loc &at) {
+  if (c == nullptr) {
+    log<log_type::ERROR>("map_compiler", std::format("Unexpected null-node at {}", at.str()));
+    return;
+  }
+
+  if (dynamic_cast<mapParser::IdExprContext *>(c) != nullptr) return; // a bare identifier has no effect
+  if (const auto *paren = dynamic_cast<mapParser::ParenExprContext *>(c); paren != nullptr) {
+    emit_discarded(paren->e, this->at(*c));
+    return;
+  }
+  if (const auto *assign = dynamic_cast<mapParser::AssignExprContext *>(c); assign != nullptr) {
+    emit_value(assign->value, this->at(*c));
+    builder.emit(opcode::STORE_NAME, this->at(*c), builder.name(assign->x->getText()), 0);
+    return;
+  }
+
+  visit(c);
+  builder.emit(opcode::POP, this->at(*c));
+}
+
+uint32_t map_compiler::emit_list(mapParser::ExprListContext *c, const loc &at) {
+  if (c == nullptr) {
+    log<log_type::ERROR>("map_compiler", std::format("Unexpected null-node at {}", at.str()));
+    return 0;
+  }
+
+  for (const auto expr : c->exprs) emit_value(expr, this->at(*c));
+  return static_cast<uint32_t>(c->exprs.size());
+}
+
+void map_compiler::emit_binary(antlr4::ParserRuleContext *left, antlr4::ParserRuleContext *right,
+  const antlr4::Token *op, const loc &at, const std::initializer_list<std::pair<std::string_view, opcode>> ops) {
+  emit_value(left, at);
+  emit_value(right, at);
+
+  const auto text = op == nullptr ? std::string{} : op->getText();
+  for (const auto &[sym, code] : ops) {
+    if (sym == text) {
+      builder.emit(code, at);
+      return;
+    }
+  }
+
+  log<log_type::ERROR>("map_compiler", "Invalid operator '{}' at {}", text, at.str());
+  builder.emit(opcode::POP, at);
+  builder.emit(opcode::POP, at);
+  builder.emit(opcode::PUSH_NONE, at);
+}
+
+uint32_t map_compiler::emit_loop_begin(antlr4::ParserRuleContext *from, antlr4::ParserRuleContext *to, const loc &at) {
+  emit_value(from, at);
+  emit_value(to, at);
+  const auto begin = builder.emit(opcode::LOOP_BEGIN, at);
+  builder.emit(opcode::LOOP_INDEX, at);
+  return begin;
+}
+
+void map_compiler::emit_loop_end(const uint32_t begin, const loc &at) {
+  builder.emit(opcode::LOOP_END, at, begin + 1);
+  builder.emitted(begin).arg = builder.next();
+}
+
+std::any map_compiler::visitProgram(mapParser::ProgramContext *context) {
+  emit_value(context->objects, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitObjectsSpec(mapParser::ObjectsSpecContext *context) {
+  builder.emit(opcode::BEGIN_SCOPE, at(*context), static_cast<uint32_t>(map_state::scope::OBJECTS));
+  for (const auto stmt : context->body) {
+    emit_value(stmt, at(*context));
+  }
+  builder.emit(opcode::END_SCOPE, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitExprList(mapParser::ExprListContext *context) {
+  emit_list(context, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitIdExpr(mapParser::IdExprContext *context) {
+  builder.emit(opcode::LOAD_NAME, at(*context), builder.name(context->x->getText()));
+  return {};
+}
+
+std::any map_compiler::visitTrueExpr(mapParser::TrueExprContext *context) {
+  builder.emit(opcode::PUSH_CONST, at(*context), builder.constant(value{true, at(*context)}));
+  return {};
+}
+
+std::any map_compiler::visitFalseExpr(mapParser::FalseExprContext *context) {
+  builder.emit(opcode::PUSH_CONST, at(*context), builder.constant(value{false, at(*context)}));
+  return {};
+}
+
+std::any map_compiler::visitIntExpr(mapParser::IntExprContext *context) {
+  builder.emit(opcode::PUSH_CONST, at(*context), builder.constant(value{std::stoi(context->x->getText()), at(*context)}));
+  return {};
+}
+
+std::any map_compiler::visitFloatExpr(mapParser::FloatExprContext *context) {
+  builder.emit(opcode::PUSH_CONST, at(*context), builder.constant(value{std::stof(context->x->getText()), at(*context)}));
+  return {};
+}
+
+std::any map_compiler::visitStringExpr(mapParser::StringExprContext *context) {
+  const std::string x = context->x->getText();
+  builder.emit(opcode::PUSH_CONST, at(*context), builder.constant(value{x.substr(1, x.size() - 2), at(*context)}));
+  return {};
+}
+
+std::any map_compiler::visitTupleExpr(mapParser::TupleExprContext *context) {
+  emit_value(context->x, at(*context));
+  emit_value(context->y, at(*context));
+  builder.emit(opcode::MAKE_PAIR, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitVec3Expr(mapParser::Vec3ExprContext *context) {
+  emit_value(context->x, at(*context));
+  emit_value(context->y, at(*context));
+  emit_value(context->z, at(*context));
+  builder.emit(opcode::MAKE_VEC3, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitEmptyListExpr(mapParser::EmptyListExprContext *context) {
+  builder.emit(opcode::MAKE_LIST, at(*context), 0);
+  return {};
+}
+
+std::any map_compiler::visitListExpr(mapParser::ListExprContext *context) {
+  const auto count = emit_list(context->exprs, at(*context));
+  builder.emit(opcode::MAKE_LIST, at(*context), count);
+  return {};
+}
+
+std::any map_compiler::visitRangeExpr(mapParser::RangeExprContext *context) {
+  // the loop index is the element
+  const auto begin = emit_loop_begin(context->from, context->to, at(*context));
+  emit_loop_end(begin, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitComprehensionExpr(mapParser::ComprehensionExprContext *context) {
+  // the comprehension gets its own context, so its loop variable shadows (and doesn't outlive) outer variables
+  builder.emit(opcode::PUSH_CONTEXT, at(*context));
+  const auto begin = emit_loop_begin(context->from, context->to, at(*context));
+  builder.emit(opcode::DECLARE_NAME, at(*context), builder.name(context->var->getText()));
+  emit_value(context->elem, at(*context));
+  emit_loop_end(begin, at(*context));
+  builder.emit(opcode::POP_CONTEXT, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitParenExpr(mapParser::ParenExprContext *context) {
+  emit_value(context->e, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitPowExpr(mapParser::PowExprContext *context) {
+  emit_value(context->left, at(*context));
+  emit_value(context->right, at(*context));
+  builder.emit(opcode::POW, at(*context));
+  return {};
+}
+
+std::any map_compiler::visitMulDivModExpr(mapParser::MulDivModExprContext *context) {
+  emit_binary(context->left, context->right, context->op, at(*context), {
+    {"*", opcode::MUL}, {"/", opcode::DIV}, {"%", opcode::MOD}
+  });
+  return {};
+}
+
+std::any map_compiler::visitAddSubExpr(mapParser::AddSubExprContext *context) {
+  emit_binary(context->left, context->right, context->op, at(*context), {
+    {"+", opcode::ADD}, {"-", opcode::SUB}
+  });
+  return {};
+}
+
+std::any map_compiler::visitCompExpr(mapParser::CompExprContext *context) {
+  emit_binary(context->left, context->right, context->op, at(*context), {
+    {"==", opcode::EQ}, {"!=", opcode::NE}, {"<", opcode::LT}, {">", opcode::GT}, {"<=", opcode::LE}, {">=", opcode::GE}
+  });
+  return {};
+}
+
+std::any map_compiler::visitAssignExpr(mapParser::AssignExprContext *context) {
+  emit_value(context->value, at(*context));
+  builder.emit(opcode::STORE_NAME, at(*context), builder.name(context->x->getText()), 1);
+  return {};
+}
+
+std::any map_compiler::visitFuncExpr(mapParser::FuncExprContext *context) {
+  if (context->args == nullptr) {
+    log<log_type::ERROR>("map_compiler", std::format("Expected a list of values at {}", at(*context).str()));
+    builder.emit(opcode::PUSH_NONE, at(*context));
+    return {};
+  }
+
+  const auto argc = emit_list(context->args, at(*context));
+  builder.emit(opcode::CALL, at(*context), builder.name(context->x->getText()), argc);
+  return {};
+}
+
+std::any map_compiler::visitExprStmt(mapParser::ExprStmtContext *context) {
+  emit_discarded(context->e, at(*context));
+  return {};
+}
@@ -0,0 +1,152 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_COMPILER_HPP
+#define MAP_COMPILER_HPP
+
+#include <mapVisitor.h>
+
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief A structure to lower the parser's AST into a `program`.
+ *
+ * The compiler walks the AST exactly once, emitting bytecode in evaluation order. All visitor methods return an empty
+ * `std::any`; the generated code is accumulated in the builder. Operators are resolved to opcodes here, so the
+ * interpreter never has to look at operator text.
+ */
+struct map_compiler final : mapVisitor {
+  std::string file; //!< The file being compiled.
+  uint32_t file_id = 0; //!< The interned ID of `file`.
+  program_builder builder{}; //!< The builder holding the generated code.
+
+  /**
+   * @brief Compiles a parsed map into a program.
+   * @param ctx The root of the AST.
+   * @param file The file the AST was parsed from.
+   * @return The compiled program.
+   */
+  static program compile(mapParser::ProgramContext *ctx, const std::string &file);
+
+  /**
+   * @brief Creates a location from an ANTLR parser context.
+   * @param ctx The ANTLR parser context.
+   * @return The location of the context.
+   */
+  loc at(const antlr4::ParserRuleContext &ctx) const {
+    return {ctx, file_id};
+  }
+
+  /**
+   * @brief Emits code for an expression that produces a stack entry.
+   * @param c The expression (possibly null).
+   * @param at The location of the parent node.
+   *
+   * If the expression is null, an error is logged and a "no value" entry is emitted instead.
+   */
+  void emit_value(antlr4::ParserRuleContext *c, const loc &at);
+
+  /**
+   * @brief Emits code for an expression whose result is discarded.
+   * @param c The expression (possibly null).
+   * @param at The location of the parent node.
+   *
+   * Bare identifiers (possibly parenthesized) emit nothing, and assignments don't reload the variable they assign to.
+   * All other expressions are evaluated and their result is popped.
+   */
+  void emit_discarded(mapParser::ExprContext *c, const loc &at);
+
+  /**
+   * @brief Emits code for a list of expressions.
+   * @param c The expression list (possibly null).
+   * @param at The location of the parent node.
+   * @return The number of stack entries pushed.
+   */
+  uint32_t emit_list(mapParser::ExprListContext *c, const loc &at);
+
+  /**
+   * @brief Emits code for a binary operator.
+   * @param left The left operand.
+   * @param right The right operand.
+   * @param op The operator token.
+   * @param at The location of the operator expression.
+   * @param ops The mapping of operator text to opcodes.
+   */
+  void emit_binary(antlr4::ParserRuleContext *left, antlr4::ParserRuleContext *right, const antlr4::Token *op,
+    const loc &at, std::initializer_list<std::pair<std::string_view, opcode>> ops);
+
+  /**
+   * @brief Emits the start of a loop over a range (see `opcode::LOOP_BEGIN`).
+   * @param from The start of the range (inclusive).
+   * @param to The end of the range (exclusive).
+   * @param at The location of the loop.
+   * @return The index of the `LOOP_BEGIN` instruction (to be passed to `emit_loop_end`).
+   *
+   * Each iteration starts with the loop index on the stack. The code for the loop body, emitted after this, should
+   * replace it by exactly one value (the element).
+   */
+  uint32_t emit_loop_begin(antlr4::ParserRuleContext *from, antlr4::ParserRuleContext *to, const loc &at);
+
+  /**
+   * @brief Emits the end of a loop, and fills in the loop's jump targets.
+   * @param begin The index of the `LOOP_BEGIN` instruction (as returned by `emit_loop_begin`).
+   * @param at The location of the loop.
+   */
+  void emit_loop_end(uint32_t begin, const loc &at);
+
+  std::any visitProgram(mapParser::ProgramContext *context) override; //!< Visitor for the `program` rule.
+
+  std::any visitObjectsSpec(mapParser::ObjectsSpecContext *context) override; //!< Visitor for the `objectsSpec` rule.
+
+  std::any visitExprList(mapParser::ExprListContext *context) override; //!< Visitor for the `exprList` rule.
+
+  std::any visitIdExpr(mapParser::IdExprContext *context) override; //!< Visitor for the `idExpr` alternative.
+
+  std::any visitTrueExpr(mapParser::TrueExprContext *context) override; //!< Visitor for the `trueExpr` alternative.
+
+  std::any visitFalseExpr(mapParser::FalseExprContext *context) override; //!< Visitor for the `falseExpr` alternative.
+
+  std::any visitIntExpr(mapParser::IntExprContext *context) override; //!< Visitor for the `intExpr` alternative.
+
+  std::any visitFloatExpr(mapParser::FloatExprContext *context) override; //!< Visitor for the `floatExpr` alternative.
+
+  std::any visitStringExpr(mapParser::StringExprContext *context) override; //!< Visitor for the `stringExpr` alternative.
+
+  std::any visitTupleExpr(mapParser::TupleExprContext *context) override; //!< Visitor for the `tupleExpr` alternative.
+
+  std::any visitVec3Expr(mapParser::Vec3ExprContext *context) override; //!< Visitor for the `vec3Expr` alternative.
+
+  std::any visitEmptyListExpr(mapParser::EmptyListExprContext *context) override; //!< Visitor for the `emptyListExpr` alternative.
+
+  std::any visitListExpr(mapParser::ListExprContext *context) override; //!< Visitor for the `listExpr` alternative.
+
+  std::any visitRangeExpr(mapParser::RangeExprContext *context) override; //!< Visitor for the `rangeExpr` alternative.
+
+  std::any visitComprehensionExpr(mapParser::ComprehensionExprContext *context) override; //!< Visitor for the `comprehensionExpr` alternative.
+
+  std::any visitParenExpr(mapParser::ParenExprContext *context) override; //!< Visitor for the `parenExpr` alternative.
+
+  std::any visitPowExpr(mapParser::PowExprContext *context) override; //!< Visitor for the `powExpr` alternative.
+
+  std::any visitMulDivModExpr(mapParser::MulDivModExprContext *context) override; //!< Visitor for the `mulDivModExpr` alternative.
+
+  std::any visitAddSubExpr(mapParser::AddSubExprContext *context) override; //!< Visitor for the `addSubExpr` alternative.
+
+  std::any visitCompExpr(mapParser::CompExprContext *context) override; //!< Visitor for the `compExpr` alternative.
+
+  std::any visitAssignExpr(mapParser::AssignExprContext *context) override; //!< Visitor for the `assignExpr` alternative.
+
+  std::any visitFuncExpr(mapParser::FuncExprContext *context) override; //!< Visitor for the `funcExpr` alternative.
+
+  std::any visitExprStmt(mapParser::ExprStmtContext *context) override; //!< Visitor for the `exprStmt` alternative.
+
+  /**
+   * @brief Cleans up the map compiler.
+   */
+  ~map_compiler() override = default;
+};
+}
+
+#endif //MAP_COMPILER_HPP
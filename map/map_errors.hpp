@@ -16,6 +16,7 @@ namespace openvtt::map {
  */
 struct lexer_error_listener final : antlr4::BaseErrorListener {
   std::string file;
+  size_t error_count = 0; //!< The amount of errors reported so far.
 
   explicit lexer_error_listener(std::string file) : file(std::move(file)) {}
 
@@ -23,6 +24,7 @@ struct lexer_error_listener final : antlr4::BaseErrorListener {
       antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol, const size_t line,
       const size_t charPositionInLine, const std::string &msg, std::exception_ptr e
   ) override {
+    error_count++;
     renderer::log<renderer::log_type::WARNING>("map_lexer",
       std::format("{}:{}:{}: {} (on token '{}')", file, line, charPositionInLine, msg, offendingSymbol->getText())
     );
@@ -36,6 +38,7 @@ struct lexer_error_listener final : antlr4::BaseErrorListener {
  */
 struct parser_error_listener final : antlr4::BaseErrorListener {
   std::string file;
+  size_t error_count = 0; //!< The amount of errors reported so far.
 
   explicit parser_error_listener(std::string file) : file(std::move(file)) {}
 
@@ -43,6 +46,7 @@ struct parser_error_listener final : antlr4::BaseErrorListener {
       antlr4::Recognizer *recognizer, antlr4::Token *offendingSymbol, const size_t line,
       const size_t charPositionInLine, const std::string &msg, std::exception_ptr e
   ) override {
+    error_count++;
     renderer::log<renderer::log_type::WARNING>("map_parser",
       std::format("{}:{}:{}: {} (on token '{}')", file, line, charPositionInLine, msg, offendingSymbol->getText())
     );
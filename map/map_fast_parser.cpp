@@ -0,0 +1,452 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <charconv>
+#include <vector>
+
+#include "map_fast_parser.hpp"
+#include "map_state.hpp"
+
+using namespace openvtt::map;
+
+namespace {
+/**
+ * @brief The token types of the map language (see `grammars/map.g4`).
+ */
+enum struct tok : uint8_t {
+  IDENTIFIER, FUNC_NAME, INT, FLOAT, STRING,
+  OBJECTS, TRUE, FALSE, FOR, IN,
+  LBRACE, RBRACE, LPAREN, RPAREN, LBRACKET, RBRACKET, SEMI, COMMA, RANGE, ASSIGN,
+  POW, MUL, DIV, MOD, ADD, SUB, EQ, NE, LT, GT, LE, GE,
+  ERROR, //!< Input that doesn't form a valid token.
+  END, //!< End of the input.
+};
+
+/**
+ * @brief Structure representing a token (a view into the source).
+ */
+struct token {
+  tok type;
+  uint32_t line; //!< The line of the first character (1-based).
+  uint32_t col; //!< The column of the first character (1-based, in code points, like ANTLR).
+  std::string_view text;
+};
+
+constexpr bool is_digit(const char c) { return c >= '0' && c <= '9'; }
+constexpr bool is_id_start(const char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+constexpr bool is_id_char(const char c) { return is_id_start(c) || is_digit(c); }
+
+/**
+ * @brief Splits the source into tokens, following the (longest match) rules of the ANTLR lexer.
+ *
+ * Keywords take precedence over identifiers of the same length, and a sign directly followed by a number is part of
+ * that number. Invalid input produces an `ERROR` token (so the parser only fails if it actually gets there). The last
+ * token is always `END`.
+ */
+std::vector<token> tokenize(const std::string_view src) {
+  std::vector<token> res;
+  res.reserve(src.size() / 4 + 1);
+
+  size_t i = 0;
+  uint32_t line = 1, col = 0;
+  const auto advance_to = [&](const size_t end) {
+    for (; i < end; i++) {
+      if (src[i] == '\n') { line++; col = 0; }
+      else if ((static_cast<unsigned char>(src[i]) & 0xC0) != 0x80) col++; // don't count UTF-8 continuation bytes
+    }
+  };
+  const auto at = [&src](const size_t idx) { return idx < src.size() ? src[idx] : '\0'; };
+  const auto digits_from = [&](size_t idx) { while (is_digit(at(idx))) idx++; return idx; };
+
+  while (true) {
+    // whitespace and comments
+    while (i < src.size()) {
+      if (const char c = src[i]; c == ' ' || c == '\t' || c == '\r' || c == '\n') advance_to(i + 1);
+      else if (c == '/' && at(i + 1) == '/') advance_to(src.find_first_of("\r\n", i) == std::string_view::npos ? src.size() : src.find_first_of("\r\n", i));
+      else break;
+    }
+    if (i >= src.size()) break;
+
+    const size_t start = i;
+    const char c = src[i];
+    const char n = at(i + 1);
+    tok type = tok::ERROR;
+    size_t end = i + 1;
+
+    const bool sign = c == '+' || c == '-';
+    const size_t num = sign ? i + 1 : i;
+    if (is_digit(at(num)) || (at(num) == '.' && is_digit(at(num + 1)))) {
+      // INT: [+-]?[0-9]+; FLOAT: [+-]?([0-9]*[.])?[0-9]+ (INT wins ties)
+      end = digits_from(num);
+      type = tok::INT;
+      if (at(end) == '.' && is_digit(at(end + 1))) {
+        end = digits_from(end + 1);
+        type = tok::FLOAT;
+      }
+    }
+    else if (is_id_start(c)) {
+      while (is_id_char(at(end))) end++;
+      const auto word = src.substr(start, end - start);
+      type = word == "objects" ? tok::OBJECTS : word == "true" ? tok::TRUE : word == "false" ? tok::FALSE :
+             word == "for" ? tok::FOR : word == "in" ? tok::IN : tok::IDENTIFIER;
+    }
+    else if (c == '@' && is_id_start(n)) {
+      end = i + 2;
+      while (is_id_char(at(end)) || at(end) == '*') end++;
+      type = tok::FUNC_NAME;
+    }
+    else if (c == '"') {
+      while (end < src.size() && src[end] != '"' && src[end] != '\r' && src[end] != '\n' && src[end] != '\\') end++;
+      if (at(end) == '"') {
+        end++;
+        type = tok::STRING;
+      }
+    }
+    else {
+      const auto two = [&](const char second, const tok both, const tok single) {
+        if (n == second) { end = i + 2; return both; }
+        return single;
+      };
+      switch (c) {
+        case '{': type = tok::LBRACE; break;
+        case '}': type = tok::RBRACE; break;
+        case '(': type = tok::LPAREN; break;
+        case ')': type = tok::RPAREN; break;
+        case '[': type = tok::LBRACKET; break;
+        case ']': type = tok::RBRACKET; break;
+        case ';': type = tok::SEMI; break;
+        case ',': type = tok::COMMA; break;
+        case '^': type = tok::POW; break;
+        case '*': type = tok::MUL; break;
+        case '/': type = tok::DIV; break;
+        case '%': type = tok::MOD; break;
+        case '+': type = tok::ADD; break;
+        case '-': type = tok::SUB; break;
+        case '.': type = two('.', tok::RANGE, tok::ERROR); break;
+        case '=': type = two('=', tok::EQ, tok::ASSIGN); break;
+        case '!': type = two('=', tok::NE, tok::ERROR); break;
+        case '<': type = two('=', tok::LE, tok::LT); break;
+        case '>': type = two('=', tok::GE, tok::GT); break;
+        default: break;
+      }
+    }
+
+    res.push_back({type, line, col + 1, src.substr(start, end - start)});
+    advance_to(end);
+  }
+
+  res.push_back({tok::END, line, col + 1, {}});
+  return res;
+}
+
+/**
+ * @brief Thrown (internally) when the parser encounters a syntax error.
+ */
+struct syntax_error {};
+
+/**
+ * @brief Summary of a parsed expression, as far as statements need it.
+ */
+struct expr_info {
+  loc start; //!< The location of the expression (its first token).
+  loc inner; //!< The location of the expression without any enclosing parentheses.
+  bool is_assign = false; //!< Whether the expression is an assignment (possibly parenthesized).
+};
+
+/**
+ * @brief The recursive-descent parser, emitting code in the same order as `map_compiler`.
+ */
+class parser {
+public:
+  parser(const std::string_view source, const uint32_t file_id) : tokens{tokenize(source)}, file_id{file_id} {
+    // match brackets up front, so the end of an expression can be found without parsing it
+    matching.assign(tokens.size(), no_match);
+    std::vector<size_t> open;
+    for (size_t t = 0; t < tokens.size(); t++) {
+      switch (tokens[t].type) {
+        case tok::LPAREN: case tok::LBRACKET: case tok::LBRACE: open.push_back(t); break;
+        case tok::RPAREN: case tok::RBRACKET: case tok::RBRACE:
+          if (open.empty()) break;
+          matching[open.back()] = t;
+          open.pop_back();
+          break;
+        default: break;
+      }
+    }
+  }
+
+  program run() {
+    const auto &objects = expect(tok::OBJECTS);
+    expect(tok::LBRACE);
+    builder.emit(opcode::BEGIN_SCOPE, at(objects), static_cast<uint32_t>(map_state::scope::OBJECTS));
+    while (peek().type != tok::RBRACE) statement();
+    next();
+    builder.emit(opcode::END_SCOPE, at(objects));
+    // like the grammar, ignore anything after the objects block
+    return builder.finish();
+  }
+
+private:
+  constexpr static size_t no_match = static_cast<size_t>(-1);
+
+  [[nodiscard]] const token &peek(const size_t ahead = 0) const {
+    return tokens[std::min(pos + ahead, tokens.size() - 1)];
+  }
+
+  const token &next() {
+    const auto &t = peek();
+    if (t.type == tok::END || t.type == tok::ERROR) throw syntax_error{};
+    pos++;
+    return t;
+  }
+
+  bool accept(const tok type) {
+    if (peek().type != type) return false;
+    pos++;
+    return true;
+  }
+
+  const token &expect(const tok type) {
+    if (peek().type != type) throw syntax_error{};
+    return next();
+  }
+
+  [[nodiscard]] loc at(const token &t) const { return {file_id, t.line, t.col}; }
+
+  /**
+   * @brief Finds the first token after the expression starting at `pos`, skipping bracketed groups.
+   */
+  [[nodiscard]] size_t expr_end() const {
+    size_t t = pos;
+    while (true) {
+      switch (tokens[t].type) {
+        case tok::COMMA: case tok::RANGE: case tok::FOR: case tok::SEMI: case tok::END: case tok::ERROR:
+        case tok::RPAREN: case tok::RBRACKET: case tok::RBRACE:
+          return t;
+        case tok::LPAREN: case tok::LBRACKET: case tok::LBRACE:
+          if (matching[t] == no_match) throw syntax_error{};
+          t = matching[t] + 1;
+          break;
+        default: t++; break;
+      }
+    }
+  }
+
+  void statement() {
+    // a bare (possibly parenthesized) identifier has no effect, so it emits nothing (its name isn't even interned)
+    size_t parens = 0;
+    while (peek(parens).type == tok::LPAREN) parens++;
+    if (peek(parens).type == tok::IDENTIFIER) {
+      size_t closing = 0;
+      while (closing < parens && peek(parens + 1 + closing).type == tok::RPAREN) closing++;
+      if (closing == parens && peek(2 * parens + 1).type == tok::SEMI) {
+        pos += 2 * parens + 2;
+        return;
+      }
+    }
+
+    const auto e = expr();
+    expect(tok::SEMI);
+    // an assignment as a statement doesn't reload its variable; any other result is discarded
+    if (e.is_assign) builder.emitted(builder.next() - 1).arg2 = 0;
+    else builder.emit(opcode::POP, e.inner);
+  }
+
+  /**
+   * @brief Gets the precedence and opcode of a binary operator (precedence 0 if the token isn't one).
+   */
+  static std::pair<int, opcode> binary(const tok type) {
+    switch (type) {
+      case tok::POW: return {6, opcode::POW};
+      case tok::MUL: return {5, opcode::MUL};
+      case tok::DIV: return {5, opcode::DIV};
+      case tok::MOD: return {5, opcode::MOD};
+      case tok::ADD: return {4, opcode::ADD};
+      case tok::SUB: return {4, opcode::SUB};
+      case tok::EQ: return {3, opcode::EQ};
+      case tok::NE: return {3, opcode::NE};
+      case tok::LT: return {3, opcode::LT};
+      case tok::GT: return {3, opcode::GT};
+      case tok::LE: return {3, opcode::LE};
+      case tok::GE: return {3, opcode::GE};
+      default: return {0, opcode::POP};
+    }
+  }
+
+  /**
+   * @brief Parses an expression (precedence climbing; all binary operators are left-associative, like in ANTLR).
+   * @param min_prec The lowest precedence of the operators this expression may contain.
+   */
+  expr_info expr(const int min_prec = 0) {
+    auto lhs = primary();
+    while (true) {
+      const auto [prec, op] = binary(peek().type);
+      if (prec == 0 || prec < min_prec) return lhs;
+      next();
+      expr(prec + 1);
+      builder.emit(op, lhs.start);
+      lhs = {lhs.start, lhs.start};
+    }
+  }
+
+  /**
+   * @brief Parses a comma-separated, non-empty list of expressions.
+   * @return The amount of expressions.
+   */
+  uint32_t expr_list() {
+    uint32_t count = 0;
+    do {
+      expr();
+      count++;
+    } while (accept(tok::COMMA));
+    return count;
+  }
+
+  expr_info primary() {
+    const auto &t = next();
+    const auto l = at(t);
+    const expr_info plain{l, l};
+
+    switch (t.type) {
+      case tok::IDENTIFIER:
+        if (accept(tok::ASSIGN)) {
+          expr(2); // binds looser than any binary operator
+          builder.emit(opcode::STORE_NAME, l, builder.name(std::string{t.text}), 1);
+          return {l, l, true};
+        }
+        builder.emit(opcode::LOAD_NAME, l, builder.name(std::string{t.text}));
+        return plain;
+
+      case tok::TRUE: case tok::FALSE:
+        builder.emit(opcode::PUSH_CONST, l, builder.constant(value{t.type == tok::TRUE, l}));
+        return plain;
+
+      case tok::INT: {
+        int x = 0;
+        const auto text = t.text.starts_with('+') ? t.text.substr(1) : t.text;
+        if (const auto [end, err] = std::from_chars(text.data(), text.data() + text.size(), x); err != std::errc{})
+          throw syntax_error{}; // out of range; let the ANTLR path deal with it
+        builder.emit(opcode::PUSH_CONST, l, builder.constant(value{x, l}));
+        return plain;
+      }
+
+      case tok::FLOAT: {
+        float x = 0.0f;
+        const auto text = t.text.starts_with('+') ? t.text.substr(1) : t.text;
+        if (const auto [end, err] = std::from_chars(text.data(), text.data() + text.size(), x); err != std::errc{})
+          throw syntax_error{};
+        builder.emit(opcode::PUSH_CONST, l, builder.constant(value{x, l}));
+        return plain;
+      }
+
+      case tok::STRING:
+        builder.emit(opcode::PUSH_CONST, l, builder.constant(value{std::string{t.text.substr(1, t.text.size() - 2)}, l}));
+        return plain;
+
+      case tok::LPAREN: {
+        const auto first = expr();
+        if (accept(tok::RPAREN)) return {l, first.inner, first.is_assign}; // parenthesized
+        expect(tok::COMMA);
+        expr();
+        if (accept(tok::RPAREN)) {
+          builder.emit(opcode::MAKE_PAIR, l);
+          return plain;
+        }
+        expect(tok::COMMA);
+        expr();
+        expect(tok::RPAREN);
+        builder.emit(opcode::MAKE_VEC3, l);
+        return plain;
+      }
+
+      case tok::LBRACKET:
+        bracketed(l);
+        return plain;
+
+      case tok::FUNC_NAME: {
+        expect(tok::LPAREN);
+        const auto argc = expr_list();
+        expect(tok::RPAREN);
+        builder.emit(opcode::CALL, l, builder.name(std::string{t.text}), argc);
+        return plain;
+      }
+
+      default: throw syntax_error{};
+    }
+  }
+
+  /**
+   * @brief Parses a list, range, or comprehension (after the opening bracket).
+   * @param l The location of the opening bracket.
+   */
+  void bracketed(const loc &l) {
+    if (accept(tok::RBRACKET)) {
+      builder.emit(opcode::MAKE_LIST, l, 0);
+      return;
+    }
+
+    const size_t first = pos;
+    const size_t first_end = expr_end();
+
+    if (tokens[first_end].type == tok::FOR) {
+      // the element comes first in the source, but is evaluated after the range (in the loop body)
+      pos = first_end + 1;
+      const auto &var = expect(tok::IDENTIFIER);
+      expect(tok::IN);
+      builder.emit(opcode::PUSH_CONTEXT, l); // see `map_compiler::visitComprehensionExpr`
+      expr();
+      expect(tok::RANGE);
+      expr();
+      expect(tok::RBRACKET);
+      const size_t after = pos;
+
+      const auto begin = builder.emit(opcode::LOOP_BEGIN, l);
+      builder.emit(opcode::LOOP_INDEX, l);
+      builder.emit(opcode::DECLARE_NAME, l, builder.name(std::string{var.text}));
+      pos = first;
+      expr();
+      if (pos != first_end) throw syntax_error{};
+      pos = after;
+      loop_end(begin, l);
+      builder.emit(opcode::POP_CONTEXT, l);
+      return;
+    }
+
+    if (tokens[first_end].type == tok::RANGE) {
+      expr();
+      expect(tok::RANGE);
+      expr();
+      expect(tok::RBRACKET);
+      const auto begin = builder.emit(opcode::LOOP_BEGIN, l);
+      builder.emit(opcode::LOOP_INDEX, l);
+      loop_end(begin, l);
+      return;
+    }
+
+    const auto count = expr_list();
+    expect(tok::RBRACKET);
+    builder.emit(opcode::MAKE_LIST, l, count);
+  }
+
+  void loop_end(const uint32_t begin, const loc &l) {
+    builder.emit(opcode::LOOP_END, l, begin + 1);
+    builder.emitted(begin).arg = builder.next();
+  }
+
+  std::vector<token> tokens;
+  std::vector<size_t> matching; //!< For each opening bracket, the index of its closing bracket.
+  size_t pos = 0;
+  uint32_t file_id;
+  program_builder builder{};
+};
+}
+
+std::optional<program> map_fast_parser::compile(const std::string_view source, const std::string &file) {
+  try {
+    return parser{source, loc::intern(file)}.run();
+  }
+  catch (const syntax_error &) {
+    return std::nullopt;
+  }
+}
@@ -0,0 +1,36 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_FAST_PARSER_HPP
+#define MAP_FAST_PARSER_HPP
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief A hand-written parser for map files, which compiles straight to a `program`.
+ *
+ * The parser accepts the same language as `grammars/map.g4`, and generates exactly the same program as parsing the
+ * file with ANTLR and lowering the AST with `map_compiler` (including the name, constant and location tables). It
+ * doesn't build a parse tree; tokens are views into the source buffer, so a memory-mapped file is never copied.
+ *
+ * The parser has no error recovery or reporting. On the first syntax error, it gives up, and the caller should fall
+ * back to the ANTLR parser (which reports the errors, and compiles whatever it can recover).
+ */
+struct map_fast_parser {
+  /**
+   * @brief Parses and compiles a map.
+   * @param source The source code.
+   * @param file The file the source code was read from (for locations).
+   * @return The compiled program, or `std::nullopt` if the source contains a syntax error.
+   */
+  static std::optional<program> compile(std::string_view source, const std::string &file);
+};
+}
+
+#endif //MAP_FAST_PARSER_HPP
@@ -0,0 +1,259 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include "map_interpreter.hpp"
+#include "map_builtins.hpp"
+#include "renderer/log_view.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+
+const std::string &map_interpreter::slot_name(const program &prog, const uint32_t depth, const uint32_t slot) const {
+  return prog.names[prog.frames[frame_stack[depth]].slot_names[slot]];
+}
+
+map_interpreter::entry map_interpreter::pop() {
+  entry e = std::move(stack.back());
+  stack.pop_back();
+  return e;
+}
+
+value map_interpreter::pop_value(const loc &at) {
+  if (auto e = pop(); e.has_value()) return std::move(*e);
+  log<log_type::ERROR>("map_interpreter", std::format("Expected value at {}", at.str()));
+  return value{};
+}
+
+float map_interpreter::pop_float(const loc &at) {
+  const auto v = pop_value(at);
+  if (v.is<float>()) return v.as<float>();
+  if (v.is<int>()) return static_cast<float>(v.as<int>());
+
+  log<log_type::ERROR>("map_interpreter",
+    std::format("Expected value of type float, but got value of type {} at {}", v.type_name(), at.str())
+  );
+  return default_value_v<float>;
+}
+
+int map_interpreter::pop_int(const loc &at) {
+  const auto v = pop_value(at);
+  if (v.is<int>()) return v.as<int>();
+
+  log<log_type::ERROR>("map_interpreter",
+    std::format("Expected value of type int, but got value of type {} at {}", v.type_name(), at.str())
+  );
+  return default_value_v<int>;
+}
+
+void map_interpreter::run(const program &prog) {
+  // moves the top `n` stack entries into a list of values, skipping (and reporting) missing values
+  const auto collect_into = [this](std::vector<value> &values, const uint32_t n, const loc &at) {
+    values.clear();
+    values.reserve(n);
+    const auto first = stack.end() - n;
+    for (auto it = first; it != stack.end(); ++it) {
+      if (it->has_value()) values.push_back(std::move(**it));
+      else log<log_type::ERROR>("map_interpreter", std::format("Expected a value at {}, but got nothing", at.str()));
+    }
+    stack.erase(first, stack.end());
+  };
+  const auto collect = [&collect_into](const uint32_t n, const loc &at) {
+    std::vector<value> values;
+    collect_into(values, n, at);
+    return values;
+  };
+  std::vector<value> call_args; // reused by all bound calls
+
+  for (size_t pc = 0; pc < prog.code.size();) {
+    const auto &[op, arg, arg2, at_idx] = prog.code[pc++];
+    const loc &at = prog.locs[at_idx];
+    switch (op) {
+      case opcode::PUSH_CONST:
+        stack.emplace_back(prog.constants[arg]);
+        break;
+
+      case opcode::PUSH_NONE:
+        stack.emplace_back(std::nullopt);
+        break;
+
+      case opcode::LOAD_NAME: case opcode::STORE_NAME: case opcode::DECLARE_NAME:
+        log<log_type::ERROR>("map_interpreter", std::format("Unresolved variable {} at {}", prog.names[arg], at.str()));
+        if (op != opcode::LOAD_NAME) stack.pop_back();
+        if (op == opcode::LOAD_NAME || (op == opcode::STORE_NAME && arg2 != 0)) stack.emplace_back(value{});
+        break;
+
+      case opcode::LOAD_SLOT:
+        if (const auto *v = context_stack[arg2].slot_maybe(arg); v != nullptr) stack.emplace_back(*v);
+        else {
+          log<log_type::ERROR>("object_cache", std::format("Variable {} does not exist at {}", slot_name(prog, arg2, arg), at.str()));
+          stack.emplace_back(value{});
+        }
+        break;
+
+      case opcode::STORE_SLOT: case opcode::STORE_SLOT_KEEP: {
+        const bool keep = op == opcode::STORE_SLOT_KEEP;
+        auto v = pop();
+        if (arg2 >= context_stack.size()) {
+          log<log_type::ERROR>("map_interpreter", std::format("Assignment outside of any scope at {}", at.str()));
+          if (keep) stack.emplace_back(std::nullopt);
+          break;
+        }
+        if (!v.has_value()) {
+          if (keep) stack.emplace_back(std::nullopt);
+          break;
+        }
+
+        auto &ctx = context_stack[arg2];
+        ctx.assign_slot(arg, slot_name(prog, arg2, arg), std::move(*v), at);
+        if (keep) stack.emplace_back(*ctx.slot_maybe(arg));
+        break;
+      }
+
+      case opcode::UNDEFINED:
+        log<log_type::ERROR>("object_cache", std::format("Variable {} does not exist at {}", prog.names[arg], at.str()));
+        stack.emplace_back(value{});
+        break;
+
+      case opcode::POP:
+        stack.pop_back();
+        break;
+
+      case opcode::MAKE_PAIR: {
+        auto y = pop();
+        auto x = pop();
+        if (x.has_value() && y.has_value()) stack.emplace_back(value{value_pair{std::move(*x), std::move(*y)}, at});
+        else {
+          log<log_type::ERROR>("map_interpreter", std::format("Expected a value at {}, but got nothing", at.str()));
+          stack.emplace_back(value{value_pair{}, at});
+        }
+        break;
+      }
+
+      case opcode::MAKE_VEC3: {
+        const auto z = pop_float(at);
+        const auto y = pop_float(at);
+        const auto x = pop_float(at);
+        stack.emplace_back(value{glm::vec3{x, y, z}, at});
+        break;
+      }
+
+      case opcode::MAKE_LIST:
+        stack.emplace_back(value::make_list(collect(arg, at), at));
+        break;
+
+      case opcode::POW: {
+        const auto e = pop_float(at);
+        const auto x = pop_float(at);
+        stack.emplace_back(value{std::pow(x, e), at});
+        break;
+      }
+
+      case opcode::MUL: case opcode::DIV: case opcode::MOD: case opcode::ADD: case opcode::SUB:
+      case opcode::EQ: case opcode::NE: case opcode::LT: case opcode::GT: case opcode::LE: case opcode::GE: {
+        const auto right = pop_value(at);
+        const auto left = pop_value(at);
+        value res;
+        switch (op) {
+          case opcode::MUL: res = left * right; break;
+          case opcode::DIV: res = left / right; break;
+          case opcode::MOD: res = left % right; break;
+          case opcode::ADD: res = left + right; break;
+          case opcode::SUB: res = left - right; break;
+          case opcode::EQ: res = left == right; break;
+          case opcode::NE: res = left != right; break;
+          case opcode::LT: res = left < right; break;
+          case opcode::GT: res = left > right; break;
+          case opcode::LE: res = left <= right; break;
+          case opcode::GE: res = left >= right; break;
+          default: OPENVTT_UNREACHABLE;
+        }
+        stack.emplace_back(std::move(res.relocate(at)));
+        break;
+      }
+
+      case opcode::CALL: {
+        const auto args = collect(arg2, at);
+        stack.emplace_back(invoke_builtin(prog.names[arg], args, *this, at));
+        break;
+      }
+
+      case opcode::CALL_BUILTIN: {
+        collect_into(call_args, arg2, at);
+        stack.emplace_back(prog.bound[arg](call_args, *this, at));
+        break;
+      }
+
+      case opcode::BEGIN_SCOPE:
+        if (current_scope != scope::NONE) {
+          log<log_type::ERROR>("map_parser", "Can't open a new scope while in another scope.");
+          break;
+        }
+        if (!context_stack.empty()) {
+          log<log_type::WARNING>("map_parser", "Entering a scope while the context stack is not empty. Clearing...");
+        }
+        current_scope = static_cast<scope>(arg);
+        context_stack.clear();
+        frame_stack.clear();
+        context_stack.emplace_back(prog.frames[arg2].slot_names.size());
+        frame_stack.push_back(arg2);
+        break;
+
+      case opcode::END_SCOPE:
+        if (!context_stack.empty()) {
+          context_stack.pop_back();
+          frame_stack.pop_back();
+        }
+        current_scope = scope::NONE;
+        break;
+
+      case opcode::PUSH_CONTEXT:
+        context_stack.emplace_back(prog.frames[arg2].slot_names.size());
+        frame_stack.push_back(arg2);
+        break;
+
+      case opcode::POP_CONTEXT:
+        if (!context_stack.empty()) {
+          context_stack.pop_back();
+          frame_stack.pop_back();
+        }
+        break;
+
+      case opcode::LOOP_BEGIN: {
+        const auto to = pop_int(at);
+        const auto from = pop_int(at);
+        const int64_t len = range_length(from, to, at);
+        if (len == 0) {
+          stack.emplace_back(value{value_list{}, at});
+          pc = arg;
+          break;
+        }
+        loops.push_back({from, to, list_builder{at, std::min(static_cast<size_t>(len), max_range_reserve)}});
+        break;
+      }
+
+      case opcode::LOOP_INDEX:
+        stack.emplace_back(value{loops.back().index, at});
+        break;
+
+      case opcode::LOOP_END: {
+        auto &l = loops.back();
+        if (auto v = pop(); v.has_value()) l.items.push(std::move(*v));
+        else log<log_type::ERROR>("map_interpreter", std::format("Expected a value at {}, but got nothing", at.str()));
+
+        if (++l.index < l.end) {
+          pc = arg;
+          break;
+        }
+        stack.emplace_back(l.items.finish());
+        loops.pop_back();
+        break;
+      }
+    }
+  }
+
+  if (!stack.empty()) {
+    log<log_type::WARNING>("map_interpreter", std::format("Program finished with {} dangling stack entries.", stack.size()));
+    stack.clear();
+  }
+}
@@ -0,0 +1,52 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_INTERPRETER_HPP
+#define MAP_INTERPRETER_HPP
+
+#include "map_state.hpp"
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief A structure to execute compiled map programs.
+ *
+ * The interpreter is a simple stack machine. It has the same semantics (including error messages and recovery) as the
+ * tree-walking `map_visitor`, but doesn't need to type-erase intermediate results.
+ */
+struct map_interpreter final : map_state {
+  std::vector<object_cache> context_stack{}; //!< The stack of variable contexts.
+
+  /**
+   * @brief Executes a program.
+   * @param prog The program to execute (its variables should be resolved, see `resolve_slots`).
+   */
+  void run(const program &prog);
+
+private:
+  using entry = std::optional<value>; //!< A stack entry (`std::nullopt` representing "no value").
+
+  entry pop();
+  value pop_value(const loc &at);
+  float pop_float(const loc &at);
+  int pop_int(const loc &at);
+
+  const std::string &slot_name(const program &prog, uint32_t depth, uint32_t slot) const;
+
+  std::vector<entry> stack{};
+  std::vector<uint32_t> frame_stack{}; //!< The frame layout of each context on the context stack.
+
+  /**
+   * @brief Structure representing a running loop (see `opcode::LOOP_BEGIN`).
+   */
+  struct loop {
+    int index; //!< The index of the current iteration.
+    int end; //!< The (exclusive) end of the range.
+    list_builder items; //!< The elements produced so far.
+  };
+  std::vector<loop> loops{}; //!< The stack of running loops.
+};
+}
+
+#endif //MAP_INTERPRETER_HPP
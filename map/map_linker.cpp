@@ -0,0 +1,147 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <algorithm>
+#include <optional>
+#include <unordered_set>
+
+#include "map_linker.hpp"
+#include "filesys.hpp"
+#include "renderer/log_view.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+
+namespace {
+/**
+ * @brief Checks whether an instruction calls `@include`.
+ */
+bool calls_include(const program &prog, const instr &i) {
+  return i.op == opcode::CALL && prog.names[i.arg] == include_directive;
+}
+
+/**
+ * @brief Gets the map included by the directive starting at an instruction, if there is one.
+ * @param prog The program.
+ * @param pc The index of the instruction.
+ * @return The asset name of the included map, or `std::nullopt` if there is no (well-formed) directive at `pc`.
+ *
+ * A directive compiles to `PUSH_CONST "map"; CALL @include, 1 args; POP`.
+ */
+std::optional<std::string> directive_at(const program &prog, const size_t pc) {
+  if (pc + 2 >= prog.code.size()) return std::nullopt;
+  const auto &push = prog.code[pc];
+  const auto &call = prog.code[pc + 1];
+  if (push.op != opcode::PUSH_CONST || !prog.constants[push.arg].is<std::string>()) return std::nullopt;
+  if (!calls_include(prog, call) || call.arg2 != 1 || prog.code[pc + 2].op != opcode::POP) return std::nullopt;
+  return prog.constants[push.arg].as<std::string>();
+}
+
+/**
+ * @brief Helper to splice included programs into a single one.
+ */
+struct linker {
+  const std::unordered_map<std::string, program> &units;
+  program_builder out{};
+  std::vector<std::string> active{}; //!< The maps currently being linked (the include chain).
+  std::unordered_set<std::string> linked{}; //!< The maps that have been linked in.
+
+  /**
+   * @brief Copies a program to the output, replacing its directives by the included programs.
+   * @param prog The program.
+   * @param nested Whether the program is included (in which case its scope is dropped).
+   */
+  void splice(const program &prog, const bool nested) {
+    std::vector<uint32_t> moved(prog.code.size() + 1); // old index -> new index
+    std::vector<uint32_t> jumps;
+
+    for (size_t pc = 0; pc < prog.code.size(); pc++) {
+      moved[pc] = out.next();
+      const auto &[op, arg, arg2, at] = prog.code[pc];
+      const auto &where = prog.locs[at];
+
+      if (const auto asset = directive_at(prog, pc); asset.has_value()) {
+        include(*asset, where);
+        moved[pc + 1] = moved[pc + 2] = out.next();
+        pc += 2;
+        continue;
+      }
+
+      switch (op) {
+        case opcode::BEGIN_SCOPE: case opcode::END_SCOPE:
+          // an included map runs in the scope of its includer
+          if (!nested) out.emit(op, where, arg, arg2);
+          break;
+        case opcode::PUSH_CONST:
+          out.emit(op, where, out.constant(prog.constants[arg]));
+          break;
+        case opcode::LOAD_NAME: case opcode::STORE_NAME: case opcode::DECLARE_NAME: case opcode::UNDEFINED:
+          out.emit(op, where, out.name(prog.names[arg]), arg2);
+          break;
+        case opcode::CALL:
+          if (calls_include(prog, prog.code[pc])) {
+            log<log_type::ERROR>("map_linker", std::format(
+              "{} expects a single string literal, and should be used as a statement (at {})", include_directive, where.str()));
+            for (uint32_t i = 0; i < arg2; i++) out.emit(opcode::POP, where);
+            out.emit(opcode::PUSH_NONE, where);
+          }
+          else out.emit(op, where, out.name(prog.names[arg]), arg2);
+          break;
+        case opcode::LOOP_BEGIN: case opcode::LOOP_END:
+          jumps.push_back(out.emit(op, where, arg, arg2));
+          break;
+        default:
+          out.emit(op, where, arg, arg2);
+          break;
+      }
+    }
+
+    moved[prog.code.size()] = out.next();
+    for (const auto j : jumps) out.emitted(j).arg = moved[out.emitted(j).arg];
+  }
+
+  /**
+   * @brief Links an included map at the current position.
+   * @param asset The asset name of the map.
+   * @param where The location of the directive.
+   */
+  void include(const std::string &asset, const loc &where) {
+    const auto path = asset_path<asset_type::MAP>(asset);
+    if (std::ranges::find(active, path) != active.end()) {
+      log<log_type::ERROR>("map_linker", std::format("Circular include of {} at {} (ignored)", asset, where.str()));
+      return;
+    }
+    if (!linked.insert(path).second) {
+      log<log_type::DEBUG>("map_linker", std::format("{} is already included, ignoring the include at {}", asset, where.str()));
+      return;
+    }
+
+    const auto it = units.find(path);
+    if (it == units.end()) return; // couldn't be opened (already reported)
+
+    active.push_back(path);
+    splice(it->second, true);
+    active.pop_back();
+  }
+};
+}
+
+std::vector<std::string> openvtt::map::find_includes(const program &prog) {
+  std::vector<std::string> res;
+  for (size_t pc = 0; pc < prog.code.size(); pc++) {
+    if (auto asset = directive_at(prog, pc); asset.has_value()) res.push_back(std::move(*asset));
+  }
+  return res;
+}
+
+void openvtt::map::link_includes(program &prog, const std::string &path, const std::unordered_map<std::string, program> &units) {
+  if (std::ranges::none_of(prog.code, [&prog](const instr &i) { return calls_include(prog, i); })) return;
+
+  linker l{units};
+  l.active.push_back(path);
+  l.linked.insert(path);
+  l.splice(prog, false);
+  prog = l.out.finish();
+  log<log_type::DEBUG>("map_linker", std::format("Linked {} included map(s) into {}", l.linked.size() - 1, path));
+}
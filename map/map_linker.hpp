@@ -0,0 +1,50 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_LINKER_HPP
+#define MAP_LINKER_HPP
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief The name of the include directive (`@include("map");`).
+ *
+ * `@include` is not a builtin; directives are resolved when the map is loaded, before it runs.
+ */
+constexpr std::string_view include_directive = "@include";
+
+/**
+ * @brief Gets the maps included by a program.
+ * @param prog The (unlinked) program.
+ * @return The asset names of the included maps, in program order (possibly with duplicates).
+ *
+ * Only well-formed directives are returned: an `@include` with a single string literal as argument, used as a
+ * statement.
+ */
+std::vector<std::string> find_includes(const program &prog);
+
+/**
+ * @brief Links the maps included by a program into it.
+ * @param prog The (unlinked and unresolved) program to link (modified in-place).
+ * @param path The path of the program's map file.
+ * @param units The (unlinked) programs of the included map files, by path.
+ *
+ * Each directive is replaced by the body of the included program (without its `objects` scope), so the included map
+ * runs in the scope of the includer, at the position of the directive. Included maps are linked recursively, so maps
+ * are evaluated in dependency order, and the variables they assign are visible to the includer afterwards.
+ *
+ * A map is only linked in once (at its first directive, in evaluation order); later directives for the same map are
+ * ignored, as are circular includes (which are reported). Malformed directives are reported and evaluate to "no value".
+ * Included maps which aren't in `units` (because they couldn't be opened) are skipped.
+ */
+void link_includes(program &prog, const std::string &path, const std::unordered_map<std::string, program> &units);
+}
+
+#endif //MAP_LINKER_HPP
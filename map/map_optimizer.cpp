@@ -0,0 +1,211 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <cmath>
+
+#include "map_optimizer.hpp"
+#include "map_builtins.hpp"
+
+using namespace openvtt::map;
+
+namespace {
+/**
+ * @brief The amount of stack entries an instruction pops and pushes.
+ */
+std::pair<uint32_t, uint32_t> stack_effect(const instr &i) {
+  switch (i.op) {
+    case opcode::PUSH_CONST: case opcode::PUSH_NONE: case opcode::LOAD_NAME: case opcode::LOAD_SLOT:
+    case opcode::UNDEFINED:
+      return {0, 1};
+    case opcode::STORE_NAME: return {1, i.arg2 != 0 ? 1u : 0u};
+    case opcode::DECLARE_NAME: return {1, 0};
+    case opcode::STORE_SLOT: return {1, 0};
+    case opcode::STORE_SLOT_KEEP: return {1, 1};
+    case opcode::POP: return {1, 0};
+    case opcode::MAKE_PAIR: return {2, 1};
+    case opcode::MAKE_VEC3: return {3, 1};
+    case opcode::MAKE_LIST: return {i.arg, 1};
+    case opcode::POW: case opcode::MUL: case opcode::DIV: case opcode::MOD: case opcode::ADD: case opcode::SUB:
+    case opcode::EQ: case opcode::NE: case opcode::LT: case opcode::GT: case opcode::LE: case opcode::GE:
+      return {2, 1};
+    case opcode::CALL: case opcode::CALL_BUILTIN: return {i.arg2, 1};
+    case opcode::BEGIN_SCOPE: case opcode::END_SCOPE: case opcode::PUSH_CONTEXT: case opcode::POP_CONTEXT: return {0, 0};
+    case opcode::LOOP_BEGIN: return {2, 0};
+    case opcode::LOOP_INDEX: return {0, 1};
+    case opcode::LOOP_END: return {1, 1};
+  }
+  OPENVTT_UNREACHABLE;
+}
+
+bool is_number(const value &v) { return v.is<int>() || v.is<float>(); }
+
+float to_float(const value &v) { return v.is<int>() ? static_cast<float>(v.as<int>()) : v.as<float>(); }
+
+/**
+ * @brief Evaluates an operation on constant operands, if that can't report an error.
+ * @param i The operation.
+ * @param args The (constant) operands.
+ * @param state A scratch state, used to invoke pure builtins (its scope is the scope the operation runs in).
+ * @param prog The program (for the names of builtins).
+ * @param at The location of the operation.
+ * @return The result, or `std::nullopt` if the operation can't be folded.
+ */
+std::optional<value> fold(const instr &i, const std::vector<value> &args, map_state &state, const program &prog, const loc &at) {
+  const auto numbers = [&args] { return std::ranges::all_of(args, is_number); };
+  const auto zero_divisor = [&args] { return args[1].is<int>() && args[1].as<int>() == 0; };
+
+  switch (i.op) {
+    case opcode::MAKE_PAIR: return value{value_pair{args[0], args[1]}, at};
+    case opcode::MAKE_VEC3:
+      if (!numbers()) return std::nullopt;
+      return value{glm::vec3{to_float(args[0]), to_float(args[1]), to_float(args[2])}, at};
+    case opcode::MAKE_LIST: return value::make_list(std::vector{args}, at);
+    case opcode::POW:
+      if (!numbers()) return std::nullopt;
+      return value{std::pow(to_float(args[0]), to_float(args[1])), at};
+
+    case opcode::MUL: case opcode::SUB: case opcode::LT: case opcode::GT: case opcode::LE: case opcode::GE:
+      if (!numbers()) return std::nullopt;
+      break;
+    case opcode::DIV:
+      if (!numbers() || zero_divisor()) return std::nullopt;
+      break;
+    case opcode::MOD:
+      if (!args[0].is<int>() || !args[1].is<int>() || zero_divisor()) return std::nullopt;
+      break;
+    case opcode::ADD:
+      if (!numbers() && !args[0].is<std::string>() && !args[0].is_list()) return std::nullopt;
+      break;
+    case opcode::EQ: case opcode::NE:
+      if (!numbers() && args[0].type_name() != args[1].type_name() && !(args[0].is_list() && args[1].is_list()))
+        return std::nullopt;
+      break;
+
+    case opcode::CALL:
+      if (!can_fold_builtin(prog.names[i.arg], args, state)) return std::nullopt;
+      return invoke_builtin(prog.names[i.arg], args, state, at);
+
+    default: return std::nullopt;
+  }
+
+  value res;
+  switch (i.op) {
+    case opcode::MUL: res = args[0] * args[1]; break;
+    case opcode::DIV: res = args[0] / args[1]; break;
+    case opcode::MOD: res = args[0] % args[1]; break;
+    case opcode::ADD: res = args[0] + args[1]; break;
+    case opcode::SUB: res = args[0] - args[1]; break;
+    case opcode::EQ: res = args[0] == args[1]; break;
+    case opcode::NE: res = args[0] != args[1]; break;
+    case opcode::LT: res = args[0] < args[1]; break;
+    case opcode::GT: res = args[0] > args[1]; break;
+    case opcode::LE: res = args[0] <= args[1]; break;
+    case opcode::GE: res = args[0] >= args[1]; break;
+    default: OPENVTT_UNREACHABLE;
+  }
+  return std::move(res.relocate(at));
+}
+
+/**
+ * @brief Checks whether an instruction jumps (to the instruction with index `arg`).
+ */
+bool is_jump(const instr &i) { return i.op == opcode::LOOP_BEGIN || i.op == opcode::LOOP_END; }
+
+/**
+ * @brief Removes unused constants from the constant pool (and renumbers the remaining ones).
+ */
+void compact_constants(program &prog) {
+  std::vector<uint32_t> remap(prog.constants.size(), std::numeric_limits<uint32_t>::max());
+  std::vector<value> constants;
+  for (auto &i : prog.code) {
+    if (i.op != opcode::PUSH_CONST) continue;
+    if (remap[i.arg] == std::numeric_limits<uint32_t>::max()) {
+      remap[i.arg] = static_cast<uint32_t>(constants.size());
+      constants.push_back(std::move(prog.constants[i.arg]));
+    }
+    i.arg = remap[i.arg];
+  }
+  prog.constants = std::move(constants);
+}
+}
+
+void openvtt::map::fold_constants(program &prog) {
+  struct entry {
+    bool is_const; //!< whether the entry is a constant (produced by a single PUSH_CONST)
+    size_t first; //!< index (in `code`) of the first instruction computing the entry
+  };
+
+  std::vector<instr> code;
+  code.reserve(prog.code.size());
+  std::vector<entry> stack;
+  map_state state; // only the scope is used; pure builtins don't modify the state
+  // for each instruction, the index of the first instruction generated at or after it (to relocate jump targets)
+  std::vector<uint32_t> moved(prog.code.size() + 1);
+
+  for (size_t idx = 0; idx < prog.code.size(); idx++) {
+    const auto &i = prog.code[idx];
+    moved[idx] = static_cast<uint32_t>(code.size());
+    const auto [pops, pushes] = stack_effect(i);
+    if (stack.size() < pops) {
+      // malformed program (shouldn't happen for compiled maps); keep the remainder as-is
+      for (size_t rest = idx; rest < prog.code.size(); rest++) moved[rest] = static_cast<uint32_t>(code.size() + rest - idx);
+      code.insert(code.end(), prog.code.begin() + static_cast<std::ptrdiff_t>(idx), prog.code.end());
+      break;
+    }
+
+    const auto operands = std::span{stack}.last(pops);
+    const size_t first = pops > 0 ? operands.front().first : code.size();
+    const bool all_const = std::ranges::all_of(operands, [](const entry &e) { return e.is_const; });
+
+    if (i.op == opcode::BEGIN_SCOPE && state.current_scope == map_state::scope::NONE)
+      state.current_scope = static_cast<map_state::scope>(i.arg);
+    else if (i.op == opcode::END_SCOPE)
+      state.current_scope = map_state::scope::NONE;
+
+    // discarded constant: drop it entirely
+    if (i.op == opcode::POP && all_const) {
+      code.resize(first);
+      stack.pop_back();
+      continue;
+    }
+
+    if (all_const && pushes == 1 && pops > 0) {
+      std::vector<value> args;
+      args.reserve(pops);
+      for (const auto &e : operands) args.push_back(prog.constants[code[e.first].arg]);
+
+      if (auto res = fold(i, args, state, prog, prog.locs[i.at]); res.has_value()) {
+        prog.constants.push_back(std::move(*res));
+        code.resize(first);
+        code.push_back(instr{opcode::PUSH_CONST, static_cast<uint32_t>(prog.constants.size() - 1), 0, i.at});
+        stack.resize(stack.size() - pops);
+        stack.push_back({true, first});
+        continue;
+      }
+    }
+
+    code.push_back(i);
+    stack.resize(stack.size() - pops);
+    for (uint32_t p = 0; p < pushes; p++) stack.push_back({i.op == opcode::PUSH_CONST, first});
+  }
+
+  moved.back() = static_cast<uint32_t>(code.size());
+  for (auto &i : code) {
+    if (is_jump(i)) i.arg = moved[i.arg];
+  }
+
+  prog.code = std::move(code);
+  compact_constants(prog);
+}
+
+void openvtt::map::bind_builtins(program &prog) {
+  prog.bound.assign(prog.names.size(), nullptr);
+  for (size_t n = 0; n < prog.names.size(); n++) {
+    if (const auto *desc = find_builtin(prog.names[n]); desc != nullptr) prog.bound[n] = desc->invoke;
+  }
+
+  for (auto &i : prog.code) {
+    if (i.op == opcode::CALL && prog.bound[i.arg] != nullptr) i.op = opcode::CALL_BUILTIN;
+  }
+}
@@ -0,0 +1,44 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_OPTIMIZER_HPP
+#define MAP_OPTIMIZER_HPP
+
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief Folds constant sub-expressions in a program, and removes constant expressions whose value is discarded.
+ * @param prog The program to optimize (modified in-place).
+ *
+ * The pass simulates the interpreter's stack, tracking which entries are constants (i.e. produced by a single
+ * `PUSH_CONST`). Operations whose operands are all constants are evaluated ahead of time, and replaced by a single
+ * `PUSH_CONST` of the result. This covers arithmetic, comparisons, pairs, `vec3`s, lists, and calls to pure builtins
+ * (see `can_fold_builtin`). A constant that is immediately popped is removed altogether.
+ *
+ * An operation is only folded if evaluating it can't report an error; erroneous expressions are left as-is, so their
+ * errors are still reported (with the same locations) when the program runs. Unused constants are removed from the
+ * constant pool afterwards.
+ *
+ * Loops are simulated as if their body runs once; that is sound because a loop body always leaves exactly one value
+ * on the stack, and loop results are never constants. Jump targets are relocated after instructions are removed.
+ *
+ * The pass works on both resolved and unresolved programs.
+ */
+void fold_constants(program &prog);
+
+/**
+ * @brief Binds all calls to known builtins in a program.
+ * @param prog The program to bind (modified in-place).
+ *
+ * Each `CALL` to a known builtin becomes a `CALL_BUILTIN`, which invokes the builtin's (type-checking) entry point
+ * through `program::bound`, without looking it up by name. Calls to unknown builtins are left as-is, so they are still
+ * reported when the program runs.
+ *
+ * Bound programs are only valid within a single run of the executable, so they should not be cached.
+ */
+void bind_builtins(program &prog);
+}
+
+#endif //MAP_OPTIMIZER_HPP
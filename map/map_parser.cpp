@@ -2,33 +2,102 @@
 // Created by jay on 12/6/24.
 //
 
-#include <fstream>
 #include <mapLexer.h>
 #include <mapParser.h>
 
+#include <chrono>
+#include <ranges>
+
 #include "map_parser.hpp"
 #include "map_errors.hpp"
 #include "filesys.hpp"
-#include "map_visitor.hpp"
+#include "map_compiler.hpp"
+#include "map_fast_parser.hpp"
+#include "map_linker.hpp"
+#include "map_optimizer.hpp"
+#include "map_interpreter.hpp"
+#include "program_cache.hpp"
 #include "renderer/render_cache.hpp"
+#include "worker_pool.hpp"
 
 using namespace openvtt::map;
 using namespace openvtt::renderer;
 
-map_desc map_desc::parse_from(const std::string &asset) {
-  auto path = asset_path<asset_type::MAP>(asset);
-  log<log_type::DEBUG>("map_parser", std::format("Loading map {}, from {}", asset, path));
+namespace {
+/**
+ * @brief Gets the time elapsed since a given time point.
+ * @param start The time point.
+ * @return The elapsed time, in milliseconds.
+ */
+double ms_since(const std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
 
-  std::ifstream strm(path);
-  if (!strm.is_open()) {
-    log<log_type::ERROR>("map_parser", std::format("Failed to open map file {}", path));
-    return {};
+/**
+ * @brief Parses map source code using ANTLR, in two stages.
+ * @param parser The parser (set up with the token stream and the error listener for the second stage).
+ * @param tokens The token stream of the parser.
+ * @param path The path of the map file (for the debug log).
+ * @return The parse tree (owned by the parser).
+ *
+ * The first stage uses SLL prediction, and bails out on the first syntax error without reporting it. That is faster,
+ * and suffices for almost all (correct) maps. Only if it fails, the source is parsed again using full LL prediction
+ * and the default error strategy, which reports the syntax errors (through the parser's listeners) and recovers from
+ * them. The tokens are only lexed once, so lexer errors are never reported twice.
+ */
+mapParser::ProgramContext *parse_two_stage(mapParser &parser, antlr4::CommonTokenStream &tokens, const std::string &path) {
+  using namespace antlr4;
+  const auto listeners = parser.getErrorListeners();
+  const auto start = std::chrono::steady_clock::now();
+
+  parser.removeErrorListeners();
+  parser.setErrorHandler(std::make_shared<BailErrorStrategy>());
+  parser.getInterpreter<atn::ParserATNSimulator>()->setPredictionMode(atn::PredictionMode::SLL);
+  try {
+    auto *tree = parser.program();
+    log<log_type::DEBUG>("map_parser", std::format("Parsed {} in {:.3f} ms (SLL)", path, ms_since(start)));
+    return tree;
+  }
+  catch (const ParseCancellationException &) {
+    log<log_type::DEBUG>("map_parser", std::format("SLL parse of {} failed after {:.3f} ms, retrying with full LL", path, ms_since(start)));
+  }
+
+  const auto retry = std::chrono::steady_clock::now();
+  tokens.seek(0);
+  parser.reset();
+  for (auto *l : listeners) parser.addErrorListener(l);
+  parser.setErrorHandler(std::make_shared<DefaultErrorStrategy>());
+  parser.getInterpreter<atn::ParserATNSimulator>()->setPredictionMode(atn::PredictionMode::LL);
+  auto *tree = parser.program();
+  log<log_type::DEBUG>("map_parser", std::format("Parsed {} in {:.3f} ms (LL)", path, ms_since(retry)));
+  return tree;
+}
+
+/**
+ * @brief Parses and compiles map source code.
+ * @param source The source code.
+ * @param path The path of the map file (for error messages and locations).
+ * @param opts The options for loading the map.
+ * @return The compiled (and optimized) program, and whether it was compiled without syntax errors.
+ *
+ * The hand-written parser is tried first. If it fails (or if `opts.antlr_parser` is set), the source is parsed using
+ * ANTLR instead (see `parse_two_stage`), which reports the syntax errors and recovers from them.
+ */
+std::pair<program, bool> compile_source(const std::string_view source, const std::string &path, const parse_options &opts) {
+  if (!opts.antlr_parser) {
+    const auto start = std::chrono::steady_clock::now();
+    if (auto prog = map_fast_parser::compile(source, path); prog.has_value()) {
+      log<log_type::DEBUG>("map_parser", std::format("Parsed and compiled {} in {:.3f} ms (hand-written parser)", path, ms_since(start)));
+      fold_constants(*prog);
+      return {std::move(*prog), true};
+    }
+    log<log_type::DEBUG>("map_parser", std::format("Syntax error in {} after {:.3f} ms, parsing it again using ANTLR", path, ms_since(start)));
   }
 
   lexer_error_listener lex_error{path};
   parser_error_listener parse_error{path};
 
-  antlr4::ANTLRInputStream input(strm);
+  antlr4::ANTLRInputStream input(source);
   mapLexer lexer(&input);
   lexer.removeErrorListeners();
   lexer.addErrorListener(&lex_error);
@@ -38,27 +107,173 @@ map_desc map_desc::parse_from(const std::string &asset) {
   parser.removeErrorListeners();
   parser.addErrorListener(&parse_error);
 
-  map_visitor visitor;
-  visitor.file = path;
-  visitor.visit(parser.program());
+  auto *tree = parse_two_stage(parser, tokens, path);
+  const auto start = std::chrono::steady_clock::now();
+  auto prog = map_compiler::compile(tree, path);
+  log<log_type::DEBUG>("map_parser", std::format("Compiled {} in {:.3f} ms", path, ms_since(start)));
+  fold_constants(prog);
+  return {std::move(prog), lex_error.error_count == 0 && parse_error.error_count == 0};
+}
+
+/**
+ * @brief Loads the (unlinked) program for a map file, from the program cache or by compiling the file.
+ * @param path The path of the map file.
+ * @param opts The options for loading the map.
+ * @return The program, or `std::nullopt` if the map file can't be opened.
+ */
+std::optional<program> load_program(const std::string &path, const parse_options &opts) {
+  const mapped_file source(path);
+  if (!source.is_open()) {
+    log<log_type::ERROR>("map_parser", std::format("Failed to open map file {}", path));
+    return std::nullopt;
+  }
+
+  const auto key = program_cache::key_for(path, source.text());
+  const auto cache_path = program_cache::path_for(path);
+  auto prog = program_cache::load(cache_path, key);
+  if (!prog.has_value()) {
+    log<log_type::DEBUG>("map_parser", std::format("No up-to-date compiled map at {}, compiling {}", cache_path, path));
+    auto [compiled, clean] = compile_source(source.text(), path, opts);
+    // don't cache maps with syntax errors, so the errors are reported again next time
+    if (clean) program_cache::store(cache_path, key, compiled);
+    prog = std::move(compiled);
+  }
+  return prog;
+}
+
+/**
+ * @brief Structure representing the files of a map (the map file itself, and the files it includes).
+ */
+struct map_files {
+  std::vector<std::string> paths; //!< The paths of all files, in the order they were discovered (the map file first).
+  std::unordered_map<std::string, program> programs; //!< The (unlinked) programs of the files that could be opened.
+};
+
+/**
+ * @brief Loads a map file, and all files it (transitively) includes.
+ * @param path The path of the map file.
+ * @param opts The options for loading the map.
+ * @return The files of the map.
+ *
+ * Each file is loaded (see `load_program`) on the shared worker pool. As soon as a file's program is available, the
+ * files it includes are submitted, so files are lexed, parsed, and compiled concurrently, and each one is cached on
+ * its own. Each file is only loaded once, even if it's included multiple times.
+ */
+map_files load_files(const std::string &path, const parse_options &opts) {
+  auto &pool = openvtt::worker_pool::shared();
+  map_files res;
+  std::vector<std::future<std::optional<program>>> pending;
+  const auto submit = [&](std::string file) {
+    pending.push_back(pool.submit([file, opts] { return load_program(file, opts); }));
+    res.paths.push_back(std::move(file));
+  };
+
+  submit(path);
+  for (size_t i = 0; i < pending.size(); i++) { // `pending` grows while iterating
+    auto prog = pending[i].get();
+    if (!prog.has_value()) continue;
+    for (const auto &asset : find_includes(*prog)) {
+      if (auto file = asset_path<asset_type::MAP>(asset); std::ranges::find(res.paths, file) == res.paths.end()) {
+        submit(std::move(file));
+      }
+    }
+    res.programs.emplace(res.paths[i], std::move(*prog));
+  }
+  return res;
+}
+
+/**
+ * @brief Loads (or reloads) a map.
+ * @param asset The map file to parse.
+ * @param opts The options for loading the map.
+ * @param live The currently loaded map, if reloading.
+ * @return The parsed map description, or `std::nullopt` if the map file can't be opened.
+ */
+std::optional<map_desc> load_map(const std::string &asset, const parse_options &opts, const map_desc *live) {
+  auto path = asset_path<asset_type::MAP>(asset);
+  log<log_type::DEBUG>("map_parser", std::format("Loading map {}, from {}", asset, path));
+
+  auto files = load_files(path, opts);
+  const auto root = files.programs.find(path);
+  if (root == files.programs.end()) return std::nullopt;
+  auto prog = std::move(root->second);
+  files.programs.erase(root);
+  link_includes(prog, path, files.programs);
+
+  resolve_slots(prog);
+  bind_builtins(prog);
+  if (opts.dump_program) {
+    log<log_type::INFO>("map_parser", std::format("Compiled program for {}:\n{}", path, prog.disassemble()));
+  }
+
+  map_interpreter interpreter;
+  interpreter.file = path;
+  if (live != nullptr) {
+    render_cache::begin_generation();
+    for (const auto &r : live->scene) {
+      interpreter.reusable.emplace(map_state::spawn_key(r->name, r->obj.raw(), r->sh, r->textures), r);
+    }
+    for (const auto &r : live->scene_instances) {
+      interpreter.reusable_instances.emplace(map_state::spawn_key(r->name, r->obj.raw(), r->sh, r->textures), r);
+    }
+  }
+
+  const auto [hits, misses] = render_cache::load_stats();
+  interpreter.run(prog);
+  render_cache::flush(); // upload the assets that are still being decoded in the background
+
+  if (live != nullptr) {
+    // whatever wasn't reused is no longer part of the map
+    for (const auto &r : interpreter.reusable | std::views::values) render_cache::release(r);
+    for (const auto &r : interpreter.reusable_instances | std::views::values) render_cache::release(r);
+    // ... and neither are the assets only they used
+    const size_t evicted = render_cache::evict_unused();
+
+    const auto [new_hits, new_misses] = render_cache::load_stats();
+    const size_t released = interpreter.reusable.size() + interpreter.reusable_instances.size();
+    log<log_type::INFO>("map_parser", std::format(
+      "Reloaded map {}: {} created, {} updated, {} destroyed ({} renderables, {} assets); {} assets reused, {} loaded",
+      asset, interpreter.spawned.size() + interpreter.spawned_instances.size() - interpreter.reused, interpreter.reused,
+      released + evicted, released, evicted, new_hits - hits, new_misses - misses
+    ));
+  }
+
+  // watch the region files as well, so editing a region reloads the map (and with it, the region)
+  for (const auto &r : interpreter.regions) files.paths.push_back(asset_path<asset_type::MAP>(r.asset));
 
-  if (visitor.highlight_binding.has_value()) {
-    if (visitor.requires_highlight.empty() && visitor.requires_instanced_highlight.empty()) {
+  if (interpreter.highlight_binding.has_value()) {
+    if (interpreter.requires_highlight.empty() && interpreter.requires_instanced_highlight.empty()) {
       log<log_type::WARNING>("map_parser", "Highlighting binding index provided, but no shaders require highlighting.");
     }
   }
-  else if(!visitor.requires_highlight.empty() || !visitor.requires_instanced_highlight.empty()) {
+  else if(!interpreter.requires_highlight.empty() || !interpreter.requires_instanced_highlight.empty()) {
     log<log_type::WARNING>("map_parser", "Highlighting binding index provided, but no shaders require highlighting.");
-    visitor.requires_highlight.clear();
-    visitor.requires_instanced_highlight.clear();
+    interpreter.requires_highlight.clear();
+    interpreter.requires_instanced_highlight.clear();
   }
 
-  return {
-    .scene = {visitor.spawned.begin(), visitor.spawned.end()},
-    .scene_instances = { visitor.spawned_instances.begin(), visitor.spawned_instances.end() },
-    .requires_highlight = std::move(visitor.requires_highlight),
-    .requires_instanced_highlight = std::move(visitor.requires_instanced_highlight),
-    .highlight_binding = visitor.highlight_binding,
-    .show_axes = visitor.show_axes
+  return map_desc{
+    .scene = {interpreter.spawned.begin(), interpreter.spawned.end()},
+    .scene_instances = { interpreter.spawned_instances.begin(), interpreter.spawned_instances.end() },
+    .requires_highlight = std::move(interpreter.requires_highlight),
+    .requires_instanced_highlight = std::move(interpreter.requires_instanced_highlight),
+    .highlight_binding = interpreter.highlight_binding,
+    .show_axes = interpreter.show_axes,
+    .regions = std::move(interpreter.regions),
+    .sources = std::move(files.paths)
   };
-}
\ No newline at end of file
+}
+}
+
+map_desc map_desc::parse_from(const std::string &asset, const parse_options &opts) {
+  return load_map(asset, opts, nullptr).value_or(map_desc{});
+}
+
+map_desc map_desc::reload_from(const std::string &asset, const map_desc &live, const parse_options &opts) {
+  auto res = load_map(asset, opts, &live);
+  if (!res.has_value()) {
+    log<log_type::WARNING>("map_parser", std::format("Keeping the current version of map {}", asset));
+    return live;
+  }
+  return std::move(*res);
+}
@@ -27,6 +27,26 @@ struct instanced_highlight {
   unsigned int uniform_instance_id; //!< The uniform containing the highlighted instance ID.
 };
 
+/**
+ * @brief Structure describing a streamed region of a map (declared using `@region`).
+ *
+ * The contents of a region live in a separate map file, which is only loaded while the camera is near the region (see
+ * `region_streamer`).
+ */
+struct map_region {
+  std::string asset; //!< The map file with the contents of the region.
+  glm::vec3 center; //!< The center of the region.
+  float radius; //!< The distance (on the XZ plane) from the center within which the region is loaded.
+};
+
+/**
+ * @brief Options for loading a map.
+ */
+struct parse_options {
+  bool dump_program = false; //!< Whether to log the disassembly of the compiled (and optimized) map program.
+  bool antlr_parser = false; //!< Whether to always parse using ANTLR (instead of trying the hand-written parser first).
+};
+
 /**
  * @brief Structure representing the description of a loaded map.
  */
@@ -37,16 +57,38 @@ struct map_desc {
   std::unordered_map<renderer::shader_ref, instanced_highlight> requires_instanced_highlight; //!< The instanced renderable objects that require highlighting.
   std::optional<int> highlight_binding; //!< The texture slot to which the highlighting FBO texture is bound.
   bool show_axes; //!< Whether to show the axes' gizmo.
+  std::vector<map_region> regions{}; //!< The streamed regions of the map (not loaded yet).
+  std::vector<std::string> sources{}; //!< The (full paths of the) files the map was loaded from (the map file first, then the files it includes).
 
   /**
    * @brief Parses a map from an asset file.
    * @param asset The map file to parse.
+   * @param opts The options for loading the map.
    * @return The parsed map description.
    *
    * The returned map is a best-effort one.
    * If parsing fails, a partial map might be returned.
+   *
+   * Maps included using `@include("map");` are loaded concurrently, and linked in at their directives (see
+   * `link_includes`).
+   */
+  static map_desc parse_from(const std::string &asset, const parse_options &opts = {});
+
+  /**
+   * @brief Reloads a map, updating a live map in place instead of rebuilding it.
+   * @param asset The map file to parse.
+   * @param live The currently loaded map (loaded from the same file).
+   * @param opts The options for loading the map.
+   * @return The description of the reloaded map.
+   *
+   * The map is evaluated again, and its spawns are diffed against the live map. Renderables which are spawned in the
+   * same way as before (same name, object, shader, and textures) are updated in place; new ones are created, and the
+   * live ones which are no longer spawned are released. Unchanged assets stay resident, as the render cache
+   * deduplicates them; colliders are reclaimed from the previous load. Assets which are no longer used are evicted.
+   *
+   * If the map file can't be opened, the live map is kept as-is.
    */
-  static map_desc parse_from(const std::string &asset);
+  static map_desc reload_from(const std::string &asset, const map_desc &live, const parse_options &opts = {});
 };
 }
 
@@ -0,0 +1,157 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <sstream>
+#include <algorithm>
+
+#include "map_program.hpp"
+
+using namespace openvtt::map;
+
+std::string program::disassemble() const {
+  std::stringstream strm;
+  for (size_t i = 0; i < code.size(); i++) {
+    const auto &[op, arg, arg2, at] = code[i];
+    strm << std::format("{:>6}  {:<12}", i, opcode_name(op));
+    switch (op) {
+      case opcode::PUSH_CONST:
+        strm << std::format("{} ({})", arg, static_cast<std::string>(constants[arg]));
+        break;
+      case opcode::LOAD_NAME: case opcode::DECLARE_NAME:
+        strm << std::format("{} ({})", arg, names[arg]);
+        break;
+      case opcode::STORE_NAME:
+        strm << std::format("{} ({}){}", arg, names[arg], arg2 != 0 ? " keep" : "");
+        break;
+      case opcode::LOAD_SLOT: case opcode::STORE_SLOT: case opcode::STORE_SLOT_KEEP:
+        strm << std::format("{}.{}", arg2, arg);
+        break;
+      case opcode::UNDEFINED:
+        strm << std::format("{} ({})", arg, names[arg]);
+        break;
+      case opcode::MAKE_LIST:
+        strm << arg;
+        break;
+      case opcode::LOOP_BEGIN: case opcode::LOOP_END:
+        strm << std::format("-> {}", arg);
+        break;
+      case opcode::BEGIN_SCOPE:
+        strm << std::format("{}, frame {}", arg, arg2);
+        break;
+      case opcode::PUSH_CONTEXT:
+        strm << std::format("frame {}", arg2);
+        break;
+      case opcode::CALL: case opcode::CALL_BUILTIN:
+        strm << std::format("{} ({}), {} args", arg, names[arg], arg2);
+        break;
+      default: break;
+    }
+    strm << std::format("  ; {}\n", locs[at].str());
+  }
+  return strm.str();
+}
+
+bool program::is_resolved() const {
+  return std::ranges::none_of(code, [](const instr &i) {
+    return i.op == opcode::LOAD_NAME || i.op == opcode::STORE_NAME || i.op == opcode::DECLARE_NAME;
+  });
+}
+
+void openvtt::map::resolve_slots(program &prog) {
+  using namespace renderer;
+  if (!prog.frames.empty()) return; // already resolved
+
+  struct scope_info { uint32_t frame; std::unordered_map<uint32_t, uint32_t> slots; };
+  std::vector<scope_info> scopes;
+
+  const auto find = [&scopes](const uint32_t name) -> std::optional<std::pair<uint32_t, uint32_t>> {
+    // innermost first, so declarations in a pushed context shadow outer ones
+    for (size_t depth = scopes.size(); depth-- > 0;) {
+      if (const auto it = scopes[depth].slots.find(name); it != scopes[depth].slots.end())
+        return std::pair{it->second, static_cast<uint32_t>(depth)};
+    }
+    return std::nullopt;
+  };
+
+  for (auto &[op, arg, arg2, at] : prog.code) {
+    switch (op) {
+      case opcode::BEGIN_SCOPE:
+        // opening a scope clears the context stack
+        scopes.clear();
+        prog.frames.emplace_back();
+        arg2 = static_cast<uint32_t>(prog.frames.size() - 1);
+        scopes.push_back({arg2, {}});
+        break;
+
+      case opcode::END_SCOPE: case opcode::POP_CONTEXT:
+        if (!scopes.empty()) scopes.pop_back();
+        break;
+
+      case opcode::PUSH_CONTEXT:
+        prog.frames.emplace_back();
+        arg2 = static_cast<uint32_t>(prog.frames.size() - 1);
+        scopes.push_back({arg2, {}});
+        break;
+
+      case opcode::LOAD_NAME:
+        if (const auto res = find(arg); res.has_value()) {
+          op = opcode::LOAD_SLOT;
+          std::tie(arg, arg2) = *res;
+        }
+        else op = opcode::UNDEFINED;
+        break;
+
+      case opcode::STORE_NAME: case opcode::DECLARE_NAME: {
+        // a declaration only reuses a slot of the innermost frame
+        const bool declare = op == opcode::DECLARE_NAME;
+        op = !declare && arg2 != 0 ? opcode::STORE_SLOT_KEEP : opcode::STORE_SLOT;
+        if (const auto res = find(arg); res.has_value() && (!declare || res->second == scopes.size() - 1)) {
+          std::tie(arg, arg2) = *res;
+          break;
+        }
+        if (scopes.empty()) {
+          log<log_type::ERROR>("map_resolver", std::format("Assignment to {} outside of any scope at {}", prog.names[arg], prog.locs[at].str()));
+          arg2 = std::numeric_limits<uint32_t>::max();
+          break;
+        }
+
+        // declare in the innermost frame
+        auto &[frame, slots] = scopes.back();
+        auto &layout = prog.frames[frame].slot_names;
+        const auto slot = static_cast<uint32_t>(layout.size());
+        layout.push_back(arg);
+        slots.emplace(arg, slot);
+        arg = slot;
+        arg2 = static_cast<uint32_t>(scopes.size() - 1);
+        break;
+      }
+
+      default: break;
+    }
+  }
+}
+
+uint32_t program_builder::constant(value v) {
+  prog.constants.push_back(std::move(v));
+  return static_cast<uint32_t>(prog.constants.size() - 1);
+}
+
+uint32_t program_builder::name(const std::string &n) {
+  if (const auto it = name_idx.find(n); it != name_idx.end()) return it->second;
+  prog.names.push_back(n);
+  const auto idx = static_cast<uint32_t>(prog.names.size() - 1);
+  name_idx.emplace(n, idx);
+  return idx;
+}
+
+uint32_t program_builder::emit(const opcode op, const loc &at, const uint32_t arg, const uint32_t arg2) {
+  if (prog.locs.empty() || !(prog.locs.back() == at)) prog.locs.push_back(at);
+  prog.code.push_back(instr{op, arg, arg2, static_cast<uint32_t>(prog.locs.size() - 1)});
+  return static_cast<uint32_t>(prog.code.size() - 1);
+}
+
+program program_builder::finish() {
+  name_idx.clear();
+  return std::exchange(prog, program{});
+}
@@ -0,0 +1,225 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_PROGRAM_HPP
+#define MAP_PROGRAM_HPP
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+#include "object_cache.hpp"
+
+namespace openvtt::map {
+struct map_state;
+
+/**
+ * @brief The type of (bound) builtin functions: (arguments, map state, position of the call) -> value.
+ */
+using builtin_fn = value (*)(std::span<const value>, map_state &, const loc &);
+
+/**
+ * @brief The operations supported by the map bytecode.
+ *
+ * The bytecode is executed on a stack machine (see `map_interpreter`). Each stack entry is either a value, or "no
+ * value" (the result of an erroneous sub-expression, mirroring the `no_value` marker of the tree-walking visitor).
+ */
+enum struct opcode : uint8_t {
+  PUSH_CONST,  //!< Pushes `constants[arg]`.
+  PUSH_NONE,   //!< Pushes "no value".
+  LOAD_NAME,   //!< Pushes the value of variable `names[arg]` (unresolved; see `resolve_slots`).
+  STORE_NAME,  //!< Pops a value, and assigns it to `names[arg]`. If `arg2 != 0`, the variable is pushed again (unresolved).
+  DECLARE_NAME, //!< Pops a value, and assigns it to `names[arg]` in the innermost context, shadowing outer variables (unresolved).
+  LOAD_SLOT,   //!< Pushes the value of the variable in slot `arg` of the context at depth `arg2`.
+  STORE_SLOT,  //!< Pops a value, and assigns it to slot `arg` of the context at depth `arg2`.
+  STORE_SLOT_KEEP, //!< Like `STORE_SLOT`, but pushes the variable again afterwards.
+  UNDEFINED,   //!< Reports that variable `names[arg]` doesn't exist, and pushes an empty value.
+  POP,         //!< Pops (and discards) the top of the stack.
+  MAKE_PAIR,   //!< Pops two values, and pushes them as a pair.
+  MAKE_VEC3,   //!< Pops three numbers, and pushes them as a `vec3`.
+  MAKE_LIST,   //!< Pops `arg` values, and pushes them as a list.
+  POW,         //!< Pops two numbers, and pushes `left ^ right`.
+  MUL,         //!< Pops two values, and pushes `left * right`.
+  DIV,         //!< Pops two values, and pushes `left / right`.
+  MOD,         //!< Pops two values, and pushes `left % right`.
+  ADD,         //!< Pops two values, and pushes `left + right`.
+  SUB,         //!< Pops two values, and pushes `left - right`.
+  EQ,          //!< Pops two values, and pushes `left == right`.
+  NE,          //!< Pops two values, and pushes `left != right`.
+  LT,          //!< Pops two values, and pushes `left < right`.
+  GT,          //!< Pops two values, and pushes `left > right`.
+  LE,          //!< Pops two values, and pushes `left <= right`.
+  GE,          //!< Pops two values, and pushes `left >= right`.
+  CALL,        //!< Pops `arg2` arguments, and pushes the result of invoking builtin `names[arg]`.
+  BEGIN_SCOPE, //!< Opens a new scope (`arg` is the `map_state::scope`), with a fresh context for frame `arg2`.
+  END_SCOPE,   //!< Closes the current scope.
+  PUSH_CONTEXT, //!< Pushes a fresh context for frame `arg2` onto the context stack (inside the current scope).
+  POP_CONTEXT, //!< Pops the innermost context.
+  LOOP_BEGIN,  //!< Pops two integers `to` and `from`, and starts iterating over `from .. to`. If that range is empty, pushes an empty list and jumps to `arg`.
+  LOOP_INDEX,  //!< Pushes the index of the current iteration of the innermost loop.
+  LOOP_END,    //!< Pops a value and adds it to the innermost loop's list. Jumps back to `arg` if there are iterations left; otherwise, ends the loop and pushes its list.
+  CALL_BUILTIN, //!< Like `CALL`, but invokes the bound builtin `bound[arg]` directly (see `bind_builtins`).
+};
+
+/**
+ * @brief Gets the mnemonic for an opcode.
+ * @param op The opcode.
+ * @return The mnemonic (as used in the disassembly).
+ */
+constexpr const char *opcode_name(const opcode op) {
+  switch (op) {
+    case opcode::PUSH_CONST: return "PUSH_CONST";
+    case opcode::PUSH_NONE: return "PUSH_NONE";
+    case opcode::LOAD_NAME: return "LOAD_NAME";
+    case opcode::STORE_NAME: return "STORE_NAME";
+    case opcode::DECLARE_NAME: return "DECLARE_NAME";
+    case opcode::LOAD_SLOT: return "LOAD_SLOT";
+    case opcode::STORE_SLOT: return "STORE_SLOT";
+    case opcode::STORE_SLOT_KEEP: return "STORE_SLOT_KEEP";
+    case opcode::UNDEFINED: return "UNDEFINED";
+    case opcode::POP: return "POP";
+    case opcode::MAKE_PAIR: return "MAKE_PAIR";
+    case opcode::MAKE_VEC3: return "MAKE_VEC3";
+    case opcode::MAKE_LIST: return "MAKE_LIST";
+    case opcode::POW: return "POW";
+    case opcode::MUL: return "MUL";
+    case opcode::DIV: return "DIV";
+    case opcode::MOD: return "MOD";
+    case opcode::ADD: return "ADD";
+    case opcode::SUB: return "SUB";
+    case opcode::EQ: return "EQ";
+    case opcode::NE: return "NE";
+    case opcode::LT: return "LT";
+    case opcode::GT: return "GT";
+    case opcode::LE: return "LE";
+    case opcode::GE: return "GE";
+    case opcode::CALL: return "CALL";
+    case opcode::BEGIN_SCOPE: return "BEGIN_SCOPE";
+    case opcode::END_SCOPE: return "END_SCOPE";
+    case opcode::PUSH_CONTEXT: return "PUSH_CONTEXT";
+    case opcode::POP_CONTEXT: return "POP_CONTEXT";
+    case opcode::LOOP_BEGIN: return "LOOP_BEGIN";
+    case opcode::LOOP_INDEX: return "LOOP_INDEX";
+    case opcode::LOOP_END: return "LOOP_END";
+    case opcode::CALL_BUILTIN: return "CALL_BUILTIN";
+  }
+  OPENVTT_UNREACHABLE;
+}
+
+/**
+ * @brief Structure representing a single bytecode instruction.
+ */
+struct instr {
+  opcode op; //!< The operation.
+  uint32_t arg = 0; //!< The first operand (meaning depends on the opcode).
+  uint32_t arg2 = 0; //!< The second operand (meaning depends on the opcode).
+  uint32_t at = 0; //!< Index of the instruction's source location in `program::locs`.
+};
+
+/**
+ * @brief Structure describing the variable slots of a context (frame).
+ */
+struct frame_layout {
+  std::vector<uint32_t> slot_names{}; //!< For each slot, the index of the variable's name in `program::names`.
+};
+
+/**
+ * @brief Structure representing a compiled map program.
+ *
+ * Operands never hold values or strings directly; they index into the constant, name, and location tables instead.
+ */
+struct program {
+  std::vector<instr> code{}; //!< The instructions.
+  std::vector<value> constants{}; //!< The constant pool (literals).
+  std::vector<std::string> names{}; //!< The name pool (variables and builtin functions).
+  std::vector<loc> locs{}; //!< The location pool.
+  std::vector<frame_layout> frames{}; //!< The frame layouts (only filled in by `resolve_slots`).
+  std::vector<builtin_fn> bound{}; //!< For each name, the builtin it is bound to, if any (only filled in by `bind_builtins`).
+
+  /**
+   * @brief Checks whether the program's variables have been resolved to slots.
+   * @return `true` if the program contains no name-based variable accesses.
+   */
+  [[nodiscard]] bool is_resolved() const;
+
+  /**
+   * @brief Generates a human-readable listing of the program.
+   * @return The disassembly, one instruction per line.
+   */
+  [[nodiscard]] std::string disassemble() const;
+};
+
+/**
+ * @brief Resolves all name-based variable accesses in a program to slot-based ones.
+ * @param prog The program to resolve (modified in-place).
+ *
+ * The resolver mirrors the interpreter's context stack at compile time. Each scope (and each context pushed inside it)
+ * gets a frame layout; the first assignment to a name (in program order) reserves a slot for it in the innermost frame,
+ * and later accesses to that name refer to the innermost slot for it by (depth, slot). `DECLARE_NAME` always reserves
+ * a slot in the innermost frame, shadowing outer ones. Reads of names that aren't assigned before become `UNDEFINED`.
+ *
+ * A slot reserved by an assignment is only declared at runtime once that assignment succeeds, so reading a variable
+ * whose initial assignment failed still reports that the variable doesn't exist.
+ */
+void resolve_slots(program &prog);
+
+/**
+ * @brief Helper class to incrementally build a `program`.
+ *
+ * Names are interned, and consecutive instructions with the same location share a single location entry.
+ */
+class program_builder {
+public:
+  /**
+   * @brief Adds a constant to the constant pool.
+   * @param v The constant.
+   * @return The index of the constant.
+   */
+  uint32_t constant(value v);
+
+  /**
+   * @brief Interns a name in the name pool.
+   * @param n The name.
+   * @return The index of the name.
+   */
+  uint32_t name(const std::string &n);
+
+  /**
+   * @brief Emits a single instruction.
+   * @param op The operation.
+   * @param at The source location of the instruction.
+   * @param arg The first operand.
+   * @param arg2 The second operand.
+   * @return The index of the instruction.
+   */
+  uint32_t emit(opcode op, const loc &at, uint32_t arg = 0, uint32_t arg2 = 0);
+
+  /**
+   * @brief Gets an already emitted instruction, so its operands can be changed (e.g. to fill in a jump target).
+   * @param idx The index of the instruction (as returned by `emit`).
+   * @return A reference to the instruction.
+   */
+  [[nodiscard]] instr &emitted(uint32_t idx) { return prog.code[idx]; }
+
+  /**
+   * @brief Gets the index the next emitted instruction will get.
+   * @return The amount of instructions emitted so far.
+   */
+  [[nodiscard]] uint32_t next() const { return static_cast<uint32_t>(prog.code.size()); }
+
+  /**
+   * @brief Finishes the program.
+   * @return The built program (the builder is left empty).
+   */
+  program finish();
+
+private:
+  program prog;
+  std::unordered_map<std::string, uint32_t> name_idx;
+};
+}
+
+#endif //MAP_PROGRAM_HPP
@@ -0,0 +1,126 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_STATE_HPP
+#define MAP_STATE_HPP
+
+#include <string>
+#include <optional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "map_parser.hpp"
+#include "renderer/render_cache.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief The state shared by all map evaluators (the tree-walking visitor and the bytecode interpreter).
+ *
+ * This structure holds everything the builtin functions read and write while a map is being evaluated. It does not
+ * hold any variables; those are managed by the evaluators themselves.
+ */
+struct map_state {
+  /**
+   * @brief The scopes a map can be evaluated in.
+   */
+  enum struct scope { NONE, VOXEL, OBJECTS };
+
+  std::string file; //!< The file being evaluated.
+  std::unordered_set<renderer::render_ref> spawned{}; //!< The set of spawned renderable objects.
+  std::unordered_set<renderer::instanced_render_ref> spawned_instances{}; //!< The set of spawned instanced renderable objects.
+  std::unordered_map<renderer::shader_ref, single_highlight> requires_highlight{}; //!< The renderable objects that require highlighting.
+  std::unordered_map<renderer::shader_ref, instanced_highlight> requires_instanced_highlight{}; //!< The instanced renderable objects that require highlighting.
+  std::optional<int> highlight_binding{}; //!< The texture slot to which the highlighting FBO texture is bound.
+  bool show_axes = false; //!< Whether to show the axes.
+  std::vector<map_region> regions{}; //!< The streamed regions declared by the map.
+  scope current_scope = scope::NONE; //!< The current scope of the evaluator.
+
+  /**
+   * @brief Live renderables from before a reload, which can be reused by an identical spawn (see `spawn`).
+   */
+  std::unordered_multimap<std::string, renderer::render_ref> reusable{};
+  /**
+   * @brief Live instanced renderables from before a reload, which can be reused by an identical spawn (see `spawn`).
+   */
+  std::unordered_multimap<std::string, renderer::instanced_render_ref> reusable_instances{};
+  size_t reused = 0; //!< The amount of spawns that reused a live (instanced) renderable.
+
+  using texture_list = std::vector<std::pair<unsigned int, renderer::texture_ref>>; //!< Textures bound to a renderable.
+
+  /**
+   * @brief Computes the key identifying a spawned renderable (across reloads).
+   * @param name The name of the renderable.
+   * @param obj The raw reference to the object.
+   * @param sh The shader of the renderable.
+   * @param tex The textures of the renderable.
+   * @return The key.
+   *
+   * Since assets are deduplicated by the render cache, an unchanged spawn in a reloaded map uses the same references,
+   * and hence has the same key.
+   */
+  static std::string spawn_key(const std::string &name, const size_t obj, const renderer::shader_ref &sh, const texture_list &tex) {
+    std::vector<size_t> raw{obj, sh.raw()};
+    for (const auto &[loc, t] : tex) {
+      raw.push_back(loc);
+      raw.push_back(t.raw());
+    }
+    std::string key;
+    renderer::type_traits::append_key(key, name);
+    renderer::type_traits::append_key(key, std::span<const size_t>{raw});
+    return key;
+  }
+
+  /**
+   * @brief Spawns a new renderable, and registers it as spawned.
+   * @param name The name of the renderable.
+   * @param obj The object to render.
+   * @param sh The shader to use.
+   * @param tex The textures to bind.
+   * @return A reference to the renderable.
+   *
+   * If an identical renderable was live before a reload (see `reusable`), it is reset and reused instead (keeping its
+   * slot in the cache and its UI state).
+   */
+  renderer::render_ref spawn(const std::string &name, const renderer::object_ref &obj, const renderer::shader_ref &sh, const texture_list &tex) {
+    const auto ref = spawn_or_reuse(reusable, spawn_key(name, obj.raw(), sh, tex), name, obj, sh, renderer::uniforms::from_shader(sh), tex);
+    spawned.insert(ref);
+    return ref;
+  }
+
+  /**
+   * @brief Spawns a new instanced renderable, and registers it as spawned.
+   * @param name The name of the renderable.
+   * @param obj The instanced object to render.
+   * @param sh The shader to use.
+   * @param tex The textures to bind.
+   * @return A reference to the instanced renderable.
+   *
+   * Identical instanced renderables from before a reload are reused, in the same way as in `spawn`.
+   */
+  renderer::instanced_render_ref spawn(const std::string &name, const renderer::instanced_object_ref &obj, const renderer::shader_ref &sh, const texture_list &tex) {
+    const auto ref = spawn_or_reuse(reusable_instances, spawn_key(name, obj.raw(), sh, tex), name, obj, sh, renderer::instanced_uniforms::from_shader(sh), tex);
+    spawned_instances.insert(ref);
+    return ref;
+  }
+
+private:
+  template <typename T, typename ... Args>
+  renderer::t_ref<T> spawn_or_reuse(std::unordered_multimap<std::string, renderer::t_ref<T>> &pool, const std::string &key, Args &&... args) {
+    if (const auto it = pool.find(key); it != pool.end()) {
+      const auto ref = it->second;
+      pool.erase(it);
+      auto &live = *ref;
+      const bool active = live.active;
+      live = T(std::forward<Args>(args)...);
+      live.active = active;
+      reused++;
+      return ref;
+    }
+    return renderer::render_cache::construct<T>(std::forward<Args>(args)...);
+  }
+};
+}
+
+#endif //MAP_STATE_HPP
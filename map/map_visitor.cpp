@@ -10,6 +10,7 @@ using namespace openvtt::map;
 using namespace openvtt::renderer;
 
 std::any map_visitor::visitProgram(mapParser::ProgramContext *context) {
+  file_id = loc::intern(file);
   visit_through(context->objects, at(*context));
   return no_value{at(*context)}; // no reasonable return value possible
 }
@@ -74,11 +75,32 @@ std::any map_visitor::visitVec3Expr(mapParser::Vec3ExprContext *context) {
 }
 
 std::any map_visitor::visitEmptyListExpr(mapParser::EmptyListExprContext *context) {
-  return value{std::vector<value>{}, at(*context)};
+  return value{value_list{}, at(*context)};
 }
 
 std::any map_visitor::visitListExpr(mapParser::ListExprContext *context) {
-  return value{visit_type_check<std::vector<value>>(context->exprs, at(*context), "value list"), at(*context)};
+  return value::make_list(visit_type_check<std::vector<value>>(context->exprs, at(*context), "value list"), at(*context));
+}
+
+std::any map_visitor::visitRangeExpr(mapParser::RangeExprContext *context) {
+  list_builder items{at(*context)};
+  for_range(context->from, context->to, at(*context), [this, context, &items](const int i) {
+    items.push(value{i, at(*context)});
+  });
+  return items.finish();
+}
+
+std::any map_visitor::visitComprehensionExpr(mapParser::ComprehensionExprContext *context) {
+  const auto &var = context->var->getText();
+  list_builder items{at(*context)};
+  // the comprehension gets its own context, so its loop variable shadows (and doesn't outlive) outer variables
+  with_new_context([this, context, &var, &items] {
+    for_range(context->from, context->to, at(*context), [this, context, &var, &items](const int i) {
+      context_stack.back().assign(var, value{i, at(*context)}, at(*context));
+      if (auto v = visit_maybe_value(context->elem, at(*context)); v.has_value()) items.push(std::move(*v));
+    });
+  });
+  return items.finish();
 }
 
 std::any map_visitor::visitParenExpr(mapParser::ParenExprContext *context) {
@@ -134,15 +156,7 @@ std::any map_visitor::visitCompExpr(mapParser::CompExprContext *context) {
 std::any map_visitor::visitAssignExpr(mapParser::AssignExprContext *context) {
   return visit_maybe_value(context->value, at(*context)) | [context, this](value v) {
     const auto &var = context->x->getText();
-    for (auto &ctx: context_stack | std::ranges::views::reverse) {
-      if (ctx.lookup_var_maybe(var).has_value()) {
-        ctx.assign(var, std::move(v), at(*context));
-        return std::any{identifier{var}};
-      }
-    }
-
-    // not found in stack, so declare a new var
-    context_stack.back().assign(var, std::move(v), at(*context));
+    assign_var(var, std::move(v), at(*context));
     return std::any{identifier{var}};
   } || [this, context]{ return no_value{at(*context)}; };
 }
@@ -5,11 +5,13 @@
 #ifndef MAP_VISITOR_HPP
 #define MAP_VISITOR_HPP
 
+#include <ranges>
 #include <unordered_set>
 #include <mapVisitor.h>
 #include <random>
 
 #include "map_parser.hpp"
+#include "map_state.hpp"
 #include "object_cache.hpp"
 
 /**
@@ -52,7 +54,8 @@ struct no_value {
  * The generated texture uses 4 octaves of perlin noise, each with its own parameters:
  * \f$\frac{\sum_{i=0}^4 \alpha_i * noise(\beta_i * coord + \delta_i)}{\sum_{i=0}^4 \alpha_i}\f$.
  * The alpha values are used to determine the influence of each octave on the final value, the beta values are used to
- * re-scale that octave, and the delta values offset the octaves from the coordinate (avoiding some artifacts).
+ * re-scale that octave, and the delta values offset the octaves from the coordinate (avoiding some artifacts). The
+ * (2D) coordinates are extended to 3D with a fixed Z coordinate (see `tiered_perlin` in `perlin.hpp`).
  */
 struct voxel {
   static inline std::mt19937 gen{std::random_device{}()}; //!< The random number generator.
@@ -71,28 +74,21 @@ struct voxel {
  * @brief A structure to visit the parser's AST.
  *
  * The actual parser is generated by ANTLR4, and this visitor is used to traverse the AST.
+ * Maps are normally evaluated by compiling them (`map_compiler`) and running the result (`map_interpreter`); this
+ * visitor is kept as the reference implementation of the map semantics.
  */
-struct map_visitor final : mapVisitor {
-  enum struct scope { NONE, VOXEL, OBJECTS };
-
-  std::string file; //!< The file being parsed.
+struct map_visitor final : mapVisitor, map_state {
   std::vector<object_cache> context_stack{}; //!< The stack of variable contexts.
-  std::unordered_set<renderer::render_ref> spawned{}; //!< The set of spawned renderable objects.
-  std::unordered_set<renderer::instanced_render_ref> spawned_instances{}; //!< The set of spawned instanced renderable objects.
-  std::unordered_map<renderer::shader_ref, single_highlight> requires_highlight{}; //!< The renderable objects that require highlighting.
-  std::unordered_map<renderer::shader_ref, instanced_highlight> requires_instanced_highlight{}; //!< The instanced renderable objects that require highlighting.
-  std::optional<int> highlight_binding{}; //!< The texture slot to which the highlighting FBO texture is bound.
-  bool show_axes = false; //!< Whether to show the axes.
-  scope current_scope = scope::NONE; //!< The current scope of the visitor.
+  uint32_t file_id = 0; //!< The interned ID of `file` (set when visiting the program).
 
   /**
-   * @brief Searches the context stack for a variable.
+   * @brief Searches the context stack for a variable (innermost context first).
    * @param name The variable name to search for.
    * @param at The location (in the source code) of the search.
    * @return The value of the variable, or an empty (void/`std::monostate`) value if the variable does not exist.
    */
   constexpr value search_stack(const std::string &name, const loc &at) const {
-    for (const auto &ctx : context_stack) {
+    for (const auto &ctx : context_stack | std::ranges::views::reverse) {
       if (const auto v = ctx.lookup_var_maybe(name); v.has_value())
         return *v;
     }
@@ -108,8 +104,8 @@ struct map_visitor final : mapVisitor {
    * @param ctx The ANTLR parser context.
    * @return The location of the context.
    */
-  constexpr loc at(const antlr4::ParserRuleContext &ctx) const {
-    return {ctx, file};
+  loc at(const antlr4::ParserRuleContext &ctx) const {
+    return {ctx, file_id};
   }
 
   /**
@@ -302,6 +298,43 @@ struct map_visitor final : mapVisitor {
     return visit_maybe_value<T>(c, at) || [] { return default_value_v<T>; };
   }
 
+  /**
+   * @brief Assigns to a variable, declaring it in the innermost context if it doesn't exist yet.
+   * @param var The name of the variable.
+   * @param v The value to assign.
+   * @param at The location of the assignment.
+   */
+  void assign_var(const std::string &var, value &&v, const loc &at) {
+    for (auto &ctx : context_stack | std::ranges::views::reverse) {
+      if (ctx.lookup_var_maybe(var).has_value()) {
+        ctx.assign(var, std::move(v), at);
+        return;
+      }
+    }
+
+    // not found in stack, so declare a new var
+    context_stack.back().assign(var, std::move(v), at);
+  }
+
+  /**
+   * @brief Evaluates the bounds of a range, and invokes the given lambda for each index in the range.
+   * @tparam F The lambda type.
+   * @param from The start of the range (inclusive).
+   * @param to The end of the range (exclusive).
+   * @param at The location of the range.
+   * @param f The lambda to invoke.
+   *
+   * Both bounds should be integers; otherwise, an error message is generated, and the range is empty. The same holds
+   * for ranges that are too large (see `range_length`).
+   */
+  template <std::invocable<int> F>
+  void for_range(antlr4::ParserRuleContext *from, antlr4::ParserRuleContext *to, const loc &at, F &&f) {
+    const auto start = visit_maybe_value<int>(from, at);
+    const auto end = visit_maybe_value<int>(to, at);
+    if (!start.has_value() || !end.has_value() || range_length(*start, *end, at) == 0) return;
+    for (int i = *start; i < *end; i++) f(i);
+  }
+
   /**
    * @brief Invokes the given lambda with a new stack slot.
    * @tparam F The lambda type.
@@ -369,6 +402,10 @@ struct map_visitor final : mapVisitor {
 
   std::any visitListExpr(mapParser::ListExprContext *context) override; //!< Visitor for the `listExpr` alternative.
 
+  std::any visitRangeExpr(mapParser::RangeExprContext *context) override; //!< Visitor for the `rangeExpr` alternative.
+
+  std::any visitComprehensionExpr(mapParser::ComprehensionExprContext *context) override; //!< Visitor for the `comprehensionExpr` alternative.
+
   std::any visitParenExpr(mapParser::ParenExprContext *context) override; //!< Visitor for the `parenExpr` alternative.
 
   std::any visitPowExpr(mapParser::PowExprContext *context) override; //!< Visitor for the `powExpr` alternative.
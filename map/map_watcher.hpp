@@ -0,0 +1,82 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef MAP_WATCHER_HPP
+#define MAP_WATCHER_HPP
+
+#include <chrono>
+#include <filesystem>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace openvtt::map {
+/**
+ * @brief Class watching the source files of a map for changes (by polling their modification times).
+ *
+ * Polling is throttled, so `changed` can be called every frame.
+ */
+class map_watcher {
+public:
+  using clock = std::chrono::steady_clock; //!< The clock used for throttling.
+
+  /**
+   * @brief Creates a new watcher.
+   * @param interval The minimal time between two polls.
+   */
+  explicit map_watcher(const clock::duration interval = std::chrono::milliseconds(250)) : interval{interval} {}
+
+  /**
+   * @brief Sets the files to watch, and records their current modification times.
+   * @param files The (full paths of the) files to watch.
+   */
+  void watch(const std::vector<std::string> &files) {
+    watched.clear();
+    watched.reserve(files.size());
+    for (const auto &f : files) watched.push_back({f, modified(f)});
+    last_poll = clock::now();
+  }
+
+  /**
+   * @brief Checks whether any of the watched files changed since the last call (or since `watch`).
+   * @return `true` if a file was modified, created, or removed.
+   */
+  bool changed() {
+    if (const auto now = clock::now(); now - last_poll < interval) return false;
+    else last_poll = now;
+
+    bool any = false;
+    for (auto &[path, time] : watched) {
+      if (const auto t = modified(path); t != time) {
+        time = t;
+        any = true;
+      }
+    }
+    return any;
+  }
+
+private:
+  using file_time = std::optional<std::filesystem::file_time_type>;
+
+  static file_time modified(const std::string &path) {
+    std::error_code ec;
+    const auto t = std::filesystem::last_write_time(path, ec);
+    return ec ? std::nullopt : file_time{t};
+  }
+
+  /**
+   * @brief Structure holding a watched file.
+   */
+  struct watched_file {
+    std::string path; //!< The path of the file.
+    file_time time; //!< The last seen modification time (if the file exists).
+  };
+
+  clock::duration interval; //!< The minimal time between two polls.
+  clock::time_point last_poll{}; //!< The time of the last poll.
+  std::vector<watched_file> watched{}; //!< The watched files.
+};
+}
+
+#endif //MAP_WATCHER_HPP
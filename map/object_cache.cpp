@@ -2,34 +2,51 @@
 // Created by jay on 12/14/24.
 //
 
+#include <deque>
+#include <mutex>
+
 #include "object_cache.hpp"
 
 using namespace openvtt::map;
 
-value_pair::value_pair() : _first{new value{}}, _second{new value{}} {}
-value_pair::value_pair(const value &first, const value &second) : _first{new value{first}}, _second{new value{second}} {}
-value_pair::value_pair(value &&first, value &&second) : _first{new value{std::move(first)}}, _second{new value{std::move(second)}} {}
+namespace {
+struct file_table {
+  std::mutex lock;
+  std::deque<std::string> names{"(invalid)"}; // deque: references stay valid while interning
+  std::unordered_map<std::string_view, uint32_t> ids{{names.front(), 0}};
+};
+
+file_table &files() {
+  static file_table table;
+  return table;
+}
+}
 
-value_pair::value_pair(const value_pair &other) { *this = other; }
-value_pair::value_pair(value_pair &&other) noexcept { *this = std::move(other); }
+uint32_t loc::intern(const std::string_view file) {
+  auto &[lock, names, ids] = files();
+  std::scoped_lock guard{lock};
+  if (const auto it = ids.find(file); it != ids.end()) return it->second;
+  const auto id = static_cast<uint32_t>(names.size());
+  names.emplace_back(file);
+  ids.emplace(names.back(), id);
+  return id;
+}
 
-value_pair &value_pair::operator=(const value_pair &other) {
-  if (this == &other) return *this;
-  delete _first; delete _second;
-  _first = new value{other.first()};
-  _second = new value{other.second()};
-  return *this;
+const std::string &loc::file_name() const {
+  auto &[lock, names, ids] = files();
+  std::scoped_lock guard{lock};
+  return file_id < names.size() ? names[file_id] : names.front();
 }
 
-value_pair &value_pair::operator=(value_pair &&other) noexcept {
-  if (this == &other) return *this;
-  std::swap(_first, other._first);
-  std::swap(_second, other._second);
-  return *this;
+value_pair::value_pair() {
+  static const auto empty = std::make_shared<const std::pair<value, value>>();
+  data = empty;
 }
+value_pair::value_pair(const value &first, const value &second) :
+  data{std::make_shared<const std::pair<value, value>>(first, second)} {}
+value_pair::value_pair(value &&first, value &&second) :
+  data{std::make_shared<const std::pair<value, value>>(std::move(first), std::move(second))} {}
 
 std::pair<const value &, const value &> value_pair::as_pair() const { return {first(), second()}; }
-value &value_pair::first() const { return *_first; }
-value &value_pair::second() const { return *_second; }
-
-value_pair::~value_pair() { delete _first; delete _second; }
\ No newline at end of file
+const value &value_pair::first() const { return data->first; }
+const value &value_pair::second() const { return data->second; }
@@ -5,63 +5,126 @@
 #ifndef OBJECT_CACHE_HPP
 #define OBJECT_CACHE_HPP
 
+#include <algorithm>
+#include <cstdint>
 #include <string>
 #include <unordered_map>
 #include <utility>
 #include <variant>
+#include <memory>
 #include <glm/glm.hpp>
 #include <antlr4-runtime/antlr4-runtime.h>
 
 #include "util.hpp"
+#include "shared_list.hpp"
 #include "renderer/render_cache.hpp"
 #include "renderer/log_view.hpp"
 
 namespace openvtt::map {
 /**
  * @brief Structure representing a location in the source file.
+ *
+ * File names are interned in a global table (see `intern`), so a location is only a file ID, a line and a column.
+ * File ID 0 is reserved for invalid locations.
  */
 class loc {
 public:
   /**
    * @brief Constructs a new (invalid) location.
    */
-  constexpr loc() : file{"(invalid)"}, line{-1UL}, col{-1UL} {}
+  constexpr loc() = default;
+
   /**
    * @brief Constructs a new location.
-   * @param file The file name.
+   * @param file The file name (interned if necessary).
    * @param line The line number.
    * @param col The column number.
    */
-  constexpr loc(std::string file, const size_t line, const size_t col) : file{std::move(file)}, line{line}, col{col} {}
+  loc(const std::string_view file, const size_t line, const size_t col) :
+    file_id{intern(file)}, line{static_cast<uint32_t>(line)}, col{static_cast<uint32_t>(col)} {}
+
+  /**
+   * @brief Constructs a new location in an already interned file.
+   * @param file_id The file ID (as returned by `intern`).
+   * @param line The line number.
+   * @param col The column number.
+   */
+  constexpr loc(const uint32_t file_id, const size_t line, const size_t col) :
+    file_id{file_id}, line{static_cast<uint32_t>(line)}, col{static_cast<uint32_t>(col)} {}
 
   /**
    * @brief Constructs a new location from a parser context.
    * @param ctx The parser context.
-   * @param file The file name.
+   * @param file_id The file ID (as returned by `intern`).
    *
    * The context is used to extract the line number and column number (both from the start of the context).
    */
-  constexpr loc(const antlr4::ParserRuleContext &ctx, std::string file) :
-    file{std::move(file)}, line{ctx.start->getLine()}, col{ctx.start->getCharPositionInLine() + 1} {}
+  loc(const antlr4::ParserRuleContext &ctx, const uint32_t file_id) :
+    loc{file_id, ctx.start->getLine(), ctx.start->getCharPositionInLine() + 1} {}
+
+  /**
+   * @brief Interns a file name.
+   * @param file The file name.
+   * @return The ID of the file name (the same name always gets the same ID).
+   *
+   * This function is thread-safe.
+   */
+  static uint32_t intern(std::string_view file);
 
   /**
    * @brief Generates a string representation of the location.
    * @return The string representation of the location.
    */
-  [[nodiscard]] constexpr std::string str() const { return std::format("{}:{}:{}", file, line, col); }
+  [[nodiscard]] std::string str() const { return std::format("{}:{}:{}", file_name(), line, col); }
+
+  /**
+   * @brief Compares two locations for equality.
+   * @param other The other location.
+   * @return `true` if both locations refer to the same file, line, and column.
+   */
+  [[nodiscard]] constexpr bool operator==(const loc &other) const = default;
+
+  /**
+   * @brief Gets the file name of the location.
+   * @return The file name.
+   */
+  [[nodiscard]] const std::string &file_name() const;
+
+  /**
+   * @brief Gets the (interned) file ID of the location.
+   * @return The file ID.
+   */
+  [[nodiscard]] constexpr uint32_t file() const { return file_id; }
+
+  /**
+   * @brief Gets the line number of the location.
+   * @return The line number.
+   */
+  [[nodiscard]] constexpr size_t line_number() const { return line; }
+
+  /**
+   * @brief Gets the column number of the location.
+   * @return The column number.
+   */
+  [[nodiscard]] constexpr size_t column_number() const { return col; }
 
 private:
-  std::string file{};
-  size_t line;
-  size_t col;
+  uint32_t file_id = 0;
+  uint32_t line = -1U;
+  uint32_t col = -1U;
 };
 
 class value;
+using value_list = shared_list<value>; //!< Type alias for a list of values (with structurally shared storage).
+using mat4_array = shared_list<glm::mat4>; //!< Type alias for a packed list of matrices.
+using vec3_array = shared_list<glm::vec3>; //!< Type alias for a packed list of vectors.
+using float_array = shared_list<float>; //!< Type alias for a packed list of floats.
 
 /**
  * @brief Structure representing a pair of values.
  *
- * Due to cyclical dependencies, the two values are stored as pointers (on the heap).
+ * Due to cyclical dependencies, the two values are stored on the heap. Both are kept in a single, immutable, shared
+ * node, so copying a pair never copies the values themselves.
  */
 class value_pair {
 public:
@@ -83,11 +146,6 @@ public:
    * @param second The second value.
    */
   value_pair(value &&first, value &&second);
-  value_pair(const value_pair &other);
-  value_pair(value_pair &&other) noexcept;
-
-  value_pair &operator=(const value_pair &other);
-  value_pair &operator=(value_pair &&other) noexcept;
 
   /**
    * @brief Gets the first and second values.
@@ -99,25 +157,52 @@ public:
    * @brief Gets a reference to the first value.
    * @return The first value.
    */
-  [[nodiscard]] value &first() const;
+  [[nodiscard]] const value &first() const;
 
   /**
    * @brief Gets a reference to the second value.
    * @return The second value.
    */
-  [[nodiscard]] value &second() const;
+  [[nodiscard]] const value &second() const;
 
   [[nodiscard]] bool operator==(const value_pair &other) const;
 
-  ~value_pair();
 private:
-  value *_first = nullptr;
-  value *_second = nullptr;
+  std::shared_ptr<const std::pair<value, value>> data;
 };
 
 using voxel_corner = std::tuple<glm::vec3, glm::vec3, float>; //!< Type alias for a voxel corner `(glm::vec3, glm::vec3, float)`.
 using voxel_desc = std::array<voxel_corner, 9>; //!< Type alias for a voxel description (`std::array<voxel_corner, 9>`).
 
+/**
+ * @brief Type trait describing how a valid value type is stored inside a `value`.
+ * @tparam T The value type.
+ *
+ * Most types are stored inline. Types that are much larger than the others are stored behind a shared (immutable)
+ * pointer instead, so they don't inflate the size of every value.
+ */
+template <typename T> struct value_storage {
+  using type = T; //!< The stored type.
+  constexpr static bool boxed = false; //!< Whether the type is stored behind a pointer.
+};
+template <> struct value_storage<voxel_desc> {
+  using type = std::shared_ptr<const voxel_desc>;
+  constexpr static bool boxed = true;
+};
+
+/**
+ * @brief Helper alias for the stored type of a value type.
+ * @tparam T The value type.
+ */
+template <typename T> using value_storage_t = typename value_storage<T>::type;
+
+/**
+ * @brief Reverse of `value_storage`: maps a stored type back onto its value type.
+ * @tparam S The stored type.
+ */
+template <typename S> struct value_unboxed { using type = S; };
+template <typename T> struct value_unboxed<std::shared_ptr<const T>> { using type = T; };
+
 /**
  * @brief Concept representing a valid value type.
  */
@@ -129,7 +214,14 @@ concept valid_value = std::same_as<T, bool> || std::same_as<T, int> || std::same
   std::same_as<T, renderer::instanced_collider_ref> || std::same_as<T, renderer::render_ref> ||
   std::same_as<T, renderer::instanced_render_ref> || std::same_as<T, value_pair> ||
   std::same_as<T, voxel_corner> || std::same_as<T, voxel_desc> ||
-  std::same_as<T, std::vector<value>> || std::same_as<T, std::monostate>;
+  std::same_as<T, value_list> || std::same_as<T, mat4_array> || std::same_as<T, vec3_array> ||
+  std::same_as<T, float_array> || std::same_as<T, std::monostate>;
+
+/**
+ * @brief Concept representing a packed (homogeneous, unboxed) list type.
+ */
+template <typename T>
+concept packed_array = std::same_as<T, mat4_array> || std::same_as<T, vec3_array> || std::same_as<T, float_array>;
 
 /**
  * @brief Gets a string representation of the type of the value.
@@ -155,7 +247,10 @@ constexpr std::string type_name() {
   if constexpr(std::same_as<T, value_pair>) return "pair";
   if constexpr(std::same_as<T, voxel_corner>) return "voxel_corner";
   if constexpr(std::same_as<T, voxel_desc>) return "voxel_desc";
-  if constexpr(std::same_as<T, std::vector<value>>) return "list";
+  if constexpr(std::same_as<T, value_list>) return "list";
+  if constexpr(std::same_as<T, mat4_array>) return "mat4[]";
+  if constexpr(std::same_as<T, vec3_array>) return "vec3[]";
+  if constexpr(std::same_as<T, float_array>) return "float[]";
   if constexpr(std::same_as<T, std::monostate>) return "void";
   OPENVTT_UNREACHABLE;
 }
@@ -173,7 +268,8 @@ constexpr std::string type_name() {
  * `renderer::instanced_render_ref` types from the renderer,
  * - `pair` (a pair of two values),
  * - `voxel_corner` and `voxel_desc` types for voxels,
- * - `std::vector<value>` for lists of values,
+ * - `value_list` for lists of values (copying a list is O(1), see `shared_list`),
+ * - `mat4_array`, `vec3_array`, `float_array` for packed lists (lists where all elements have the same type),
  * - `std::monostate` as `void` alias (representing no value).
  */
 class value {
@@ -184,13 +280,13 @@ public:
   constexpr value() = default;
 
   /**
-   * @brief Copies a concrete value into a new value.
+   * @brief Moves a concrete value into a new value.
    * @tparam T The type of the value.
-   * @param x The value to copy.
+   * @param x The value to store.
    * @param at The location of the value.
    */
   template <valid_value T>
-  constexpr explicit value(T x, loc at) : x{x}, generated{std::move(at)} {}
+  constexpr explicit value(T x, const loc at) : x{store(std::move(x))}, generated{at} {}
 
   /**
    * @brief Force-casts a value to a given type.
@@ -198,13 +294,18 @@ public:
    * @return The cast value.
    */
   template <valid_value T>
-  constexpr const T &as() const { return std::get<T>(x); }
+  constexpr const T &as() const {
+    if constexpr (value_storage<T>::boxed) return *std::get<value_storage_t<T>>(x);
+    else return std::get<T>(x);
+  }
   /**
    * @brief Force-casts a value to a given type.
    * @tparam T The type to cast to.
    * @return The cast value.
+   *
+   * Boxed types are immutable, so they can only be accessed through the `const` overload.
    */
-  template <valid_value T>
+  template <valid_value T> requires(!value_storage<T>::boxed)
   constexpr T &as() { return std::get<T>(x); }
 
   /**
@@ -215,7 +316,62 @@ public:
    * If the contained value (`std::variant`) would be `valueless_by_exception`, this function returns `false`.
    */
   template <valid_value T>
-  [[nodiscard]] inline bool is() const { return !x.valueless_by_exception() && std::holds_alternative<T>(x); }
+  [[nodiscard]] inline bool is() const { return !x.valueless_by_exception() && std::holds_alternative<value_storage_t<T>>(x); }
+
+  /**
+   * @brief Creates a list value from a set of elements.
+   * @param elems The elements.
+   * @param at The location of the list.
+   * @return The list value.
+   *
+   * If all elements are `mat4`, `vec3` or `float` values, the list is packed (see `mat4_array`, `vec3_array` and
+   * `float_array`); otherwise (or if there are no elements), a `value_list` is created.
+   */
+  static value make_list(std::vector<value> &&elems, const loc &at) {
+    if (!elems.empty()) {
+      if (all_of<glm::mat4>(elems)) return value{pack<glm::mat4>(elems), at};
+      if (all_of<glm::vec3>(elems)) return value{pack<glm::vec3>(elems), at};
+      if (all_of<float>(elems)) return value{pack<float>(elems), at};
+    }
+    return value{value_list{std::move(elems)}, at};
+  }
+
+  /**
+   * @brief Checks if the value is a list (either a `value_list` or a packed list).
+   * @return `true` if the value is a list, `false` otherwise.
+   */
+  [[nodiscard]] bool is_list() const {
+    return is<value_list>() || is<mat4_array>() || is<vec3_array>() || is<float_array>();
+  }
+
+  /**
+   * @brief Gets the value as a `value_list`, boxing the elements of packed lists.
+   * @return The list, or an empty list if the value is not a list.
+   *
+   * For a `value_list`, this is O(1). Elements of a packed list don't carry their own location, so the boxed elements
+   * get the location of the list itself.
+   */
+  [[nodiscard]] value_list as_list() const {
+    if (is<value_list>()) return as<value_list>();
+    if (is<mat4_array>()) return box(as<mat4_array>());
+    if (is<vec3_array>()) return box(as<vec3_array>());
+    if (is<float_array>()) return box(as<float_array>());
+    return value_list{};
+  }
+
+  /**
+   * @brief Applies a visitor to the value.
+   * @tparam F The type of the visitor.
+   * @param f The visitor to apply.
+   * @return The return value of the visitor.
+   */
+  template <typename F>
+  constexpr auto visit(F &&f) {
+    return std::visit([&f]<typename S>(S &s) -> decltype(auto) {
+      if constexpr (value_storage<typename value_unboxed<S>::type>::boxed) return f(*s);
+      else return f(s);
+    }, x);
+  }
 
   /**
    * @brief Applies a visitor to the value.
@@ -224,7 +380,12 @@ public:
    * @return The return value of the visitor.
    */
   template <typename F>
-  constexpr auto visit(F &&f) { return std::visit(f, x); }
+  constexpr auto visit(F &&f) const {
+    return std::visit([&f]<typename S>(const S &s) -> decltype(auto) {
+      if constexpr (value_storage<typename value_unboxed<S>::type>::boxed) return f(*s);
+      else return f(s);
+    }, x);
+  }
 
   /**
    * @brief Gets a string representation of the type of the value.
@@ -234,7 +395,7 @@ public:
     if (x.valueless_by_exception()) {
       return "(invalid type; no value)";
     }
-    return std::visit([]<typename T>(const T &){ return map::type_name<T>(); }, x);
+    return visit([]<typename T>(const T &){ return map::type_name<T>(); });
   }
 
   template <valid_value T>
@@ -376,6 +537,8 @@ public:
    * If both values are `int` or `float`, addition is performed.
    * If this value is a list, and the other value is also a list, the lists are concatenated.
    * If this value is a list, and the other one isn't, the other value is appended to the list.
+   * Packed lists stay packed as long as the appended values have the same element type (and appending to an empty
+   * list starts a packed list if possible); otherwise, the result is a `value_list`.
    * If this value is a string, the other value is appended to the string.
    * Otherwise, the operation is invalid, and an error message is logged.
    */
@@ -384,19 +547,7 @@ public:
       [this](const int x, const int y) { return value{x + y, generated}; },
       [this](const float x, const float y) { return value{x + y, generated}; },
       [this, &other] {
-        if (is<std::vector<value>>()) {
-          const auto &v = as<std::vector<value>>();
-          if (other.is<std::vector<value>>()) {
-            const auto &ov = other.as<std::vector<value>>();
-            std::vector res{v};
-            res.insert(res.end(), ov.begin(), ov.end());
-            return value{res, generated};
-          }
-
-          std::vector res{v};
-          res.push_back(other);
-          return value{res, generated};
-        }
+        if (is_list()) return list_append(other);
 
         if (is<std::string>()) {
           return value{as<std::string>() + static_cast<std::string>(other), generated};
@@ -434,7 +585,7 @@ public:
    * Equality is only defined for two values of the same type, including integer-to-float promotion.
    */
   value operator==(const value &other) const {
-    return std::visit(
+    return visit(
       [this, &other]<typename T>(const T &x) -> value {
         if (other.is<T>()) {
           return value{x == other.as<T>(), generated};
@@ -447,10 +598,10 @@ public:
           if (other.is<float>())
             return value{static_cast<float>(x) == other.as<float>(), generated};
         }
+        if (is_list() && other.is_list()) return value{as_list() == other.as_list(), generated};
         log_operand_mismatch("==", other);
         return value{false, generated};
-      },
-      x
+      }
     );
   }
 
@@ -462,7 +613,7 @@ public:
    * Inequality is only defined for two values of the same type, including integer-to-float promotion.
    */
   value operator!=(const value &other) const {
-    return std::visit(
+    return visit(
       [this, &other]<typename T>(const T &x) -> value {
         if (other.is<T>()) {
           return value{x != other.as<T>(), generated};
@@ -475,10 +626,10 @@ public:
           if (other.is<float>())
             return value{static_cast<float>(x) != other.as<float>(), generated};
         }
+        if (is_list() && other.is_list()) return value{!(as_list() == other.as_list()), generated};
         log_operand_mismatch("!=", other);
         return value{false, generated};
-      },
-      x
+      }
     );
   }
 
@@ -556,7 +707,7 @@ public:
 
   /**
    * @deprecated Should not be used (only for STL compliance).
-   * @brief Operator implemented to support `operator==` on `std::vector<value>`.
+   * @brief Operator implemented to support `operator==` on `value_list`.
    */
   bool operator!() const {
     // NOT MEANT FOR ACTUAL USE!
@@ -610,8 +761,8 @@ public:
     if (is<value_pair>()) {
       return std::format("({}, {})", static_cast<std::string>(as<value_pair>().first()), static_cast<std::string>(as<value_pair>().second()));
     }
-    if (is<std::vector<value>>()) {
-      const auto &v = as<std::vector<value>>();
+    if (is_list()) {
+      const auto v = as_list();
       if (v.empty()) return "[]";
 
       std::stringstream strm;
@@ -640,10 +791,62 @@ private:
     bool, int, float, std::string, glm::vec3, glm::mat4,
     renderer::object_ref, renderer::instanced_object_ref, renderer::shader_ref, renderer::texture_ref,
     renderer::collider_ref, renderer::instanced_collider_ref, renderer::render_ref, renderer::instanced_render_ref,
-    voxel_corner, voxel_desc,
-    value_pair, std::vector<value>, std::monostate
+    voxel_corner, value_storage_t<voxel_desc>,
+    value_pair, value_list, mat4_array, vec3_array, float_array, std::monostate
   >;
 
+  template <typename T>
+  static bool all_of(const std::vector<value> &elems) {
+    return std::ranges::all_of(elems, [](const value &v) { return v.is<T>(); });
+  }
+
+  template <typename T>
+  static shared_list<T> pack(const std::vector<value> &elems) {
+    std::vector<T> res;
+    res.reserve(elems.size());
+    for (const auto &v : elems) res.push_back(v.as<T>());
+    return shared_list<T>{std::move(res)};
+  }
+
+  template <typename T>
+  value_list box(const shared_list<T> &elems) const {
+    std::vector<value> res;
+    res.reserve(elems.size());
+    for (const auto &x : elems) res.emplace_back(x, generated);
+    return value_list{std::move(res)};
+  }
+
+  template <typename T>
+  std::optional<value> append_packed(const value &other) const {
+    if (!is<shared_list<T>>()) return std::nullopt;
+    const auto &v = as<shared_list<T>>();
+    if (other.is<T>()) return value{v.append(other.as<T>()), generated};
+    if (other.is<shared_list<T>>()) return value{v.concat(other.as<shared_list<T>>()), generated};
+    if (other.is<value_list>() && other.as<value_list>().empty()) return *this;
+    return std::nullopt;
+  }
+
+  value list_append(const value &other) const {
+    if (auto res = append_packed<glm::mat4>(other); res.has_value()) return *res;
+    if (auto res = append_packed<glm::vec3>(other); res.has_value()) return *res;
+    if (auto res = append_packed<float>(other); res.has_value()) return *res;
+
+    if (is<value_list>() && as<value_list>().empty()) {
+      if (other.is_list()) return value{other}.relocate(generated);
+      return make_list({other}, generated);
+    }
+
+    // mixed element types: fall back to boxed values
+    if (other.is_list()) return value{as_list().concat(other.as_list()), generated};
+    return value{as_list().append(other), generated};
+  }
+
+  template <valid_value T>
+  static constexpr value_storage_t<T> store(T &&x) {
+    if constexpr (value_storage<T>::boxed) return std::make_shared<const T>(std::move(x));
+    else return std::move(x);
+  }
+
   template <std::invocable<int, int> F1, std::invocable<float, float> F2, std::invocable<> FE>
   requires(std::same_as<std::invoke_result_t<F1, int, int>, std::invoke_result_t<F2, float, float>> &&
     std::same_as<std::invoke_result_t<F2, float, float>, std::invoke_result_t<FE>>
@@ -700,7 +903,10 @@ template <> struct default_value<renderer::instanced_render_ref> { static conste
 template <> struct default_value<value_pair> { static inline value_pair value{}; };
 template <> struct default_value<voxel_corner> { static constexpr voxel_corner value{}; };
 template <> struct default_value<voxel_desc> { static constexpr voxel_desc value{}; };
-template <> struct default_value<std::vector<value>> { static constexpr std::vector<openvtt::map::value> value{}; };
+template <> struct default_value<value_list> { static inline value_list value{}; };
+template <> struct default_value<mat4_array> { static inline mat4_array value{}; };
+template <> struct default_value<vec3_array> { static inline vec3_array value{}; };
+template <> struct default_value<float_array> { static inline float_array value{}; };
 template <> struct default_value<std::monostate> { static constexpr std::monostate value{}; };
 
 /**
@@ -724,21 +930,144 @@ T value::should_be() const {
   return expecting<T>().value_or(default_value_v<T>);
 }
 
+/**
+ * @brief The maximal amount of elements in a range (`[from .. to]`, also in comprehensions).
+ *
+ * Larger ranges are reported as errors, and evaluate to an empty list (instead of exhausting memory).
+ */
+constexpr int64_t max_range_length = int64_t{1} << 24;
+/**
+ * @brief The maximal amount of elements reserved up front when building a range (larger ranges grow as they're built).
+ */
+constexpr size_t max_range_reserve = 4096;
+
+/**
+ * @brief Computes the amount of elements in a range, reporting ranges that are too large (see `max_range_length`).
+ * @param from The start of the range (inclusive).
+ * @param to The end of the range (exclusive).
+ * @param at The location of the range.
+ * @return The amount of elements in the range; 0 if it is empty, or too large.
+ */
+inline int64_t range_length(const int from, const int to, const loc &at) {
+  const int64_t len = static_cast<int64_t>(to) - from;
+  if (len > max_range_length) {
+    renderer::log<renderer::log_type::ERROR>("object_cache", std::format(
+      "Range [{} .. {}] at {} has {} elements; at most {} are allowed", from, to, at.str(), len, max_range_length
+    ));
+    return 0;
+  }
+  return std::max(len, int64_t{0});
+}
+
+/**
+ * @brief Helper class to build a list value one element at a time.
+ *
+ * The builder follows the same packing rules as `value::make_list`, but stores elements unboxed while they all have
+ * the same packable type (`mat4`, `vec3` or `float`). Only when an element of another type is pushed, the elements
+ * gathered so far are boxed into values.
+ */
+class list_builder {
+public:
+  /**
+   * @brief Creates an empty builder.
+   * @param at The location of the list (also used for boxed elements, as with `value::as_list`).
+   * @param expected The amount of elements that are expected to be pushed (only used to reserve storage).
+   */
+  explicit list_builder(const loc &at, const size_t expected = 0) : at{at}, expected{expected} {}
+
+  /**
+   * @brief Pushes an element to the back of the list.
+   * @param v The element.
+   */
+  void push(value &&v) {
+    if (std::holds_alternative<std::monostate>(items)) {
+      if (v.is<glm::mat4>()) start<glm::mat4>();
+      else if (v.is<glm::vec3>()) start<glm::vec3>();
+      else if (v.is<float>()) start<float>();
+      else start<value>();
+    }
+
+    if (push_packed<glm::mat4>(v) || push_packed<glm::vec3>(v) || push_packed<float>(v)) return;
+    if (!std::holds_alternative<std::vector<value>>(items)) box();
+    std::get<std::vector<value>>(items).push_back(std::move(v));
+  }
+
+  /**
+   * @brief Finishes the list (the builder is left empty).
+   * @return The list value.
+   */
+  value finish() {
+    auto res = std::visit([this]<typename V>(V &elems) -> value {
+      if constexpr (std::same_as<V, std::monostate>) return value{value_list{}, at};
+      else if constexpr (std::same_as<V, std::vector<value>>) return value{value_list{std::move(elems)}, at};
+      else return value{shared_list<typename V::value_type>{std::move(elems)}, at};
+    }, items);
+    items = std::monostate{};
+    return res;
+  }
+
+private:
+  template <typename T>
+  void start() {
+    auto &elems = items.emplace<std::vector<T>>();
+    elems.reserve(expected);
+  }
+
+  template <typename T>
+  bool push_packed(const value &v) {
+    if (auto *elems = std::get_if<std::vector<T>>(&items); elems != nullptr && v.is<T>()) {
+      elems->push_back(v.as<T>());
+      return true;
+    }
+    return false;
+  }
+
+  void box() {
+    std::vector<value> boxed;
+    boxed.reserve(expected);
+    std::visit([this, &boxed]<typename V>(const V &elems) {
+      if constexpr (!std::same_as<V, std::monostate> && !std::same_as<V, std::vector<value>>) {
+        for (const auto &x : elems) boxed.emplace_back(x, at);
+      }
+    }, items);
+    items = std::move(boxed);
+  }
+
+  std::variant<std::monostate, std::vector<glm::mat4>, std::vector<glm::vec3>, std::vector<float>, std::vector<value>> items;
+  loc at;
+  size_t expected;
+};
+
 /**
  * @brief A class representing an object cache.
  *
  * The object caches store variables and values that are used in the map script.
+ * Variables live in slots. The bytecode interpreter addresses slots directly (the slot of each variable is resolved
+ * at compile time), while the tree-walking visitor uses the name-based API, which maps each name onto a slot.
  */
 class object_cache {
 public:
+  /**
+   * @brief Creates an empty cache.
+   */
+  object_cache() = default;
+
+  /**
+   * @brief Creates a cache with a fixed amount of (undeclared) slots.
+   * @param slots The amount of slots.
+   */
+  explicit object_cache(const size_t slots) : vars(slots) {}
+
   /**
    * @brief Attempts to look up a variable in the cache (without error message).
    * @param name The name of the variable.
    * @return The value of the variable, or `std::nullopt` if the variable does not exist.
    */
   std::optional<value> lookup_var_maybe(const std::string &name) const {
-    const auto it = ctx.find(name);
-    return it == ctx.end() ? std::nullopt : std::optional{it->second.val};
+    const auto it = names.find(name);
+    if (it == names.end()) return std::nullopt;
+    const auto *v = slot_maybe(it->second);
+    return v == nullptr ? std::nullopt : std::optional{*v};
   }
 
   /**
@@ -802,27 +1131,9 @@ public:
    */
   template <valid_value T>
   void assign(const std::string &name, T val, const loc &at, const bool is_mut = true) {
-    if (const auto it = ctx.find(name); it != ctx.end()) {
-      if (const auto &[old, declared, mut] = it->second; old.is<T>()) {
-        if (!mut) {
-          renderer::log<renderer::log_type::ERROR>("object_cache",
-            std::format("Variable {} is immutable, cannot assign at {}", name, at.str())
-          );
-          return;
-        }
-        ctx[name] = {value{std::move(val), at}, at, mut};
-      }
-      else {
-        renderer::log<renderer::log_type::ERROR>("object_cache",
-          std::format("Variable {} is of type {}, but got assigned {} at {}",
-            name, old.type_name(), type_name<T>(), at.str()
-          )
-        );
-      }
-    }
-    else {
-      ctx[name] = {value{std::forward<T>(val), at}, at, is_mut};
-    }
+    const auto [it, inserted] = names.try_emplace(name, static_cast<uint32_t>(vars.size()));
+    if (inserted) vars.emplace_back();
+    assign_slot(it->second, name, std::move(val), at, is_mut);
   }
 
   /**
@@ -835,12 +1146,78 @@ public:
    * This function is a wrapper around `assign` that forwards the value to the correct overload.
    */
   void assign(const std::string &name, value &&val, const loc &at, const bool is_mut = true) {
-    val.visit([this, &name, &at, is_mut]<typename T>(T &&t) { assign(name, t, at, is_mut); });
+    val.visit([this, &name, &at, is_mut]<typename T>(T &&t) { assign(name, std::move(t), at, is_mut); });
+  }
+
+  /**
+   * @brief Looks up the value in a slot.
+   * @param slot The slot index.
+   * @return A pointer to the value in the slot, or `nullptr` if no variable was declared in the slot (yet).
+   *
+   * The pointer remains valid until the next assignment to this cache.
+   */
+  [[nodiscard]] const value *slot_maybe(const uint32_t slot) const {
+    return slot < vars.size() && vars[slot].is_declared ? &vars[slot].val : nullptr;
+  }
+
+  /**
+   * @brief Attempts to assign to the variable in a slot.
+   * @tparam T The type of the value to assign.
+   * @param slot The slot index.
+   * @param name The name of the variable (for error messages).
+   * @param val The value to assign.
+   * @param at The location where the assignment is made.
+   * @param is_mut Whether the variable is mutable.
+   *
+   * This function follows the same rules as `assign`: the first assignment declares the variable, later assignments
+   * only succeed if the variable is mutable and the types match. All list types (packed or not) count as the same type.
+   */
+  template <valid_value T>
+  void assign_slot(const uint32_t slot, const std::string &name, T val, const loc &at, const bool is_mut = true) {
+    if (slot >= vars.size()) vars.resize(slot + 1);
+    auto &[old, declared, mut, is_declared] = vars[slot];
+    if (!is_declared) {
+      vars[slot] = {value{std::move(val), at}, at, is_mut, true};
+      return;
+    }
+
+    constexpr bool is_list = std::same_as<T, value_list> || packed_array<T>;
+    if (!old.is<T>() && !(is_list && old.is_list())) {
+      renderer::log<renderer::log_type::ERROR>("object_cache",
+        std::format("Variable {} is of type {}, but got assigned {} at {}",
+          name, old.type_name(), type_name<T>(), at.str()
+        )
+      );
+      return;
+    }
+    if (!mut) {
+      renderer::log<renderer::log_type::ERROR>("object_cache",
+        std::format("Variable {} is immutable, cannot assign at {}", name, at.str())
+      );
+      return;
+    }
+    old = value{std::move(val), at};
+    declared = at;
+  }
+
+  /**
+   * @brief Attempts to assign to the variable in a slot.
+   * @param slot The slot index.
+   * @param name The name of the variable (for error messages).
+   * @param val The value to assign.
+   * @param at The location where the assignment is made.
+   * @param is_mut Whether the variable is mutable.
+   *
+   * This function is a wrapper around `assign_slot` that forwards the value to the correct overload.
+   */
+  void assign_slot(const uint32_t slot, const std::string &name, value &&val, const loc &at, const bool is_mut = true) {
+    val.visit([this, slot, &name, &at, is_mut]<typename T>(T &&t) { assign_slot(slot, name, std::move(t), at, is_mut); });
   }
 
 private:
-  struct var { value val; loc declared; bool is_mut; };
-  std::unordered_map<std::string, var> ctx;
+  struct var { value val; loc declared; bool is_mut = true; bool is_declared = false; };
+  std::unordered_map<std::string, uint32_t> names;
+  std::vector<var> vars;
 };
 }
 
@@ -0,0 +1,345 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <cstring>
+#include <fstream>
+
+#include "program_cache.hpp"
+#include "filesys.hpp"
+#include "map_state.hpp"
+#include "renderer/log_view.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+
+namespace {
+constexpr char magic[4] = {'O', 'V', 'M', 'C'};
+
+/**
+ * @brief Tags for the value types that can be stored in a cache file.
+ */
+enum struct value_tag : uint8_t { BOOL, INT, FLOAT, STRING, VEC3, MAT4, PAIR, LIST, VOID, MAT4_ARRAY, VEC3_ARRAY, FLOAT_ARRAY };
+
+/**
+ * @brief Helper to serialize a program.
+ *
+ * File names are interned while writing the body, and emitted as a table in front of it.
+ */
+struct writer {
+  std::vector<std::byte> body;
+  std::vector<std::string> files;
+  std::unordered_map<uint32_t, uint32_t> file_idx; //!< interned ID -> index in `files`
+
+  template <typename T> requires(std::is_trivially_copyable_v<T>)
+  void put(const T &x) {
+    const auto *ptr = reinterpret_cast<const std::byte *>(&x);
+    body.insert(body.end(), ptr, ptr + sizeof(T));
+  }
+
+  void put_string(const std::string &s) {
+    put(static_cast<uint32_t>(s.size()));
+    const auto *ptr = reinterpret_cast<const std::byte *>(s.data());
+    body.insert(body.end(), ptr, ptr + s.size());
+  }
+
+  void put_loc(const loc &l) {
+    const auto [it, _] = file_idx.try_emplace(l.file(), static_cast<uint32_t>(files.size()));
+    if (it->second == files.size()) files.push_back(l.file_name());
+    put(it->second);
+    put(static_cast<uint32_t>(l.line_number()));
+    put(static_cast<uint32_t>(l.column_number()));
+  }
+
+  template <typename T>
+  void put_array(const shared_list<T> &xs) {
+    put(static_cast<uint32_t>(xs.size()));
+    const auto bytes = std::as_bytes(xs.span());
+    body.insert(body.end(), bytes.begin(), bytes.end());
+  }
+
+  bool put_value(const value &v) {
+    if (v.is<bool>()) { put(value_tag::BOOL); put(v.as<bool>()); }
+    else if (v.is<int>()) { put(value_tag::INT); put(v.as<int>()); }
+    else if (v.is<float>()) { put(value_tag::FLOAT); put(v.as<float>()); }
+    else if (v.is<std::string>()) { put(value_tag::STRING); put_string(v.as<std::string>()); }
+    else if (v.is<glm::vec3>()) { put(value_tag::VEC3); put(v.as<glm::vec3>()); }
+    else if (v.is<glm::mat4>()) { put(value_tag::MAT4); put(v.as<glm::mat4>()); }
+    else if (v.is<value_pair>()) {
+      put(value_tag::PAIR);
+      if (!put_value(v.as<value_pair>().first()) || !put_value(v.as<value_pair>().second())) return false;
+    }
+    else if (v.is<value_list>()) {
+      const auto &list = v.as<value_list>();
+      put(value_tag::LIST);
+      put(static_cast<uint32_t>(list.size()));
+      for (const auto &x : list) if (!put_value(x)) return false;
+    }
+    else if (v.is<mat4_array>()) { put(value_tag::MAT4_ARRAY); put_array(v.as<mat4_array>()); }
+    else if (v.is<vec3_array>()) { put(value_tag::VEC3_ARRAY); put_array(v.as<vec3_array>()); }
+    else if (v.is<float_array>()) { put(value_tag::FLOAT_ARRAY); put_array(v.as<float_array>()); }
+    else if (v.is<std::monostate>()) { put(value_tag::VOID); }
+    else return false; // references to loaded assets can't be cached
+    put_loc(v.pos());
+    return true;
+  }
+
+  bool write(const program &prog) {
+    put(static_cast<uint32_t>(prog.names.size()));
+    for (const auto &n : prog.names) put_string(n);
+    put(static_cast<uint32_t>(prog.locs.size()));
+    for (const auto &l : prog.locs) put_loc(l);
+    put(static_cast<uint32_t>(prog.constants.size()));
+    for (const auto &c : prog.constants) if (!put_value(c)) return false;
+    put(static_cast<uint32_t>(prog.code.size()));
+    for (const auto &[op, arg, arg2, at] : prog.code) {
+      put(op); put(arg); put(arg2); put(at);
+    }
+    put(static_cast<uint32_t>(prog.frames.size()));
+    for (const auto &[slot_names] : prog.frames) {
+      put(static_cast<uint32_t>(slot_names.size()));
+      for (const auto n : slot_names) put(n);
+    }
+    return true;
+  }
+};
+
+/**
+ * @brief Helper to deserialize a program from a (memory-mapped) buffer.
+ *
+ * All reads are bounds-checked; any failure makes the whole cache file invalid.
+ */
+struct reader {
+  std::span<const std::byte> data;
+  size_t offset = 0;
+  std::vector<uint32_t> files{}; //!< interned IDs of the file table
+
+  template <typename T> requires(std::is_trivially_copyable_v<T>)
+  bool get(T &x) {
+    if (data.size() - offset < sizeof(T)) return false;
+    std::memcpy(&x, data.data() + offset, sizeof(T));
+    offset += sizeof(T);
+    return true;
+  }
+
+  bool get_string(std::string &s) {
+    uint32_t len;
+    if (!get(len) || data.size() - offset < len) return false;
+    s.assign(reinterpret_cast<const char *>(data.data() + offset), len);
+    offset += len;
+    return true;
+  }
+
+  std::optional<loc> get_loc() {
+    uint32_t file, line, col;
+    if (!get(file) || !get(line) || !get(col) || file >= files.size()) return std::nullopt;
+    return loc{files[file], line, col};
+  }
+
+  template <valid_value T>
+  std::optional<value> with_loc(T &&x) {
+    const auto l = get_loc();
+    if (!l.has_value()) return std::nullopt;
+    return value{std::forward<T>(x), *l};
+  }
+
+  template <typename T>
+  std::optional<value> get_plain() {
+    T x;
+    if (!get(x)) return std::nullopt;
+    return with_loc(std::move(x));
+  }
+
+  template <typename T>
+  std::optional<value> get_array() {
+    uint32_t size;
+    if (!get(size) || (data.size() - offset) / sizeof(T) < size) return std::nullopt;
+    std::vector<T> xs(size);
+    std::memcpy(xs.data(), data.data() + offset, size * sizeof(T));
+    offset += size * sizeof(T);
+    return with_loc(shared_list<T>{std::move(xs)});
+  }
+
+  std::optional<value> get_value() {
+    value_tag tag;
+    if (!get(tag)) return std::nullopt;
+    switch (tag) {
+      case value_tag::BOOL: {
+        // any byte but 0 and 1 is not a valid bool (and copying it into one is undefined)
+        uint8_t b;
+        if (!get(b) || b > 1) return std::nullopt;
+        return with_loc(b == 1);
+      }
+      case value_tag::INT: return get_plain<int>();
+      case value_tag::FLOAT: return get_plain<float>();
+      case value_tag::VEC3: return get_plain<glm::vec3>();
+      case value_tag::MAT4: return get_plain<glm::mat4>();
+      case value_tag::STRING: {
+        std::string s;
+        if (!get_string(s)) return std::nullopt;
+        return with_loc(std::move(s));
+      }
+      case value_tag::PAIR: {
+        auto x = get_value();
+        if (!x.has_value()) return std::nullopt;
+        auto y = get_value();
+        if (!y.has_value()) return std::nullopt;
+        return with_loc(value_pair{std::move(*x), std::move(*y)});
+      }
+      case value_tag::LIST: {
+        uint32_t size;
+        if (!get(size)) return std::nullopt;
+        std::vector<value> list;
+        list.reserve(size);
+        for (uint32_t i = 0; i < size; i++) {
+          auto x = get_value();
+          if (!x.has_value()) return std::nullopt;
+          list.push_back(std::move(*x));
+        }
+        return with_loc(value_list{std::move(list)});
+      }
+      case value_tag::VOID: return with_loc(std::monostate{});
+      case value_tag::MAT4_ARRAY: return get_array<glm::mat4>();
+      case value_tag::VEC3_ARRAY: return get_array<glm::vec3>();
+      case value_tag::FLOAT_ARRAY: return get_array<float>();
+    }
+    return std::nullopt;
+  }
+
+  /**
+   * @brief Checks that no loop jumps into or out of a scope or context (which `resolve_slots` can't follow).
+   * @param prog The program that was read.
+   * @return `true` if every loop stays in the scope (or context) it starts in.
+   */
+  static bool loops_stay_in_scope(const program &prog) {
+    std::vector<uint32_t> scope_of(prog.code.size()); // 1-based index of the scope each instruction runs in (0 = none)
+    std::vector<uint32_t> open{0};
+    uint32_t scopes = 0;
+    for (size_t pc = 0; pc < prog.code.size(); pc++) {
+      const auto op = prog.code[pc].op;
+      if (op == opcode::BEGIN_SCOPE || op == opcode::PUSH_CONTEXT) open.push_back(++scopes);
+      scope_of[pc] = open.back();
+      if ((op == opcode::END_SCOPE || op == opcode::POP_CONTEXT) && open.size() > 1) open.pop_back();
+    }
+
+    for (size_t pc = 0; pc < prog.code.size(); pc++) {
+      const auto &[op, arg, arg2, at] = prog.code[pc];
+      if ((op == opcode::LOOP_BEGIN || op == opcode::LOOP_END) && arg < prog.code.size() && scope_of[arg] != scope_of[pc])
+        return false;
+    }
+    return true;
+  }
+
+  std::optional<program> read() {
+    uint32_t count;
+    if (!get(count)) return std::nullopt;
+    files.resize(count);
+    for (auto &f : files) {
+      std::string name;
+      if (!get_string(name)) return std::nullopt;
+      f = loc::intern(name);
+    }
+
+    program prog;
+    if (!get(count)) return std::nullopt;
+    prog.names.resize(count);
+    for (auto &n : prog.names) if (!get_string(n)) return std::nullopt;
+
+    if (!get(count)) return std::nullopt;
+    prog.locs.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      auto l = get_loc();
+      if (!l.has_value()) return std::nullopt;
+      prog.locs.push_back(std::move(*l));
+    }
+
+    if (!get(count)) return std::nullopt;
+    prog.constants.reserve(count);
+    for (uint32_t i = 0; i < count; i++) {
+      auto v = get_value();
+      if (!v.has_value()) return std::nullopt;
+      prog.constants.push_back(std::move(*v));
+    }
+
+    if (!get(count)) return std::nullopt;
+    prog.code.resize(count);
+    for (auto &[op, arg, arg2, at] : prog.code) {
+      if (!get(op) || !get(arg) || !get(arg2) || !get(at)) return std::nullopt;
+      if (at >= prog.locs.size() || op > opcode::LOOP_END) return std::nullopt;
+      if (op == opcode::PUSH_CONST && arg >= prog.constants.size()) return std::nullopt;
+      if ((op == opcode::LOOP_BEGIN || op == opcode::LOOP_END) && arg > count) return std::nullopt;
+      if ((op == opcode::LOAD_NAME || op == opcode::STORE_NAME || op == opcode::DECLARE_NAME || op == opcode::UNDEFINED ||
+           op == opcode::CALL) && arg >= prog.names.size())
+        return std::nullopt;
+      // programs are stored before slot resolution, so they never hold slot operands (or bound builtins)
+      if (op == opcode::LOAD_SLOT || op == opcode::STORE_SLOT || op == opcode::STORE_SLOT_KEEP) return std::nullopt;
+      if (op == opcode::BEGIN_SCOPE && arg != static_cast<uint32_t>(map_state::scope::VOXEL) &&
+          arg != static_cast<uint32_t>(map_state::scope::OBJECTS))
+        return std::nullopt;
+    }
+
+    // ... nor any frames
+    if (!get(count) || count != 0) return std::nullopt;
+
+    if (offset != data.size() || !loops_stay_in_scope(prog)) return std::nullopt;
+    return prog;
+  }
+};
+}
+
+uint64_t program_cache::key_for(const std::string &path, const std::string_view source) {
+  const std::string version = std::to_string(format_version);
+  return fnv1a(source, fnv1a(path, fnv1a(version)));
+}
+
+std::string program_cache::path_for(const std::string &path) {
+  return path + "c";
+}
+
+std::optional<program> program_cache::load(const std::string &cache_path, const uint64_t key) {
+  const mapped_file file(cache_path);
+  if (!file.is_open()) return std::nullopt;
+
+  reader r{file.bytes()};
+  char m[4];
+  uint32_t version;
+  uint64_t stored_key;
+  if (!r.get(m) || std::memcmp(m, magic, sizeof(magic)) != 0 || !r.get(version) || !r.get(stored_key)) {
+    log<log_type::WARNING>("program_cache", std::format("Ignoring malformed cache file {}", cache_path));
+    return std::nullopt;
+  }
+  if (version != format_version || stored_key != key) {
+    log<log_type::DEBUG>("program_cache", std::format("Cache file {} is out of date", cache_path));
+    return std::nullopt;
+  }
+
+  auto prog = r.read();
+  if (!prog.has_value()) {
+    log<log_type::WARNING>("program_cache", std::format("Ignoring malformed cache file {}", cache_path));
+  }
+  return prog;
+}
+
+bool program_cache::store(const std::string &cache_path, const uint64_t key, const program &prog) {
+  writer w;
+  if (!w.write(prog)) {
+    log<log_type::DEBUG>("program_cache", "Program holds non-cacheable constants; not writing a cache file.");
+    return false;
+  }
+
+  writer header;
+  header.put(magic);
+  header.put(format_version);
+  header.put(key);
+  header.put(static_cast<uint32_t>(w.files.size()));
+  for (const auto &f : w.files) header.put_string(f);
+
+  std::ofstream strm(cache_path, std::ios::binary | std::ios::trunc);
+  if (!strm.is_open()) {
+    log<log_type::DEBUG>("program_cache", std::format("Can't write cache file {}", cache_path));
+    return false;
+  }
+  strm.write(reinterpret_cast<const char *>(header.body.data()), static_cast<std::streamsize>(header.body.size()));
+  strm.write(reinterpret_cast<const char *>(w.body.data()), static_cast<std::streamsize>(w.body.size()));
+  return strm.good();
+}
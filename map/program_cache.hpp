@@ -0,0 +1,83 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef PROGRAM_CACHE_HPP
+#define PROGRAM_CACHE_HPP
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include "map_program.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief Class managing the on-disk cache of compiled map programs.
+ *
+ * Each map file `<name>.ovm` can have a compiled counterpart `<name>.ovmc` next to it. The cached program is only used
+ * if its key matches the key computed for the current source; otherwise it is ignored (and overwritten later).
+ *
+ * The file format is a simple native-endian binary dump: a header (magic, format version, key), followed by the
+ * name, location, constant, code and frame tables. Programs are stored before slot resolution. Only plain-data
+ * values can be stored as constants; programs holding other constants are simply not cached.
+ */
+class program_cache {
+public:
+  /**
+   * @brief The version of the file format. Bump this whenever the format, the bytecode or the optimizations change.
+   */
+  constexpr static uint32_t format_version = 7;
+
+  /**
+   * @brief Computes the 64-bit FNV-1a hash of a string.
+   * @param data The data to hash.
+   * @param seed The initial hash value (to chain multiple hashes).
+   * @return The hash.
+   */
+  constexpr static uint64_t fnv1a(const std::string_view data, uint64_t seed = 0xcbf29ce484222325ULL) {
+    for (const char c : data) {
+      seed ^= static_cast<uint8_t>(c);
+      seed *= 0x100000001b3ULL;
+    }
+    return seed;
+  }
+
+  /**
+   * @brief Computes the cache key for a map source.
+   * @param path The path of the map file (part of the key, as it is embedded in the source locations).
+   * @param source The source code of the map.
+   * @return The cache key.
+   */
+  static uint64_t key_for(const std::string &path, std::string_view source);
+
+  /**
+   * @brief Gets the path of the cache file for a map file.
+   * @param path The path of the map file.
+   * @return The path of the cache file.
+   */
+  static std::string path_for(const std::string &path);
+
+  /**
+   * @brief Attempts to load a program from the cache.
+   * @param cache_path The path of the cache file.
+   * @param key The expected cache key.
+   * @return The cached program, or `std::nullopt` if there is no (valid, up-to-date) cache file.
+   */
+  static std::optional<program> load(const std::string &cache_path, uint64_t key);
+
+  /**
+   * @brief Attempts to store a program in the cache.
+   * @param cache_path The path of the cache file.
+   * @param key The cache key.
+   * @param prog The program to store.
+   * @return `true` if the program was written, `false` otherwise.
+   *
+   * Failing to write a cache file is not an error (the assets directory might be read-only); it is only logged.
+   */
+  static bool store(const std::string &cache_path, uint64_t key, const program &prog);
+};
+}
+
+#endif //PROGRAM_CACHE_HPP
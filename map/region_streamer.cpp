@@ -0,0 +1,102 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include "region_streamer.hpp"
+#include "renderer/log_view.hpp"
+
+using namespace openvtt::map;
+using namespace openvtt::renderer;
+
+namespace {
+/**
+ * @brief Computes the distance between two points, projected on the XZ plane.
+ */
+float distance_xz(const glm::vec3 &a, const glm::vec3 &b) {
+  return glm::length(glm::vec2{a.x - b.x, a.z - b.z});
+}
+}
+
+void region_streamer::reset(const std::vector<map_region> &regions) {
+  bool released = false;
+  for (auto &r : this->regions) {
+    if (r.loaded.has_value()) {
+      release(r);
+      released = true;
+    }
+  }
+  if (released) render_cache::evict_unused();
+
+  this->regions.clear();
+  this->regions.reserve(regions.size());
+  for (const auto &r : regions) this->regions.push_back({r});
+}
+
+bool region_streamer::update(const glm::vec3 &focus) {
+  bool released = false;
+  size_t loaded = 0;
+  region *nearest = nullptr;
+  float nearest_dist = 0.0f;
+
+  for (auto &r : regions) {
+    const float dist = distance_xz(focus, r.desc.center);
+    if (r.loaded.has_value()) {
+      if (dist > r.desc.radius * hysteresis) {
+        release(r);
+        released = true;
+      }
+      else loaded++;
+    }
+    else if (dist <= r.desc.radius && (nearest == nullptr || dist < nearest_dist)) {
+      nearest = &r;
+      nearest_dist = dist;
+    }
+  }
+
+  if (nearest != nullptr && loaded >= max_resident) {
+    // only make way for the new region if a loaded one is further away
+    region *furthest = nullptr;
+    float furthest_dist = nearest_dist;
+    for (auto &r : regions) {
+      if (const float dist = distance_xz(focus, r.desc.center); r.loaded.has_value() && dist > furthest_dist) {
+        furthest = &r;
+        furthest_dist = dist;
+      }
+    }
+
+    if (furthest == nullptr) nearest = nullptr;
+    else {
+      release(*furthest);
+      released = true;
+    }
+  }
+
+  // evict before loading, so the GPU memory is freed before it's needed again
+  if (released) render_cache::evict_unused();
+
+  if (nearest != nullptr) {
+    log<log_type::DEBUG>("region_streamer", std::format("Loading region {} (at {:.1f} units)", nearest->desc.asset, nearest_dist));
+    auto desc = map_desc::parse_from(nearest->desc.asset, opts);
+    if (!desc.regions.empty()) {
+      log<log_type::WARNING>("region_streamer", std::format("Region {} declares regions of its own (ignored)", nearest->desc.asset));
+    }
+    nearest->loaded = std::move(desc);
+  }
+
+  return released || nearest != nullptr;
+}
+
+std::vector<const map_desc *> region_streamer::resident() const {
+  std::vector<const map_desc *> res;
+  for (const auto &r : regions) {
+    if (r.loaded.has_value()) res.push_back(&*r.loaded);
+  }
+  return res;
+}
+
+void region_streamer::release(region &r) {
+  log<log_type::DEBUG>("region_streamer", std::format("Releasing region {}", r.desc.asset));
+  for (const auto &ref : r.loaded->scene) render_cache::release(ref);
+  for (const auto &ref : r.loaded->scene_instances) render_cache::release(ref);
+  r.loaded.reset();
+}
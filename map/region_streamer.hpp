@@ -0,0 +1,83 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef REGION_STREAMER_HPP
+#define REGION_STREAMER_HPP
+
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "map_parser.hpp"
+
+namespace openvtt::map {
+/**
+ * @brief Class streaming the regions of a map in and out, depending on the position of the camera.
+ *
+ * A region is loaded (by evaluating its map file) once the camera gets within its radius, and released again once
+ * the camera is further than `hysteresis` times its radius (so a camera on the border doesn't keep reloading it).
+ * Releasing a region releases its renderables, and evicts the assets (including colliders) no other renderable uses
+ * (see `render_cache::evict_unused`). Distances are measured on the XZ plane, as the camera hovers above the map.
+ *
+ * At most one region is loaded per `update`, nearest first, to bound the work done in a single frame. At most
+ * `max_resident` regions are loaded at once; if the limit is reached, the furthest loaded region makes way for a
+ * nearer one. Both bound the working set, regardless of the amount of regions in the map.
+ *
+ * Regions are self-contained maps: they don't see the variables of the map declaring them (but they can include
+ * shared definitions), and their own regions are ignored.
+ */
+class region_streamer {
+public:
+  constexpr static float hysteresis = 1.25f; //!< The factor of the radius beyond which a loaded region is released.
+
+  /**
+   * @brief Creates a new streamer, without regions.
+   * @param max_resident The maximal amount of regions that are loaded at the same time (at least one).
+   * @param opts The options for loading the regions' maps.
+   */
+  explicit region_streamer(const size_t max_resident = 16, const parse_options &opts = {})
+    : max_resident{std::max<size_t>(max_resident, 1)}, opts{opts} {}
+
+  region_streamer(const region_streamer &) = delete;
+  region_streamer(region_streamer &&) = delete;
+  region_streamer &operator=(const region_streamer &) = delete;
+  region_streamer &operator=(region_streamer &&) = delete;
+
+  /**
+   * @brief Sets the regions to stream, releasing all currently loaded regions.
+   * @param regions The regions (typically `map_desc::regions`).
+   */
+  void reset(const std::vector<map_region> &regions);
+
+  /**
+   * @brief Loads and releases regions, based on the position of the camera.
+   * @param focus The position of the camera.
+   * @return `true` if any region was loaded or released (i.e. the set of loaded renderables changed).
+   */
+  bool update(const glm::vec3 &focus);
+
+  /**
+   * @brief Gets the descriptions of the loaded regions.
+   * @return The loaded regions (in no particular order).
+   */
+  [[nodiscard]] std::vector<const map_desc *> resident() const;
+
+private:
+  /**
+   * @brief Structure representing a region, and its contents (if loaded).
+   */
+  struct region {
+    map_region desc; //!< The region.
+    std::optional<map_desc> loaded = std::nullopt; //!< The contents of the region, while it is loaded.
+  };
+
+  void release(region &r);
+
+  std::vector<region> regions{};
+  size_t max_resident;
+  parse_options opts;
+};
+}
+
+#endif //REGION_STREAMER_HPP
@@ -5,172 +5,140 @@
 #ifndef SCANLINE_HPP
 #define SCANLINE_HPP
 
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
 #include <ranges>
 #include <vector>
-#include <unordered_set>
-#include <generator>
 
-namespace openvtt::map {
-/**
- * @brief Shorthand for `static_cast<int>(std::round(x))`.
- * @param x The value to round.
- * @return The rounded value (as int).
- */
-constexpr int round_to_int(const float x) {
-  return static_cast<int>(std::round(x));
-}
-
-/**
- * @brief Gets the x-coordinate of the intersection of a horizontal line with a line segment (that isn't horizontal).
- * @param y_hor The y-coordinate of the horizontal line.
- * @param p1 The first point of the line segment.
- * @param p2 The second point of the line segment.
- * @return The x-coordinate of the intersection (even if it's outside the segment).
- */
-constexpr float intersection_x(const int y_hor, const std::pair<int, int> &p1, const std::pair<int, int> &p2) {
-  const auto &[x1, y1] = p1;
-  const auto &[x2, y2] = p2;
-  return static_cast<float>(x1) + static_cast<float>(y_hor - y1) * static_cast<float>(x2 - x1) / static_cast<float>(y2 - y1);
-}
+#include "renderer/log_view.hpp"
 
-/**
- * @brief Checks if an integer is between two other integers.
- * @param x The integer to check.
- * @param a The first bound.
- * @param b The second bound.
- * @return True if `a <= x <= b` or `b <= x <= a`, false otherwise.
- *
- * The order of `a` and `b` doesn't matter, and they are inclusive.
- */
-constexpr bool between(const int x, const int a, const int b) {
-  return (x >= a && x <= b) || (x >= b && x <= a);
-}
+namespace openvtt::map {
+#ifdef OPENVTT_TRACE_SCANLINE
+constexpr bool trace_scanline = true; //!< Whether `scanline_fill` logs its progress (very verbose).
+#else
+constexpr bool trace_scanline = false; //!< Whether `scanline_fill` logs its progress (very verbose).
+#endif
 
 /**
- * @brief Checks if a float is between two integers.
- * @param x The float to check.
- * @param a The first bound.
- * @param b The second bound.
- * @return True if `a <= x <= b` or `b <= x <= a`, false otherwise.
- *
- * The order of `a` and `b` doesn't matter, and they are inclusive.
- * Both `a` and `b` are cast to float before comparison.
+ * @brief Structure representing a horizontal run of interior points, as produced by `scanline_fill`.
  */
-constexpr bool between(const float x, const int a, const int b) {
-  return (x >= static_cast<float>(a) && x <= static_cast<float>(b)) || (x >= static_cast<float>(b) && x <= static_cast<float>(a));
-}
+struct scan_span {
+  int y; //!< The y-coordinate of the row.
+  int x_begin; //!< The first x-coordinate in the span (inclusive).
+  int x_end; //!< The x-coordinate just after the span (exclusive).
+
+  /**
+   * @brief Gets the amount of points in the span.
+   * @return `x_end - x_begin`.
+   */
+  [[nodiscard]] constexpr int size() const { return x_end - x_begin; }
+};
 
 /**
- * @brief Performs scanline filling on a polygon.
+ * @brief Performs scanline filling on a polygon, using an active edge table.
  * @param points The points of the polygon.
- * @return The interior (integer) points of the polygon.
+ * @return The interior (integer) points of the polygon, as spans (sorted by row, then by x).
  *
- * "Left" points are considered inclusive, while "right" points are exclusive.
- * Horizontal edges are ignored.
+ * Both "left" and "bottom" points are considered inclusive, while "right" and "top" points are exclusive; so polygons
+ * sharing an edge never fill the same point. Horizontal edges are ignored.
  * Passing a polygon where edges intersect each other is undefined behavior. Edges should be broken up into
  * non-intersecting segments.
+ *
+ * Edges are bucketed by their lowest row, and only the edges crossing the current row are kept (sorted by x). Their
+ * intersections are updated incrementally in exact integer arithmetic, so the cost is proportional to the amount of
+ * edges, crossings and spans (rather than to rows times edges), and doesn't depend on the width of the polygon.
+ * Tracing is compiled in with `OPENVTT_TRACE_SCANLINE` only.
  */
-inline std::vector<std::pair<int, int>> scanline_fill(const std::vector<std::pair<int, int>> &points) {
-  using point = std::pair<int, int>;
-  using edge = std::pair<point, point>;
-  // Create edges
-  int y_min = std::numeric_limits<int>::max();
-  int y_max = std::numeric_limits<int>::min();
-
+inline std::vector<scan_span> scanline_fill(const std::vector<std::pair<int, int>> &points) {
   using namespace renderer;
-  log<log_type::DEBUG>("scanline", std::format("Scanline started. Got {} points.", points.size()));
 
-  std::vector<edge> edges;
-  edges.reserve(points.size());
+  // an edge crosses the rows y_begin up to (excluding) y_end; its intersection with the current row is x_num / dy,
+  // which moves by dx / dy each row (x caches the rounded-up intersection)
+  struct edge {
+    int y_begin;
+    int y_end;
+    int64_t x_num;
+    int64_t dx;
+    int64_t dy;
+    int x;
+  };
+
+  std::vector<edge> table;
+  table.reserve(points.size());
   for (size_t i = 0; i < points.size(); i++) {
-    const auto &[x1, y1] = points[i];
-    const auto &[x2, y2] = points[(i + 1) % points.size()];
-    log<log_type::DEBUG>("scanline", std::format("  Checking edge ({}, {}) -> ({}, {}).", x1, y1, x2, y2));
-
-    // ignore horizontal edges
-    if (y1 > y2) edges.emplace_back(point{x1, y1}, point{x2, y2});
-    else if (y2 > y1) edges.emplace_back(point{x2, y2}, point{x1, y1});
-
-    if (y1 < y_min) y_min = y1;
-    if (y2 < y_min) y_min = y2;
-    if (y1 > y_max) y_max = y1;
-    if (y2 > y_max) y_max = y2;
+    auto [x1, y1] = points[i];
+    auto [x2, y2] = points[(i + 1) % points.size()];
+    if (y1 == y2) continue; // ignore horizontal edges
+    if (y1 > y2) {
+      std::swap(x1, x2);
+      std::swap(y1, y2);
+    }
+    table.push_back({y1, y2, int64_t{x1} * (y2 - y1), int64_t{x2} - x1, int64_t{y2} - y1, x1});
+  }
+  std::ranges::sort(table, {}, &edge::y_begin);
+
+  if constexpr (trace_scanline) {
+    log<log_type::DEBUG>("scanline", "Scanline started. Got {} points, {} edges (ignored {} horizontal edges).",
+      points.size(), table.size(), points.size() - table.size());
   }
-  log<log_type::DEBUG>("scanline", std::format("Got {} edges (ignored {} horizontal edges).", edges.size(), points.size() - edges.size()));
-  log<log_type::DEBUG>("scanline", std::format("Ranging from y={} to y={}.", y_min, y_max));
-
-  std::vector<point> result;
-  // Scan lines
-  for (int y = y_min; y <= y_max; y++) {
-    // Find intersections
-    std::vector<std::pair<float, edge>> intersections;
-    for (const auto &[p1, p2] : edges) {
-      const auto &[x1, y1] = p1;
-      const auto &[x2, y2] = p2;
-      if (!between(y, y1, y2)) continue; // edge can't intersect
-
-      if (const auto x_int = intersection_x(y, p1, p2); between(x_int, x1, x2)) intersections.emplace_back(x_int, edge{p1, p2});
+
+  // ceil(n / d), for d > 0
+  const auto ceil_div = [](const int64_t n, const int64_t d) {
+    return static_cast<int>(n >= 0 ? (n + d - 1) / d : -(-n / d));
+  };
+  const auto by_x = [](const edge &a, const edge &b) { return a.x < b.x; };
+
+  std::vector<scan_span> result;
+  std::vector<edge> active;
+  size_t next = 0;
+  int y = 0;
+  while (next < table.size() || !active.empty()) {
+    std::erase_if(active, [y](const edge &e) { return e.y_end <= y; });
+    if (active.empty()) {
+      if (next == table.size()) break;
+      y = table[next].y_begin; // skip rows without edges
     }
+    while (next < table.size() && table[next].y_begin == y) active.push_back(table[next++]);
 
-    // Sort by x
-    std::ranges::sort(intersections, [](const auto &p1, const auto &p2) {
-      return p1.first < p2.first;
-    });
+    // edges don't cross, so the order only changes by edges being added; insertion sort is (nearly) linear
+    for (auto &e : active) e.x = ceil_div(e.x_num, e.dy);
+    for (auto it = active.begin(); it != active.end(); ++it) {
+      std::rotate(std::upper_bound(active.begin(), it, *it, by_x), it, it + 1);
+    }
 
-    log<log_type::DEBUG>("scanline", std::format("  -> For y={}, have {} intersections", y, intersections.size()));
-    for (const auto &x : intersections | std::ranges::views::keys) {
-      log<log_type::DEBUG>("scanline", std::format("    -> Intersection at x={}.", x));
+    for (size_t i = 0; i + 1 < active.size(); i += 2) {
+      if (active[i].x < active[i + 1].x) result.push_back({y, active[i].x, active[i + 1].x});
     }
-    log<log_type::DEBUG>("scanline", std::format("  -> Filling between intersections."));
-
-    bool filling = true;
-    for (size_t i = 0; i < intersections.size() - 1; i++) {
-      const auto &[x1, edge1] = intersections[i];
-      const auto &[x2, edge2] = intersections[i + 1];
-      log<log_type::DEBUG>("scanline", std::format("    -> Piece {} to {}, filling? {}.", x1, x2, filling));
-
-      if (x2 - x1 <= 1e-6f) {
-        // both are the same point
-        // if bottom of edges, count as interior
-        // otherwise, ignore
-        // in either case: don't swap flag
-        const auto &[xa, ya] = edge1.first;
-        const auto &[xb, yb] = edge1.second;
-        const auto &[xc, yc] = edge2.first;
-        const auto &[xd, yd] = edge2.second;
-        if (std::min({ya, yb, yc, yd, y}) == y) {
-          log<log_type::DEBUG>("scanline", std::format("      -> Adding single point ({}, {})", round_to_int(x1), y));
-          result.emplace_back(round_to_int(x1), y);
-        }
-      }
-      else if (filling) {
-        // check if is integer
-        //    -> begin: interior if integer
-        const int xb = static_cast<int>(std::abs(std::round(x1) - x1) < 1e-6f ? std::floor(x1) : std::ceil(x1));
-        //    -> end: exterior if integer
-        const int xe = static_cast<int>(std::abs(std::round(x2) - x2) < 1e-6f ? std::floor(x2 - 1.0f) : std::floor(x2));
-        log<log_type::DEBUG>("scanline", std::format("      -> Adding piece from {} to {}.", xb, xe));
-
-        for (int x = xb; x <= xe; x++) {
-          result.emplace_back(x, y);
-          log<log_type::DEBUG>("scanline", "        -> Adding ({}, {}).", x, y);
-        }
-
-        // crossed an edge, stop filling
-        filling = false;
-      }
-      else {
-        // crossed an edge, start filling again
-        filling = true;
-      }
+    if constexpr (trace_scanline) {
+      log<log_type::DEBUG>("scanline", "  -> For y={}, have {} crossings, {} spans in total.", y, active.size(), result.size());
     }
+
+    for (auto &e : active) e.x_num += e.dx;
+    y++;
   }
 
-  log<log_type::DEBUG>("scanline", std::format("Final results: ({} points)", result.size()));
-  for (const auto &[x, y] : result) {
-    log<log_type::DEBUG>("scanline", std::format("  -> ({}, {})", x, y));
+  if constexpr (trace_scanline) {
+    log<log_type::DEBUG>("scanline", "Scanline finished. Got {} spans.", result.size());
   }
+  return result;
+}
 
+/**
+ * @brief Expands spans into the points they cover.
+ * @param spans The spans (as produced by `scanline_fill`).
+ * @return The points covered by the spans, in order.
+ */
+inline std::vector<std::pair<int, int>> span_points(const std::vector<scan_span> &spans) {
+  size_t total = 0;
+  for (const auto &s : spans) total += static_cast<size_t>(s.size());
+
+  std::vector<std::pair<int, int>> result;
+  result.reserve(total);
+  for (const auto &[y, xb, xe] : spans) {
+    for (int x = xb; x < xe; x++) result.emplace_back(x, y);
+  }
   return result;
 }
 
@@ -178,31 +146,80 @@ inline std::vector<std::pair<int, int>> scanline_fill(const std::vector<std::pai
  * @brief Determines the border of a region.
  * @param selected The selected points (the region).
  * @param width The width of the border.
- * @return A set of coordinates representing the border.
+ * @return The points within (Euclidean) distance `width` of the region, but not in it; in row-major order.
+ *
+ * The region is rasterized into a dense grid (its bounding box, grown by `width`), on which the squared distance to the
+ * nearest selected point is computed with a separable distance transform: first along columns (two linear sweeps
+ * over whole rows), then along rows (as the lower envelope of parabolas, see Felzenszwalb & Huttenlocher). Both
+ * passes are linear in the size of the grid, regardless of the width. Distances beyond `width` are capped, as they are
+ * never part of the border anyway. The grid covers the bounding box, so this suits compact regions (like those from
+ * `scanline_fill`) best.
  */
 inline std::vector<std::pair<int, int>> border(const std::vector<std::pair<int, int>> &selected, const int width) {
-  const auto extend = [&width](const std::pair<int, int> &point) -> std::generator<std::pair<int, int>> {
-    const auto [x0, y0] = point;
-    const int xm = x0 - width, xM = x0 + width;
-    const int ym = y0 - width, yM = y0 + width;
-    for (int x = xm; x <= xM; x++) {
-      for (int y = ym; y <= yM; y++) {
-        const float dist = std::sqrt(static_cast<float>((x - x0) * (x - x0) + (y - y0) * (y - y0)));
-        if (dist <= static_cast<float>(width)) co_yield std::pair{x, y};
-      }
+  if (selected.empty() || width <= 0) return {};
+
+  int x_min = std::numeric_limits<int>::max(), x_max = std::numeric_limits<int>::min();
+  int y_min = std::numeric_limits<int>::max(), y_max = std::numeric_limits<int>::min();
+  for (const auto &[x, y] : selected) {
+    x_min = std::min(x_min, x);
+    x_max = std::max(x_max, x);
+    y_min = std::min(y_min, y);
+    y_max = std::max(y_max, y);
+  }
+  x_min -= width; x_max += width;
+  y_min -= width; y_max += width;
+  const auto cols = static_cast<size_t>(x_max - x_min) + 1;
+  const auto rows = static_cast<size_t>(y_max - y_min) + 1;
+
+  // vertical distance to the nearest selected point in the same column (0 for the selected points themselves)
+  std::vector<int32_t> dist(cols * rows, width + 1);
+  for (const auto &[x, y] : selected) dist[static_cast<size_t>(y - y_min) * cols + static_cast<size_t>(x - x_min)] = 0;
+  for (size_t r = 1; r < rows; r++) {
+    int32_t *row = dist.data() + r * cols;
+    const int32_t *prev = row - cols;
+    for (size_t c = 0; c < cols; c++) row[c] = std::min(row[c], prev[c] + 1);
+  }
+  for (size_t r = rows - 1; r-- > 0;) {
+    int32_t *row = dist.data() + r * cols;
+    const int32_t *next = row + cols;
+    for (size_t c = 0; c < cols; c++) row[c] = std::min(row[c], next[c] + 1);
+  }
+
+  // per row: squared distance = min over columns c' of (c - c')^2 + dist(c')^2, as the lower envelope of parabolas
+  const int64_t reach = int64_t{width} * width;
+  std::vector<size_t> apex(cols); // the columns of the parabolas in the envelope
+  std::vector<double> from(cols + 1); // the envelope follows parabola k on [from[k], from[k + 1])
+  std::vector<std::pair<int, int>> result;
+  for (size_t r = 0; r < rows; r++) {
+    const int32_t *row = dist.data() + r * cols;
+    const auto f = [row](const size_t c) { return int64_t{row[c]} * row[c]; };
+    const auto intersect = [&f](const size_t p, const size_t q) {
+      const auto ip = static_cast<int64_t>(p), iq = static_cast<int64_t>(q);
+      return static_cast<double>(f(q) + iq * iq - f(p) - ip * ip) / static_cast<double>(2 * (iq - ip));
+    };
+
+    size_t k = 0;
+    apex[0] = 0;
+    from[0] = -std::numeric_limits<double>::infinity();
+    from[1] = std::numeric_limits<double>::infinity();
+    for (size_t q = 1; q < cols; q++) {
+      double s = intersect(apex[k], q);
+      while (s <= from[k]) s = intersect(apex[--k], q);
+      apex[++k] = q;
+      from[k] = s;
+      from[k + 1] = std::numeric_limits<double>::infinity();
     }
-  };
 
-  const std::unordered_set<std::pair<int, int>> original{selected.begin(), selected.end()};
-  std::unordered_set<std::pair<int, int>> result;
-  for (const auto &point: selected) {
-    for (const auto &ext: extend(point)) {
-      if (!original.contains(ext))
-        result.insert(ext);
+    k = 0;
+    for (size_t c = 0; c < cols; c++) {
+      while (from[k + 1] < static_cast<double>(c)) k++;
+      const auto dc = static_cast<int64_t>(c) - static_cast<int64_t>(apex[k]);
+      if (row[c] != 0 && dc * dc + f(apex[k]) <= reach)
+        result.emplace_back(x_min + static_cast<int>(c), y_min + static_cast<int>(r));
     }
   }
 
-  return std::vector<std::pair<int, int>>{result.begin(), result.end()};
+  return result;
 }
 }
 
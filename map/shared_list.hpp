@@ -0,0 +1,160 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef SHARED_LIST_HPP
+#define SHARED_LIST_HPP
+
+#include <memory>
+#include <span>
+#include <vector>
+#include <algorithm>
+
+namespace openvtt::map {
+/**
+ * @brief An immutable list with structurally shared storage.
+ * @tparam T The element type.
+ *
+ * A list is a view of the first `size()` elements of a shared buffer. Copying a list only copies the view (O(1)), and
+ * the elements visible through a view never change.
+ *
+ * Appending to a list that ends at the end of its buffer (the "tip") grows the shared buffer in place, and returns a
+ * longer view of it; the original view still only sees its own elements. Appending to any other list copies its
+ * elements into a fresh buffer first. Hence, building a list incrementally (`l = l + x`) is amortized O(1) per append,
+ * while older versions of the list remain valid.
+ *
+ * Storage is not synchronized; lists sharing a buffer should not be appended to from multiple threads.
+ */
+template <typename T>
+class shared_list {
+public:
+  using value_type = T; //!< The element type.
+  using const_iterator = const T *; //!< The iterator type (elements can't be modified through a list).
+  using iterator = const_iterator; //!< The iterator type (elements can't be modified through a list).
+
+  /**
+   * @brief Constructs an empty list.
+   */
+  shared_list() = default;
+
+  /**
+   * @brief Constructs a list by taking over the elements of a vector.
+   * @param elems The elements.
+   */
+  explicit shared_list(std::vector<T> &&elems) :
+    buf{elems.empty() ? nullptr : std::make_shared<std::vector<T>>(std::move(elems))}, len{buf ? buf->size() : 0} {}
+
+  /**
+   * @brief Constructs a list by copying the given elements.
+   * @param elems The elements.
+   */
+  explicit shared_list(const std::span<const T> elems) : shared_list{std::vector<T>(elems.begin(), elems.end())} {}
+
+  /**
+   * @brief Gets the amount of elements in the list.
+   * @return The size of the list.
+   */
+  [[nodiscard]] constexpr size_t size() const { return len; }
+
+  /**
+   * @brief Checks whether the list is empty.
+   * @return `true` if the list has no elements.
+   */
+  [[nodiscard]] constexpr bool empty() const { return len == 0; }
+
+  /**
+   * @brief Gets a pointer to the first element.
+   * @return A pointer to the contiguous elements (or `nullptr` for an empty list).
+   *
+   * The pointer is invalidated when a list sharing the same buffer is appended to.
+   */
+  [[nodiscard]] const T *data() const { return buf ? buf->data() : nullptr; }
+
+  [[nodiscard]] const_iterator begin() const { return data(); }
+  [[nodiscard]] const_iterator end() const { return data() + len; }
+
+  /**
+   * @brief Gets an element of the list (without bounds checking).
+   * @param idx The index of the element.
+   * @return A reference to the element.
+   */
+  [[nodiscard]] const T &operator[](const size_t idx) const { return (*buf)[idx]; }
+
+  /**
+   * @brief Gets a span over the elements of the list.
+   * @return The span (invalidated in the same way as `data()`).
+   */
+  [[nodiscard]] std::span<const T> span() const { return {data(), len}; }
+
+  /**
+   * @brief Creates a new list with an element appended.
+   * @param x The element to append.
+   * @return The new list.
+   */
+  [[nodiscard]] shared_list append(T x) const {
+    auto res = tip_or_copy(1);
+    res.buf->push_back(std::move(x));
+    res.len++;
+    return res;
+  }
+
+  /**
+   * @brief Creates a new list with all elements of another list appended.
+   * @param other The other list.
+   * @return The new list.
+   */
+  [[nodiscard]] shared_list concat(const shared_list &other) const {
+    if (other.empty()) return *this;
+    if (empty()) return other;
+
+    auto res = tip_or_copy(other.len);
+    // other might share our buffer; the capacity is reserved, so indexing stays valid while pushing
+    for (size_t i = 0; i < other.len; i++) res.buf->push_back((*other.buf)[i]);
+    res.len += other.len;
+    return res;
+  }
+
+  /**
+   * @brief Copies the elements into a vector.
+   * @return A vector holding the elements.
+   */
+  [[nodiscard]] std::vector<T> to_vector() const { return std::vector<T>(begin(), end()); }
+
+  /**
+   * @brief Compares two lists element-wise.
+   * @param other The other list.
+   * @return `true` if both lists have the same elements.
+   */
+  [[nodiscard]] bool operator==(const shared_list &other) const {
+    if (len != other.len) return false;
+    if (buf == other.buf) return true;
+    return std::equal(begin(), end(), other.begin(), other.end());
+  }
+
+private:
+  /**
+   * @brief Gets a view of our elements whose buffer ends at the view (so it can be appended to).
+   * @param extra The amount of elements that will be appended.
+   * @return Either a view of our own buffer (if we are its tip), or a view of a fresh copy.
+   */
+  shared_list tip_or_copy(const size_t extra) const {
+    shared_list res;
+    if (buf && buf->size() == len) {
+      res.buf = buf;
+    }
+    else {
+      res.buf = std::make_shared<std::vector<T>>();
+      res.buf->reserve(std::max(len + extra, 2 * len));
+      if (buf) res.buf->insert(res.buf->end(), buf->begin(), buf->begin() + static_cast<std::ptrdiff_t>(len));
+    }
+    if (res.buf->capacity() < len + extra) res.buf->reserve(std::max(len + extra, 2 * len));
+    res.len = len;
+    return res;
+  }
+
+  std::shared_ptr<std::vector<T>> buf = nullptr;
+  size_t len = 0;
+};
+}
+
+#endif //SHARED_LIST_HPP
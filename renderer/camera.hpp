@@ -9,6 +9,7 @@
 #include <glm/ext/matrix_clip_space.hpp>
 #include <glm/ext/matrix_transform.hpp>
 
+#include "frustum.hpp"
 #include "window.hpp"
 #include "shader.hpp"
 
@@ -59,6 +60,13 @@ struct camera {
     return glm::perspective(glm::radians(45.0f), window::get().aspect_ratio(), 0.1f, 100.0f);
   }
 
+  /**
+   * @brief Returns the view frustum of the camera.
+   */
+  [[nodiscard]] inline frustum view_frustum() const {
+    return frustum::from(projection_matrix() * view_matrix());
+  }
+
   /**
    * @brief Sets the view and projection matrices in the shader.
    *
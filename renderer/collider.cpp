@@ -6,6 +6,10 @@
 #include "collider.hpp"
 #include "filesys.hpp"
 
+#include <algorithm>
+#include <array>
+#include <limits>
+
 #include <assimp/Importer.hpp>
 #include <assimp/postprocess.h>
 #include <assimp/scene.h>
@@ -19,10 +23,149 @@ constexpr glm::vec3 element_min(const glm::vec3 &a, const glm::vec3 &b) {
 constexpr glm::vec3 element_max(const glm::vec3 &a, const glm::vec3 &b) {
   return {std::max(a.x, b.x), std::max(a.y, b.y), std::max(a.z, b.z)};
 }
+
+constexpr uint32_t leaf_size = 4; //!< The maximal amount of triangles in a BVH leaf.
+constexpr size_t max_depth = 64; //!< The maximal depth of a BVH (median splits keep it logarithmic).
+
+/**
+ * @brief Computes where a ray enters a box (slab test).
+ * @param r The ray.
+ * @param min The minimal corner of the box.
+ * @param max The maximal corner of the box.
+ * @param t_max The distance beyond which hits don't matter.
+ * @return The parametric distance at which the ray enters the box (at least 0), or infinity if it misses the box (or
+ * only reaches it beyond `t_max`).
+ */
+float enter_box(const ray &r, const glm::vec3 &min, const glm::vec3 &max, const float t_max) {
+  const glm::vec3 t1 = (min - r.point()) * r.inv_dir();
+  const glm::vec3 t2 = (max - r.point()) * r.inv_dir();
+  const float t_enter = std::max({std::min(t1.x, t2.x), std::min(t1.y, t2.y), std::min(t1.z, t2.z), 0.0f});
+  const float t_exit = std::min({std::max(t1.x, t2.x), std::max(t1.y, t2.y), std::max(t1.z, t2.z), t_max});
+  return t_enter <= t_exit ? t_enter : INFINITY;
+}
+
+/**
+ * @brief Transforms a ray by an (affine) matrix; the parametric distance along the ray is preserved.
+ */
+ray transform_ray(const ray &r, const glm::mat4 &m) {
+  return {glm::vec3{m * glm::vec4(r.point(), 1.0f)}, glm::vec3{m * glm::vec4(r.dir(), 0.0f)}};
+}
 }
 
-collider::collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices)
-  : vertices{vertices}, indices{indices} {
+triangle_bvh::triangle_bvh(const std::span<const glm::vec3> vertices, const std::span<const unsigned int> indices) {
+  /**
+   * @brief Structure holding a triangle while building the BVH.
+   */
+  struct bounded {
+    glm::vec3 min; //!< The minimal corner of the triangle's bounding box.
+    glm::vec3 max; //!< The maximal corner of the triangle's bounding box.
+    uint32_t first; //!< The index of the triangle's first index.
+  };
+
+  const auto count = static_cast<uint32_t>(indices.size() / 3);
+  if (count == 0) return;
+
+  std::vector<bounded> tris;
+  tris.reserve(count);
+  for (uint32_t i = 0; i < count; i++) {
+    const auto &a = vertices[indices[3 * i]], &b = vertices[indices[3 * i + 1]], &c = vertices[indices[3 * i + 2]];
+    tris.push_back({element_min(element_min(a, b), c), element_max(element_max(a, b), c), 3 * i});
+  }
+
+  // depth-first, so a left child directly follows its parent; the parent of a right child is patched once it is reached
+  constexpr auto no_parent = std::numeric_limits<uint32_t>::max();
+  struct work { uint32_t begin, end, parent; };
+  std::vector<work> todo{{0, count, no_parent}};
+  nodes.reserve(2 * (count / leaf_size + 1));
+  while (!todo.empty()) {
+    const auto [begin, end, parent] = todo.back();
+    todo.pop_back();
+
+    const auto idx = static_cast<uint32_t>(nodes.size());
+    if (parent != no_parent) nodes[parent].offset = idx;
+
+    glm::vec3 min = tris[begin].min, max = tris[begin].max;
+    glm::vec3 c_min = (min + max) * 0.5f, c_max = c_min;
+    for (uint32_t i = begin + 1; i < end; i++) {
+      min = element_min(min, tris[i].min);
+      max = element_max(max, tris[i].max);
+      const glm::vec3 centroid = (tris[i].min + tris[i].max) * 0.5f;
+      c_min = element_min(c_min, centroid);
+      c_max = element_max(c_max, centroid);
+    }
+
+    if (end - begin <= leaf_size) {
+      nodes.push_back({min, begin, max, end - begin});
+      continue;
+    }
+    nodes.push_back({min, 0, max, 0});
+
+    // split at the median centroid along the axis in which the centroids are spread the most
+    const glm::vec3 extent = c_max - c_min;
+    const int axis = extent.x >= extent.y && extent.x >= extent.z ? 0 : extent.y >= extent.z ? 1 : 2;
+    const uint32_t mid = begin + (end - begin) / 2;
+    std::nth_element(tris.begin() + begin, tris.begin() + mid, tris.begin() + end, [axis](const bounded &a, const bounded &b) {
+      return a.min[axis] + a.max[axis] < b.min[axis] + b.max[axis];
+    });
+    todo.push_back({mid, end, idx});
+    todo.push_back({begin, mid, no_parent});
+  }
+
+  triangles.reserve(count);
+  for (const auto &t : tris) {
+    const auto &v0 = vertices[indices[t.first]];
+    triangles.push_back({v0, vertices[indices[t.first + 1]] - v0, vertices[indices[t.first + 2]] - v0});
+  }
+}
+
+float triangle_bvh::intersect(const ray &r) const {
+  float best = INFINITY;
+  if (nodes.empty()) return best;
+
+  // nodes still to visit, with the distance at which the ray enters them
+  std::array<std::pair<uint32_t, float>, max_depth> stack;
+  size_t top = 0;
+  if (const float t = enter_box(r, nodes[0].min, nodes[0].max, best); t != INFINITY) stack[top++] = {0, t};
+
+  while (top > 0) {
+    const auto [idx, t_enter] = stack[--top];
+    if (t_enter > best) continue; // a closer hit was found since this node was pushed
+    const auto &n = nodes[idx];
+
+    if (n.count > 0) {
+      // Möller–Trumbore: solve o + t d = v0 + u e1 + v e2 with Cramer's rule, sharing the cross products
+      for (uint32_t i = n.offset; i < n.offset + n.count; i++) {
+        const auto &[v0, e1, e2] = triangles[i];
+        const glm::vec3 p = cross(r.dir(), e2);
+        const float det = dot(e1, p);
+        if (det == 0.0f) continue; // parallel to the triangle (or degenerate)
+        const float inv_det = 1.0f / det;
+
+        const glm::vec3 s = r.point() - v0;
+        const float u = dot(s, p) * inv_det;
+        if (u < 0.0f || u > 1.0f) continue;
+        const glm::vec3 q = cross(s, e1);
+        const float v = dot(r.dir(), q) * inv_det;
+        if (v < 0.0f || u + v > 1.0f) continue;
+
+        if (const float t = dot(e2, q) * inv_det; t >= 0.0f && t < best) best = t;
+      }
+      continue;
+    }
+
+    // visit the nearest child first, so the other one can be skipped if the hit is in front of it
+    std::pair near{idx + 1, enter_box(r, nodes[idx + 1].min, nodes[idx + 1].max, best)};
+    std::pair far{n.offset, enter_box(r, nodes[n.offset].min, nodes[n.offset].max, best)};
+    if (far.second < near.second) std::swap(near, far);
+    if (far.second != INFINITY) stack[top++] = far;
+    if (near.second != INFINITY) stack[top++] = near;
+  }
+
+  return best;
+}
+
+collider::collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices, triangle_bvh bvh)
+  : vertices{vertices}, indices{indices}, bvh{std::move(bvh)} {
   GL_genVertexArrays(1, &vao);
   GL_bindVertexArray(vao);
 
@@ -49,7 +192,7 @@ collider::collider(const std::vector<glm::vec3> &vertices, const std::vector<uns
   GL_bindVertexArray(0);
 }
 
-collider collider::load_from(const std::string &asset) {
+collider::decoded collider::decode(const std::string &asset) {
   Assimp::Importer importer;
   const std::string path = asset_path<asset_type::MODEL_OBJ>(asset);
   const aiScene *scene = importer.ReadFile(
@@ -96,7 +239,8 @@ collider collider::load_from(const std::string &asset) {
     indices.push_back(face.mIndices[2]);
   }
 
-  return {vertices, indices};
+  triangle_bvh bvh{vertices, indices};
+  return {std::move(vertices), std::move(indices), std::move(bvh)};
 }
 
 void collider::draw() const {
@@ -108,67 +252,7 @@ void collider::draw() const {
 }
 
 float collider::ray_intersect(const ray &r, const glm::mat4 &model) const {
-  // --- Check if the ray hits the (transformed) AABB ---
-
-  const glm::vec3 transformed[8] {
-    {model * glm::vec4(min.x, min.y, min.z, 1.0f)},
-    {model * glm::vec4(min.x, min.y, max.z, 1.0f)},
-    {model * glm::vec4(min.x, max.y, min.z, 1.0f)},
-    {model * glm::vec4(min.x, max.y, max.z, 1.0f)},
-    {model * glm::vec4(max.x, min.y, min.z, 1.0f)},
-    {model * glm::vec4(max.x, min.y, max.z, 1.0f)},
-    {model * glm::vec4(max.x, max.y, min.z, 1.0f)},
-    {model * glm::vec4(max.x, max.y, max.z, 1.0f)}
-  };
-
-  glm::vec3 aabb_min = transformed[0];
-  glm::vec3 aabb_max = transformed[0];
-
-  for (int i = 1; i < 8; i++) {
-    aabb_min = element_min(aabb_min, transformed[i]);
-    aabb_max = element_max(aabb_max, transformed[i]);
-  }
-
-  const float tx1 = (aabb_min.x - r.point().x) * r.inv_dir().x;
-  const float tx2 = (aabb_max.x - r.point().x) * r.inv_dir().x;
-  const float ty1 = (aabb_min.y - r.point().y) * r.inv_dir().y;
-  const float ty2 = (aabb_max.y - r.point().y) * r.inv_dir().y;
-  const float tz1 = (aabb_min.z - r.point().z) * r.inv_dir().z;
-  const float tz2 = (aabb_max.z - r.point().z) * r.inv_dir().z;
-
-  const float t_min = std::max({std::min(tx1, tx2), std::min(ty1, ty2), std::min(tz1, tz2)});
-  const float t_max = std::min({std::max(tx1, tx2), std::max(ty1, ty2), std::max(tz1, tz2)});
-
-  if (t_max < t_min || t_max < 0.0f) return INFINITY; // no hit
-
-  // --- Ray hit the AABB, now check if it hits the mesh ---
-  float hit_min = INFINITY;
-  const auto c = r.dir();
-  for (size_t i = 0; i < indices.size(); i +=3 ) {
-    const glm::vec3 p1 = model * glm::vec4(vertices[indices[i]], 1.0f);
-    const glm::vec3 p2 = model * glm::vec4(vertices[indices[i+1]], 1.0f);
-    const glm::vec3 p3 = model * glm::vec4(vertices[indices[i+2]], 1.0f);
-
-    const auto a = p2 - p1;
-    const auto b = p2 - p3;
-    const auto d = p2 - r.point();
-
-    const glm::mat3 A{a, b, d};
-    const glm::mat3 B{a, b, c};
-    const glm::mat3 A1{d, b, c};
-    const glm::mat3 A2{a, d, c};
-
-    const float alpha = determinant(B);
-    const float beta = determinant(A1) / alpha;
-    const float gamma = determinant(A2) / alpha;
-    const float t0 = determinant(A) / alpha;
-
-    if (beta >= 0 && gamma >= 0 && beta + gamma <= 1 && std::isfinite(t0) && t0 < hit_min) {
-      hit_min = t0;
-    }
-  }
-
-  return hit_min; // if no hit, still returns INFINITY, otherwise parametric distance along ray
+  return ray_intersect_local(transform_ray(r, inverse(model)));
 }
 
 void collider::bind_vao() const {
@@ -181,8 +265,11 @@ collider::~collider() {
   GL_deleteBuffers(1, &ebo);
 }
 
-instanced_collider::instanced_collider(collider &&coll, const std::vector<glm::mat4> &models)
-  : collider(std::move(coll)), models{models} {
+instanced_collider::instanced_collider(collider &&coll, std::span<const glm::mat4> models)
+  : collider(std::move(coll)), models(models.begin(), models.end()) {
+  inv_models.reserve(models.size());
+  for (const auto &m : models) inv_models.push_back(inverse(m));
+
   bind_vao();
   GL_genBuffers(1, &model_vbo);
   GL_bindBuffer(GL_ARRAY_BUFFER, model_vbo);
@@ -211,7 +298,7 @@ std::pair<float, size_t> instanced_collider::ray_intersect_any(const ray &r) con
   float min_dist = INFINITY;
   size_t min_idx = -1;
   for (size_t i = 0; i < models.size(); i++) {
-    if (const float dist = ray_intersect(r, models[i]); dist < min_dist) {
+    if (const float dist = ray_intersect_local(transform_ray(r, inv_models[i])); dist < min_dist) {
       min_dist = dist;
       min_idx = i;
     }
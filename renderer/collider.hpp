@@ -6,8 +6,10 @@
 #define COLLIDER_HPP
 
 #include <glm/glm.hpp>
+#include <cstdint>
 #include <vector>
 #include <string>
+#include <span>
 #include <vector>
 #include <vector>
 
@@ -57,14 +59,90 @@ private:
   glm::vec3 inv_direction; //!< The (cached) inverse of the direction of the ray.
 };
 
+/**
+ * @brief A bounding volume hierarchy (BVH) over the triangles of a mesh, for fast ray casts.
+ *
+ * The BVH is a binary tree of axis-aligned boxes, built once (top-down, splitting each node at the median centroid
+ * along its longest axis). A ray cast only tests the triangles in the leaves whose boxes the ray hits, visiting the
+ * nearest child first and skipping boxes beyond the closest hit so far; this makes it O(log n) in the number of
+ * triangles for most rays.
+ *
+ * The triangles are stored (in leaf order) with their edges precomputed, for the Möller–Trumbore intersection test.
+ */
+class triangle_bvh {
+public:
+  /**
+   * @brief Constructs an empty BVH (which is never hit).
+   */
+  triangle_bvh() = default;
+
+  /**
+   * @brief Builds a BVH over a triangle mesh.
+   * @param vertices The vertices of the mesh.
+   * @param indices The indices of the mesh (three per triangle).
+   *
+   * This function is thread-safe, so it can be run on a worker thread (see `collider::decode`).
+   */
+  triangle_bvh(std::span<const glm::vec3> vertices, std::span<const unsigned int> indices);
+
+  /**
+   * @brief Casts a ray against the triangles in the BVH.
+   * @param r The ray, in the same space as the vertices the BVH was built from.
+   * @return The parametric distance along the ray to the closest hit (at least 0), or infinity if there is no hit.
+   *
+   * Both sides of the triangles are hit.
+   */
+  [[nodiscard]] float intersect(const ray &r) const;
+
+  /**
+   * @brief Gets the amount of nodes in the BVH.
+   * @return The amount of nodes.
+   */
+  [[nodiscard]] constexpr size_t node_count() const { return nodes.size(); }
+
+private:
+  /**
+   * @brief Structure representing a node in the BVH.
+   *
+   * The nodes are stored depth-first, so the left child of an inner node immediately follows it.
+   */
+  struct node {
+    glm::vec3 min; //!< The minimal corner of the bounding box.
+    uint32_t offset; //!< For a leaf, the index of its first triangle; otherwise, the index of the right child.
+    glm::vec3 max; //!< The maximal corner of the bounding box.
+    uint32_t count; //!< For a leaf, the amount of triangles in it; 0 for inner nodes.
+  };
+
+  /**
+   * @brief Structure representing a triangle, prepared for the Möller–Trumbore test.
+   */
+  struct triangle {
+    glm::vec3 v0; //!< The first vertex.
+    glm::vec3 e1; //!< The edge from the first to the second vertex.
+    glm::vec3 e2; //!< The edge from the first to the third vertex.
+  };
+
+  std::vector<node> nodes{}; //!< The nodes, starting with the root.
+  std::vector<triangle> triangles{}; //!< The triangles, ordered by leaf.
+};
+
 /**
  * @brief Class representing a collider.
  *
- * The collider is a mesh collider based on triangles. To speed up the ray-cast algorithm, the collider also stores the
- * AABB (axis-aligned bounding box) of the mesh.
+ * The collider is a mesh collider based on triangles. To speed up the ray-cast algorithm, the collider also stores a
+ * BVH over its triangles (see `triangle_bvh`), and the AABB (axis-aligned bounding box) of the mesh.
  */
 class collider {
 public:
+  /**
+   * @brief Structure holding a decoded (but not yet uploaded) collider mesh.
+   */
+  struct decoded {
+    std::vector<glm::vec3> vertices; //!< The vertices of the mesh.
+    std::vector<unsigned int> indices; //!< The indices of the mesh.
+    triangle_bvh bvh{}; //!< The BVH over the triangles of the mesh.
+  };
+
   /**
    * @brief Constructs a new collider.
    * @param vertices The vertices to use.
@@ -73,14 +151,22 @@ public:
    * Just like an OpenGL VBO/EBO pair, the vertices and indices are stored in separate arrays. Each triangle is defined
    * by three consecutive indices, each of which point to a vertex in the vertices array.
    *
-   * It is recommended not to use the same vertices and indices as the mesh, but rather create a simplified version of
-   * the mesh (for computational efficiency, as the ray-cast algorithm is O(n) in the number of triangles).
+   * A BVH is built over the triangles, so ray casts don't need to test all of them.
+   */
+  collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices)
+    : collider(vertices, indices, triangle_bvh{vertices, indices}) {}
+  /**
+   * @brief Constructs a new collider, with a BVH that was built earlier.
+   * @param vertices The vertices to use.
+   * @param indices The indices to use.
+   * @param bvh The BVH over the triangles (built from the same vertices and indices).
    */
-  collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices);
-  inline collider(const collider &other) : collider(other.vertices, other.indices) {}
+  collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices, triangle_bvh bvh);
+  inline collider(const collider &other) : collider(other.vertices, other.indices, other.bvh) {}
   constexpr collider(collider &&other) noexcept {
     std::swap(vertices, other.vertices);
     std::swap(indices, other.indices);
+    std::swap(bvh, other.bvh);
     std::swap(vao, other.vao);
     std::swap(vbo, other.vbo);
     std::swap(ebo, other.ebo);
@@ -98,7 +184,23 @@ public:
    * The asset's path is computed using @ref openvtt::asset_path. Only vertex positions and face indices are loaded from
    * the file, using Assimp if needed to re-triangulate the mesh.
    */
-  static collider load_from(const std::string &asset);
+  static collider load_from(const std::string &asset) { return from_decoded(decode(asset)); }
+
+  /**
+   * @brief Decodes a collider mesh from an asset file, without touching OpenGL.
+   * @param asset The path to the asset.
+   * @return The decoded mesh (empty if loading failed).
+   *
+   * This function is thread-safe, so it can be run on a worker thread (see `render_cache::load`).
+   */
+  static decoded decode(const std::string &asset);
+
+  /**
+   * @brief Uploads a decoded collider mesh to the GPU.
+   * @param d The decoded mesh.
+   * @return The collider.
+   */
+  static collider from_decoded(decoded &&d) { return {d.vertices, d.indices, std::move(d.bvh)}; }
 
   /**
    * @brief Checks if the given ray intersects the collider.
@@ -106,13 +208,11 @@ public:
    * @param model The model matrix of the collider.
    * @return The distance to the intersection point, or infinity if there is no intersection.
    *
-   * Since the stored vertices are in object space, a model matrix is needed to transform them into world space. The
-   * collider's AABB is also transformed (and the AABB of the transformed AABB is used to speed up the ray-cast
-   * algorithm).
+   * Since the stored vertices are in object space, the ray is transformed into object space (using the inverse of the
+   * model matrix) once, and cast against the BVH. The parametric distance is the same in both spaces.
    *
-   * If the ray doesn't intersect the (transformed) AABB, the function returns infinity. Otherwise, it loops over all
-   * triangles in the mesh, trying to find the closest intersection point (parametric distance along the ray). If no
-   * triangle is intersected by the ray, the function returns infinity.
+   * Only hits in front of the ray's origin count. If no triangle is intersected by the ray, the function returns
+   * infinity.
    */
   [[nodiscard]] float ray_intersect(const ray &r, const glm::mat4 &model) const;
 
@@ -138,10 +238,15 @@ public:
 protected:
   void bind_vao() const;
   [[nodiscard]] constexpr size_t num_triangles() const { return indices.size() / 3; }
+  /**
+   * @brief Checks if the given ray, in object space, intersects the collider.
+   */
+  [[nodiscard]] float ray_intersect_local(const ray &local) const { return bvh.intersect(local); }
 
 private:
   std::vector<glm::vec3> vertices{}; //!< The vertices of the collider.
   std::vector<unsigned int> indices{}; //!< The indices of the collider.
+  triangle_bvh bvh{}; //!< The BVH over the triangles of the collider.
   unsigned int vao = 0; //!< The VAO of the collider, used for rendering.
   unsigned int vbo = 0; //!< The VBO of the collider, used for rendering.
   unsigned int ebo = 0; //!< The EBO of the collider, used for rendering.
@@ -167,13 +272,13 @@ public:
    * Just like an OpenGL VBO/EBO pair, the vertices and indices are stored in separate arrays. Each triangle is defined
    * by three consecutive indices, each of which point to a vertex in the vertices array.
    *
-   * It is recommended not to use the same vertices and indices as the mesh, but rather create a simplified version of
-   * the mesh (for computational efficiency, as the ray-cast algorithm is O(n) in the number of triangles).
+   * A BVH is built over the triangles, so ray casts don't need to test all of them.
    */
-  instanced_collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices, const std::vector<glm::mat4> &models)
+  instanced_collider(const std::vector<glm::vec3> &vertices, const std::vector<unsigned int> &indices, std::span<const glm::mat4> models)
     : instanced_collider(std::move(collider(vertices, indices)), models) {}
   constexpr instanced_collider(instanced_collider &&other) noexcept : collider(std::move(other)) {
     std::swap(models, other.models);
+    std::swap(inv_models, other.inv_models);
     std::swap(model_vbo, other.model_vbo);
   }
   instanced_collider &operator=(const instanced_collider &other) = delete;
@@ -189,22 +294,45 @@ public:
    * the file, using Assimp. If needed the mesh is re-triangulated.
    */
   static instanced_collider load_from(const std::string &asset,
-                                                           const std::vector<glm::mat4> &models) {
+                                                           std::span<const glm::mat4> models) {
       return {collider::load_from(asset), models};
   }
 
+  /**
+   * @brief Structure holding a decoded (but not yet uploaded) instanced collider.
+   */
+  struct decoded {
+    collider::decoded mesh; //!< The decoded mesh.
+    std::vector<glm::mat4> models; //!< The model matrices of the instances.
+  };
+
+  /**
+   * @brief Decodes an instanced collider, without touching OpenGL.
+   * @param asset The path to the asset.
+   * @param models The model matrices of the instances (copied).
+   * @return The decoded collider.
+   */
+  static decoded decode(const std::string &asset, const std::span<const glm::mat4> models) {
+    return {collider::decode(asset), {models.begin(), models.end()}};
+  }
+
+  /**
+   * @brief Uploads a decoded instanced collider to the GPU.
+   * @param d The decoded collider.
+   * @return The instanced collider.
+   */
+  static instanced_collider from_decoded(decoded &&d) {
+    return {collider::from_decoded(std::move(d.mesh)), d.models};
+  }
+
   /**
    * @brief Checks if the given ray intersects the collider.
    * @param r The ray to check.
    * @return The distance to the intersection point, or infinity if there is no intersection.
    *
-   * Since the stored vertices are in object space, a model matrix is needed to transform them into world space. The
-   * collider's AABB is also transformed (and the AABB of the transformed AABB is used to speed up the ray-cast
-   * algorithm).
-   *
-   * If the ray doesn't intersect the (transformed) AABB, the function returns infinity. Otherwise, it loops over all
-   * triangles in the mesh, trying to find the closest intersection point (parametric distance along the ray). If no
-   * triangle is intersected by the ray, the function returns infinity.
+   * The ray is transformed into the object space of each instance (using the inverse model matrices, which are
+   * computed once, on construction), and cast against the BVH (see `collider::ray_intersect`). If no instance is hit,
+   * the function returns infinity.
    *
    * The function also returns the index of the hit instance.
    */
@@ -227,9 +355,10 @@ public:
   size_t highlighted_instance = 0; //!< The index of the highlighted instance. This value should be cleared before each frame.
 
 private:
-  instanced_collider(collider &&coll, const std::vector<glm::mat4> &models);
+  instanced_collider(collider &&coll, std::span<const glm::mat4> models);
   unsigned int model_vbo = 0; //!< The VBO of the model matrices.
   std::vector<glm::mat4> models{}; //!< The model matrices of the instances.
+  std::vector<glm::mat4> inv_models{}; //!< The inverses of the model matrices of the instances.
 };
 }
 
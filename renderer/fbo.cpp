@@ -56,7 +56,7 @@ void fbo::bind_rgb_to(const unsigned int slot) const {
 
 bool fbo::verify() const {
   GL_bindFramebuffer(GL_FRAMEBUFFER, fbo_id);
-  const auto status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+  const auto status = GL_checkFramebufferStatus(GL_FRAMEBUFFER);
   GL_bindFramebuffer(GL_FRAMEBUFFER, 0);
 
 #define STATUS_STR(X) case X: log<log_type::WARNING>("fbo", "Framebuffer incomplete: " #X "."); return false;
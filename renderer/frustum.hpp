@@ -0,0 +1,52 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef FRUSTUM_HPP
+#define FRUSTUM_HPP
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace openvtt::renderer {
+/**
+ * @brief Structure representing a view frustum, as six planes in world space.
+ */
+struct frustum {
+  std::array<glm::vec4, 6> planes{}; //!< The planes (`normal, offset`), with the normals pointing inwards.
+
+  /**
+   * @brief Extracts the frustum from a view-projection matrix.
+   * @param view_projection The matrix (`projection * view`).
+   * @return The frustum.
+   *
+   * Each plane is a sum or difference of the last row of the matrix and one of the others (Gribb & Hartmann).
+   */
+  static frustum from(const glm::mat4 &view_projection) {
+    const auto row = [&view_projection](const int i) {
+      return glm::vec4{view_projection[0][i], view_projection[1][i], view_projection[2][i], view_projection[3][i]};
+    };
+    const glm::vec4 w = row(3);
+    return {{ w + row(0), w - row(0), w + row(1), w - row(1), w + row(2), w - row(2) }};
+  }
+
+  /**
+   * @brief Checks whether an axis-aligned box is (partially) inside the frustum.
+   * @param min The minimal corner of the box.
+   * @param max The maximal corner of the box.
+   * @return `false` if the box is certainly outside the frustum.
+   *
+   * The test is conservative: boxes near the corners of the frustum may be reported as visible.
+   */
+  [[nodiscard]] bool intersects(const glm::vec3 &min, const glm::vec3 &max) const {
+    for (const auto &p : planes) {
+      // the corner furthest along the normal
+      const glm::vec3 far{p.x >= 0 ? max.x : min.x, p.y >= 0 ? max.y : min.y, p.z >= 0 ? max.z : min.z};
+      if (glm::dot(glm::vec3{p}, far) + p.w < 0) return false;
+    }
+    return true;
+  }
+};
+}
+
+#endif //FRUSTUM_HPP
@@ -0,0 +1,63 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef GL_BACKEND_HPP
+#define GL_BACKEND_HPP
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+
+namespace openvtt::renderer {
+/**
+ * @brief Class selecting the backend all OpenGL calls (made through the `GL_` macros in `gl_macros.hpp`) go to.
+ *
+ * By default, calls go to OpenGL, and creating an asset opens the window (to get a context). The null backend instead
+ * doesn't open a window, and only records the calls (by name) without executing them; objects it "creates" get ID 0.
+ * Everything else (parsing and evaluating maps, decoding assets, the render cache) runs as usual, so the map pipeline
+ * can be profiled and tested on machines without a GPU or a display.
+ *
+ * The backend should be chosen before anything touches OpenGL, and can't be changed afterwards. All calls are made
+ * from the main thread, so recording needs no locking.
+ */
+class gl_backend {
+public:
+  /**
+   * @brief Switches to the null backend.
+   */
+  static void use_null() { null = true; }
+
+  /**
+   * @brief Checks whether the null backend is in use.
+   * @return `true` if OpenGL calls are only recorded.
+   */
+  [[nodiscard]] static bool is_null() { return null; }
+
+  /**
+   * @brief Ensures there is a current OpenGL context (by opening the window), unless the null backend is in use.
+   */
+  static void ensure_context();
+
+  /**
+   * @brief Records a call to the null backend.
+   * @param call The (stringified) call.
+   */
+  static void record(std::string_view call) {
+    call.remove_prefix(call.find_first_not_of('('));
+    recorded[call.substr(0, call.find('('))]++;
+  }
+
+  /**
+   * @brief Gets the calls recorded by the null backend.
+   * @return For each OpenGL function, the amount of times it was called.
+   */
+  [[nodiscard]] static const std::unordered_map<std::string_view, size_t> &calls() { return recorded; }
+
+private:
+  static inline bool null = false; //!< Whether the null backend is in use.
+  static inline std::unordered_map<std::string_view, size_t> recorded{}; //!< The calls recorded by the null backend.
+};
+}
+
+#endif //GL_BACKEND_HPP
@@ -6,6 +6,7 @@
 #define GL_MACROS_HPP
 
 #include "log_view.hpp"
+#include "gl_backend.hpp"
 #include "glad.h"
 
 namespace openvtt::renderer {
@@ -23,6 +24,10 @@ constexpr const char *gl_status_string(const int gl_error) {
 }
 
 #define RAW_GL_MACRO(call, fmt, ...) do { \
+  if (openvtt::renderer::gl_backend::is_null()) { \
+    openvtt::renderer::gl_backend::record(#call); \
+    break; \
+  } \
   call; \
   const auto _ = glGetError(); \
   if(_ != GL_NO_ERROR) \
@@ -35,6 +40,10 @@ constexpr const char *gl_status_string(const int gl_error) {
   } \
 while(false)
 
+#define RAW_GL_VALUE_MACRO(call, fallback) (openvtt::renderer::gl_backend::is_null() ? \
+  (openvtt::renderer::gl_backend::record(#call), (fallback)) : \
+  (call))
+
 #define GL_enable(cap) RAW_GL_MACRO((glEnable(cap)), "cap={}", cap)
 #define GL_disable(cap) RAW_GL_MACRO((glDisable(cap)), "cap={}", cap)
 
@@ -50,6 +59,7 @@ while(false)
 #define GL_vertexAttribPointer(index, size, type, normalized, stride, pointer) RAW_GL_MACRO((glVertexAttribPointer(index, size, type, normalized, stride, pointer)), "index={}, size={}, type={}, normalized={}, stride={}, pointer={}", index, size, type, normalized, stride, pointer)
 #define GL_enableVertexAttribArray(index) RAW_GL_MACRO((glEnableVertexAttribArray(index)), "index={}", index)
 #define GL_vertexAttribDivisor(index, divisor) RAW_GL_MACRO((glVertexAttribDivisor(index, divisor)), "index={}, divisor={}", index, divisor)
+#define GL_vertexAttrib2f(index, x, y) RAW_GL_MACRO((glVertexAttrib2f(index, x, y)), "index={}, x={}, y={}", index, x, y)
 
 #define GL_uniform1i(location, v0) RAW_GL_MACRO((glUniform1i(location, v0)), "location={}, v0={}", location, v0)
 #define GL_uniform1ui(location, v0) RAW_GL_MACRO((glUniform1ui(location, v0)), "location={}, v0={}", location, v0)
@@ -81,8 +91,12 @@ while(false)
 #define GL_genFramebuffers(n, framebuffers) RAW_GL_MACRO((glGenFramebuffers(n, framebuffers)), "n={}, framebuffers={}", n, framebuffers)
 #define GL_bindFramebuffer(target, framebuffer) RAW_GL_MACRO((glBindFramebuffer(target, framebuffer)), "target={}, framebuffer={}", target, framebuffer)
 #define GL_framebufferTexture2D(target, attachment, textarget, texture, level) RAW_GL_MACRO((glFramebufferTexture2D(target, attachment, textarget, texture, level)), "target={}, attachment={}, textarget={}, texture={}, level={}", target, attachment, textarget, texture, level)
+#define GL_checkFramebufferStatus(target) RAW_GL_VALUE_MACRO(glCheckFramebufferStatus(target), static_cast<GLenum>(GL_FRAMEBUFFER_COMPLETE))
 #define GL_deleteFramebuffers(n, framebuffers) RAW_GL_MACRO((glDeleteFramebuffers(n, framebuffers)), "n={}, framebuffers={}", n, framebuffers)
 
+#define GL_createShader(type) RAW_GL_VALUE_MACRO(glCreateShader(type), 0u)
+#define GL_createProgram() RAW_GL_VALUE_MACRO(glCreateProgram(), 0u)
+#define GL_getUniformLocation(program, name) RAW_GL_VALUE_MACRO(glGetUniformLocation(program, name), -1)
 #define GL_shaderSource(shader, count, string, length) RAW_GL_MACRO((glShaderSource(shader, count, string, length)), "shader={}, count={}, string={}, length={}", shader, count, string, length)
 #define GL_compileShader(shader) RAW_GL_MACRO((glCompileShader(shader)), "shader={}", shader)
 #define GL_getShaderiv(shader, pname, params) RAW_GL_MACRO((glGetShaderiv(shader, pname, params)), "shader={}, pname={}, params={}", shader, pname, params)
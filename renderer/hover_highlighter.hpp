@@ -25,13 +25,14 @@ public:
     force_init();
     highlight_fbo->clear();
 
+    // the renderable may have been released since (e.g. by a reload)
     if (std::holds_alternative<render_ref>(last_coll)) {
       const auto &rr = std::get<render_ref>(last_coll);
-      (*rr->coll)->is_hovered = false;
+      if (render_cache::contains(rr)) (*rr->coll)->is_hovered = false;
     }
     else if (std::holds_alternative<std::pair<instanced_render_ref, size_t>>(last_coll)) {
       const auto &[irr, _] = std::get<std::pair<instanced_render_ref, size_t>>(last_coll);
-      (*irr->coll)->is_hovered = false;
+      if (render_cache::contains(irr)) (*irr->coll)->is_hovered = false;
     }
   }
 
@@ -27,12 +27,13 @@ void log_view::render() {
 
   w.with_nerd_icons([]() {
     if (ImGui::Button(reinterpret_cast<const char *>(u8""))) {
-      recent_logs.clear();
+      clear();
       ::log<log_type::DEBUG>("logger", "Cleared!");
     }
   });
   ImGui::SameLine();
   if (ImGui::BeginChild("Scrolling")) {
+    std::scoped_lock guard{lock};
     for (const auto &[src, msg, t]: recent_logs) {
       ImGui::TextColored(color_for(t), "[%10.10s]: %s", src.c_str(), msg.c_str());
     }
@@ -9,6 +9,7 @@
 #include <string>
 #include <iostream>
 #include <format>
+#include <mutex>
 
 template <typename T>
 requires(!std::same_as<T, void> && !std::same_as<T, const void> && !std::same_as<T, char> && !std::same_as<T, const char>)
@@ -58,6 +59,8 @@ struct log_message {
 
 /**
  * @brief Class to handle logging and rendering log messages.
+ *
+ * Messages can be logged from any thread (e.g. by asset decoding jobs).
  */
 class log_view {
 public:
@@ -75,6 +78,7 @@ public:
    * @brief Clears the log, removing all messages.
    */
   static inline void clear() {
+    std::scoped_lock guard{lock};
     recent_logs.clear();
   }
 
@@ -85,6 +89,7 @@ public:
    * This message is both added to the (internal) list of logs to be rendered, and printed to the console.
    */
   static inline void log(const log_message &message) {
+    std::scoped_lock guard{lock};
     recent_logs.push_back(message);
     std::cout << std::format("[{:10.10s}]: {}\n", message.source, message.message);
   }
@@ -95,6 +100,7 @@ public:
   static void render();
 private:
   static inline std::vector<log_message> recent_logs{};
+  static inline std::mutex lock{}; //!< Protects `recent_logs` (and keeps console lines from interleaving).
 };
 
 /**
@@ -2,6 +2,10 @@
 // Created by jay on 11/30/24.
 //
 
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <ranges>
 #include <assimp/Importer.hpp>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -10,11 +14,13 @@
 #include "window.hpp"
 #include "object.hpp"
 #include "filesys.hpp"
+#include "perlin.hpp"
+#include "worker_pool.hpp"
 
 using namespace openvtt::renderer;
 
 render_object::render_object(const std::vector<vertex_spec> &vs, const std::vector<unsigned int> &index) : elements{index.size()} {
-  window::get(); // force initialized
+  gl_backend::ensure_context();
   std::vector<float> vertex_buffer;
   vertex_buffer.reserve(vs.size() * 8);
   for (const auto &[pos, uv, norm]: vs) {
@@ -43,7 +49,7 @@ render_object::render_object(const std::vector<vertex_spec> &vs, const std::vect
   GL_bindVertexArray(0);
 }
 
-render_object render_object::load_from(const std::string &asset) {
+render_object::decoded render_object::decode(const std::string &asset) {
   Assimp::Importer importer;
   const std::string path = asset_path<asset_type::MODEL_OBJ>(asset);
   const aiScene *scene = importer.ReadFile(
@@ -108,7 +114,7 @@ render_object render_object::load_from(const std::string &asset) {
     indices.push_back(face.mIndices[2]);
   }
 
-  return {vertices, indices};
+  return {std::move(vertices), std::move(indices)};
 }
 
 void render_object::draw(const shader &s) const {
@@ -128,7 +134,7 @@ render_object::~render_object() {
   GL_deleteBuffers(1, &ebo);
 }
 
-instanced_object::instanced_object(render_object &&ro, const std::vector<glm::mat4> &models)
+instanced_object::instanced_object(render_object &&ro, std::span<const glm::mat4> models)
   : render_object(std::move(ro)) {
   bind_vao();
   GL_genBuffers(1, &model_vbo);
@@ -191,14 +197,18 @@ constexpr static unsigned int indices[48] {
   4, 12, 7,   12, 5, 8,   6, 11, 7,   7, 12, 8
 };
 
-voxel_group::voxel_group(
-  glm::vec3 background_colors[9], glm::vec3 spot_colors[9], const float factors[9],
-  const std::vector<glm::vec2> &centers, const glm::mat4x3 &tiered_perlin
-) : tiered_perlin{tiered_perlin}, instances{centers.size()} {
-  float raw_data[13 * 9];
+/**
+ * @brief Writes the vertex data of a voxel patch (13 vertices of 9 floats each) around a center.
+ *
+ * The 4 inner vertices get a mix of the surrounding corners.
+ */
+static void patch_data(
+  const glm::vec3 *background_colors, const glm::vec3 *spot_colors, const float *factors, const glm::vec2 &center,
+  float *raw_data
+) {
   for (int i = 0; i < 9; i++) {
-    raw_data[9 * i + 0] = positions[i].x;
-    raw_data[9 * i + 1] = positions[i].y;
+    raw_data[9 * i + 0] = center.x + positions[i].x;
+    raw_data[9 * i + 1] = center.y + positions[i].y;
 
     raw_data[9 * i + 2] = background_colors[i].r;
     raw_data[9 * i + 3] = background_colors[i].g;
@@ -230,8 +240,8 @@ voxel_group::voxel_group(
     0.3f * (factors[5] + factors[7] + factors[8]) + 0.1f * factors[4]
   };
   for (int i = 0; i < 4; i++) {
-    raw_data[9 * (9 + i) + 0] = positions[9 + i].x;
-    raw_data[9 * (9 + i) + 1] = positions[9 + i].y;
+    raw_data[9 * (9 + i) + 0] = center.x + positions[9 + i].x;
+    raw_data[9 * (9 + i) + 1] = center.y + positions[9 + i].y;
 
     raw_data[9 * (9 + i) + 2] = mixed_bg[i].r;
     raw_data[9 * (9 + i) + 3] = mixed_bg[i].g;
@@ -243,13 +253,12 @@ voxel_group::voxel_group(
 
     raw_data[9 * (9 + i) + 8] = mixed_f[i];
   }
+}
 
-  GL_genVertexArrays(1, &vao);
-  GL_bindVertexArray(vao);
-
-  GL_genBuffers(1, &vbo);
-  GL_bindBuffer(GL_ARRAY_BUFFER, vbo);
-  GL_bufferData(GL_ARRAY_BUFFER, sizeof(raw_data), raw_data, GL_STATIC_DRAW);
+/**
+ * @brief Sets up the vertex attributes for voxel vertex data, in the currently bound VAO and VBO.
+ */
+static void patch_attributes() {
   GL_vertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 9 * sizeof(float), nullptr);
   GL_enableVertexAttribArray(0);
   GL_vertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 9 * sizeof(float), reinterpret_cast<void *>(2 * sizeof(float)));
@@ -258,6 +267,22 @@ voxel_group::voxel_group(
   GL_enableVertexAttribArray(2);
   GL_vertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, 9 * sizeof(float), reinterpret_cast<void *>(8 * sizeof(float)));
   GL_enableVertexAttribArray(3);
+}
+
+voxel_group::voxel_group(
+  glm::vec3 background_colors[9], glm::vec3 spot_colors[9], const float factors[9],
+  const std::vector<glm::vec2> &centers, const glm::mat4x3 &tiered_perlin
+) : tiered_perlin{tiered_perlin}, instances{centers.size()} {
+  float raw_data[13 * 9];
+  patch_data(background_colors, spot_colors, factors, {0.0f, 0.0f}, raw_data);
+
+  GL_genVertexArrays(1, &vao);
+  GL_bindVertexArray(vao);
+
+  GL_genBuffers(1, &vbo);
+  GL_bindBuffer(GL_ARRAY_BUFFER, vbo);
+  GL_bufferData(GL_ARRAY_BUFFER, sizeof(raw_data), raw_data, GL_STATIC_DRAW);
+  patch_attributes();
 
   GL_genBuffers(1, &center_vbo);
   GL_bindBuffer(GL_ARRAY_BUFFER, center_vbo);
@@ -292,4 +317,198 @@ voxel_group::~voxel_group() {
   GL_deleteBuffers(1, &vbo);
   GL_deleteBuffers(1, &center_vbo);
   GL_deleteBuffers(1, &ebo);
-}
\ No newline at end of file
+}
+
+bool voxel_tile::uniform() const {
+  return std::ranges::all_of(back, [this](const glm::vec3 &c) { return c == back[0]; }) &&
+    std::ranges::all_of(spot, [this](const glm::vec3 &c) { return c == spot[0]; }) &&
+    std::ranges::all_of(fac, [this](const float f) { return f == fac[0]; });
+}
+
+/**
+ * @brief Meshes a single chunk of voxel terrain.
+ * @param origin The grid coordinates of the chunk's first tile.
+ * @param grid The tiles in the chunk (row by row; `nullptr` for missing tiles).
+ * @return The mesh of the chunk.
+ *
+ * Uniform tiles are merged greedily: the first unmerged tile (in row order) is extended to the right as long as the
+ * tiles are identical, and then downwards as long as the whole row is identical.
+ */
+static voxel_terrain::chunk_mesh mesh_chunk(const glm::ivec2 &origin, const std::vector<const voxel_tile *> &grid) {
+  constexpr int cs = voxel_terrain::chunk_size;
+  voxel_terrain::chunk_mesh mesh{
+    {}, {},
+    glm::vec3{std::numeric_limits<float>::max(), -voxel_terrain::chunk_height, std::numeric_limits<float>::max()},
+    glm::vec3{std::numeric_limits<float>::lowest(), voxel_terrain::chunk_height, std::numeric_limits<float>::lowest()},
+    0, 0, origin, {}
+  };
+
+  std::vector<char> uniform(grid.size());
+  std::vector<char> done(grid.size());
+  for (size_t i = 0; i < grid.size(); i++) uniform[i] = grid[i] != nullptr && grid[i]->uniform();
+
+  const auto extend_bounds = [&mesh](const glm::vec2 &from, const glm::vec2 &to) {
+    mesh.min.x = std::min(mesh.min.x, from.x);
+    mesh.min.z = std::min(mesh.min.z, from.y);
+    mesh.max.x = std::max(mesh.max.x, to.x);
+    mesh.max.z = std::max(mesh.max.z, to.y);
+  };
+
+  for (int y = 0; y < cs; y++) {
+    for (int x = 0; x < cs; x++) {
+      const size_t idx = y * cs + x;
+      const voxel_tile *tile = grid[idx];
+      if (tile == nullptr || done[idx]) continue;
+      const glm::vec2 center{origin + glm::ivec2{x, y}};
+      const auto base = static_cast<unsigned int>(mesh.vertices.size() / 9);
+
+      if (!uniform[idx]) {
+        float raw_data[13 * 9];
+        patch_data(tile->back.data(), tile->spot.data(), tile->fac.data(), center, raw_data);
+        mesh.vertices.insert(mesh.vertices.end(), std::begin(raw_data), std::end(raw_data));
+        for (const auto i : indices) mesh.indices.push_back(base + i);
+        extend_bounds(center - 0.5f, center + 0.5f);
+        done[idx] = true;
+        mesh.patches++;
+        continue;
+      }
+
+      const auto fits = [&](const int xx, const int yy) {
+        const size_t j = yy * cs + xx;
+        return uniform[j] && !done[j] && grid[j]->same_corners(*tile);
+      };
+      int w = 1;
+      while (x + w < cs && fits(x + w, y)) w++;
+      int h = 1;
+      while (y + h < cs && std::ranges::all_of(std::views::iota(x, x + w), [&](const int xx) { return fits(xx, y + h); })) h++;
+      for (int yy = y; yy < y + h; yy++) {
+        for (int xx = x; xx < x + w; xx++) done[yy * cs + xx] = true;
+      }
+
+      const glm::vec2 from = center - 0.5f;
+      const glm::vec2 to = from + glm::vec2{w, h};
+      for (const glm::vec2 &corner : {from, glm::vec2{to.x, from.y}, glm::vec2{from.x, to.y}, to}) {
+        mesh.vertices.insert(mesh.vertices.end(), {
+          corner.x, corner.y,
+          tile->back[0].r, tile->back[0].g, tile->back[0].b,
+          tile->spot[0].r, tile->spot[0].g, tile->spot[0].b,
+          tile->fac[0]
+        });
+      }
+      mesh.indices.insert(mesh.indices.end(), {base, base + 1, base + 2, base + 1, base + 3, base + 2});
+      extend_bounds(from, to);
+      mesh.merged++;
+    }
+  }
+
+  return mesh;
+}
+
+voxel_terrain::decoded voxel_terrain::decode(const std::span<const voxel_tile> tiles, const glm::mat4x3 &tiered_perlin) {
+  constexpr int cs = chunk_size;
+  const auto chunk_of = [](const glm::ivec2 &at) {
+    // rounds down, also for negative coordinates
+    return glm::ivec2{at.x >= 0 ? at.x / cs : (at.x - cs + 1) / cs, at.y >= 0 ? at.y / cs : (at.y - cs + 1) / cs};
+  };
+
+  // group the tiles per chunk (stable, so later tiles overwrite earlier ones at the same position)
+  std::vector<size_t> order(tiles.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::ranges::stable_sort(order, [&](const size_t a, const size_t b) {
+    const auto ca = chunk_of(tiles[a].at), cb = chunk_of(tiles[b].at);
+    return ca.y != cb.y ? ca.y < cb.y : ca.x < cb.x;
+  });
+
+  std::vector<std::future<chunk_mesh>> jobs;
+  for (size_t begin = 0; begin < order.size();) {
+    const glm::ivec2 chunk = chunk_of(tiles[order[begin]].at);
+    const glm::ivec2 origin = chunk * cs;
+    std::vector<const voxel_tile *> grid(cs * cs);
+
+    size_t end = begin;
+    for (; end < order.size() && chunk_of(tiles[order[end]].at) == chunk; end++) {
+      const auto &tile = tiles[order[end]];
+      grid[(tile.at.y - origin.y) * cs + (tile.at.x - origin.x)] = &tile;
+    }
+
+    jobs.push_back(worker_pool::shared().submit([origin, grid = std::move(grid), &tiered_perlin] {
+      auto mesh = mesh_chunk(origin, grid);
+      mesh.noise = bake_tiered_perlin(tiered_perlin, glm::vec2{origin} - 0.5f, cs, cs * noise_resolution);
+      return mesh;
+    }));
+    begin = end;
+  }
+
+  decoded res{{}, tiered_perlin};
+  res.chunks.reserve(jobs.size());
+  for (auto &job : jobs) res.chunks.push_back(job.get());
+  return res;
+}
+
+voxel_terrain voxel_terrain::from_decoded(decoded &&d) {
+  return voxel_terrain{std::move(d)};
+}
+
+voxel_terrain::voxel_terrain(decoded &&d) : tiered_perlin{d.tiered_perlin} {
+  gl_backend::ensure_context();
+  chunks.reserve(d.chunks.size());
+  for (const auto &mesh : d.chunks) {
+    auto &[vao, vbo, ebo, noise, elements, origin, min, max] = chunks.emplace_back();
+    elements = mesh.indices.size();
+    origin = mesh.origin;
+    min = mesh.min;
+    max = mesh.max;
+
+    GL_genVertexArrays(1, &vao);
+    GL_bindVertexArray(vao);
+
+    GL_genBuffers(1, &vbo);
+    GL_bindBuffer(GL_ARRAY_BUFFER, vbo);
+    GL_bufferData(GL_ARRAY_BUFFER, mesh.vertices.size() * sizeof(float), mesh.vertices.data(), GL_STATIC_DRAW);
+    patch_attributes();
+
+    GL_genBuffers(1, &ebo);
+    GL_bindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    GL_bufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.indices.size() * sizeof(unsigned int), mesh.indices.data(), GL_STATIC_DRAW);
+
+    constexpr int texels = chunk_size * noise_resolution;
+    GL_genTextures(1, &noise);
+    GL_bindTexture(GL_TEXTURE_2D, noise);
+    GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    GL_texImage2D(GL_TEXTURE_2D, 0, GL_R32F, texels, texels, 0, GL_RED, GL_FLOAT, mesh.noise.data());
+    GL_bindTexture(GL_TEXTURE_2D, 0);
+  }
+}
+
+size_t voxel_terrain::draw(const shader &s, const frustum &view) const {
+  s.activate();
+  s.set_int(s.loc_for("noise"), 0);
+  s.set_float(s.loc_for("chunk_extent"), static_cast<float>(chunk_size));
+  const auto origin_loc = s.loc_for("chunk_origin");
+  // vertices are in grid coordinates already; the per-instance center of voxel groups is fixed at the origin
+  GL_vertexAttrib2f(4, 0.0f, 0.0f);
+  GL_activeTexture(GL_TEXTURE0);
+
+  size_t drawn = 0;
+  for (const auto &[vao, vbo, ebo, noise, elements, origin, min, max] : chunks) {
+    if (!view.intersects(min, max)) continue;
+    s.set_vec2(origin_loc, origin);
+    GL_bindTexture(GL_TEXTURE_2D, noise);
+    GL_bindVertexArray(vao);
+    GL_drawElements(GL_TRIANGLES, elements, GL_UNSIGNED_INT, nullptr);
+    drawn++;
+  }
+  return drawn;
+}
+
+voxel_terrain::~voxel_terrain() {
+  for (const auto &c : chunks) {
+    GL_deleteVertexArrays(1, &c.vao);
+    GL_deleteBuffers(1, &c.vbo);
+    GL_deleteBuffers(1, &c.ebo);
+    GL_deleteTextures(1, &c.noise);
+  }
+}
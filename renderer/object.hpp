@@ -5,10 +5,13 @@
 #ifndef OBJECT_HPP
 #define OBJECT_HPP
 
+#include <array>
 #include <string>
 #include <vector>
+#include <span>
 #include <glm/glm.hpp>
 
+#include "frustum.hpp"
 #include "shader.hpp"
 #include "glm_wrapper.hpp"
 
@@ -27,6 +30,14 @@ struct vertex_spec {
  */
 class render_object {
 public:
+  /**
+   * @brief Structure holding a decoded (but not yet uploaded) mesh.
+   */
+  struct decoded {
+    std::vector<vertex_spec> vertices; //!< The vertices of the mesh.
+    std::vector<unsigned int> indices; //!< The indices of the mesh.
+  };
+
   /**
    * @brief Construct a new render object.
    *
@@ -57,7 +68,23 @@ public:
    *
    * The asset's path is computed using @ref openvtt::asset_path.
    */
-  static render_object load_from(const std::string &asset);
+  static render_object load_from(const std::string &asset) { return from_decoded(decode(asset)); }
+
+  /**
+   * @brief Decodes a mesh from a file, without touching OpenGL.
+   * @param asset The path to the asset.
+   * @return The decoded mesh (empty if loading failed).
+   *
+   * This function is thread-safe, so it can be run on a worker thread (see `render_cache::load`).
+   */
+  static decoded decode(const std::string &asset);
+
+  /**
+   * @brief Uploads a decoded mesh to the GPU.
+   * @param d The decoded mesh.
+   * @return The object.
+   */
+  static render_object from_decoded(decoded &&d) { return {d.vertices, d.indices}; }
 
   render_object(const render_object &other) = delete;
   constexpr render_object(render_object &&other) noexcept {
@@ -94,10 +121,10 @@ public:
    * @param index The indices of the object (see render_object::render_object).
    * @param models The model matrices of the instances.
    *
-   * The vertices and indices are passed straight through to the render_object constructor. The model matrices are copied
-   * by the constructor and moved to the GPU.
+   * The vertices and indices are passed straight through to the render_object constructor. The model matrices are
+   * uploaded to the GPU straight from the given span.
    */
-  inline instanced_object(const std::vector<vertex_spec> &vs, const std::vector<unsigned int> &index, const std::vector<glm::mat4> &models)
+  inline instanced_object(const std::vector<vertex_spec> &vs, const std::vector<unsigned int> &index, std::span<const glm::mat4> models)
     : instanced_object(std::move(render_object(vs, index)), models) {}
   constexpr instanced_object(instanced_object &&other) noexcept : render_object(std::move(other)) {
     std::swap(model_vbo, other.model_vbo);
@@ -121,10 +148,37 @@ public:
    *
    * The asset's path is computed using @ref openvtt::asset_path.
    */
-  inline static instanced_object load_from(const std::string &asset, const std::vector<glm::mat4> &models) {
+  inline static instanced_object load_from(const std::string &asset, std::span<const glm::mat4> models) {
     return {render_object::load_from(asset), models};
   }
 
+  /**
+   * @brief Structure holding a decoded (but not yet uploaded) instanced object.
+   */
+  struct decoded {
+    render_object::decoded mesh; //!< The decoded mesh.
+    std::vector<glm::mat4> models; //!< The model matrices of the instances.
+  };
+
+  /**
+   * @brief Decodes an instanced object, without touching OpenGL.
+   * @param asset The path to the asset.
+   * @param models The model matrices of the instances (copied).
+   * @return The decoded object.
+   */
+  static decoded decode(const std::string &asset, const std::span<const glm::mat4> models) {
+    return {render_object::decode(asset), {models.begin(), models.end()}};
+  }
+
+  /**
+   * @brief Uploads a decoded instanced object to the GPU.
+   * @param d The decoded object.
+   * @return The instanced object.
+   */
+  static instanced_object from_decoded(decoded &&d) {
+    return {render_object::from_decoded(std::move(d.mesh)), d.models};
+  }
+
   /**
    * @brief Create a model matrix for a given position, scale, and yaw-pitch-roll angles.
    * @param ypr The yaw-pitch-roll angles.
@@ -146,7 +200,7 @@ public:
 
   ~instanced_object() override;
 private:
-  instanced_object(render_object &&ro, const std::vector<glm::mat4> &models);
+  instanced_object(render_object &&ro, std::span<const glm::mat4> models);
   unsigned int model_vbo = 0; //!< The additional VBO for the model matrices.
   unsigned int model_inv_t_vbo = 0; //!< The additional VBO for the inverse-transpose of the model matrices.
   size_t instances = -1ul; //!< The number of instances.
@@ -193,6 +247,145 @@ private:
   unsigned int vao = 0;
   size_t instances = 0;
 };
+
+/**
+ * @brief Structure describing a single tile of voxel terrain.
+ *
+ * The corners are laid out like for `voxel_group`: row by row, from the top-left to the bottom-right corner (with the
+ * centers of the edges and of the tile in between).
+ */
+struct voxel_tile {
+  glm::ivec2 at; //!< The grid coordinates of the (center of the) tile.
+  std::array<glm::vec3, 9> back; //!< The background colors of the corners.
+  std::array<glm::vec3, 9> spot; //!< The spot colors of the corners.
+  std::array<float, 9> fac; //!< The mixing factors of the corners.
+
+  /**
+   * @brief Checks whether all corners of the tile look the same, so it can be merged with identical neighbors.
+   * @return `true` if all corners have the same colors and factor.
+   */
+  [[nodiscard]] bool uniform() const;
+
+  /**
+   * @brief Checks whether two tiles have the same corners (regardless of their position).
+   * @param other The other tile.
+   * @return `true` if all corners are the same.
+   */
+  [[nodiscard]] bool same_corners(const voxel_tile &other) const {
+    return back == other.back && spot == other.spot && fac == other.fac;
+  }
+};
+
+/**
+ * @brief A class representing a (large) voxel terrain, split into chunks.
+ *
+ * Tiles are grouped into chunks of `chunk_size` by `chunk_size` tiles, each with its own buffers and bounds, so chunks
+ * outside the view frustum can be skipped. Within a chunk, uniform tiles (see `voxel_tile::uniform`) are merged
+ * greedily into rectangles of identical tiles, each drawn as a single quad; other tiles get the same 13-vertex patch
+ * as in a `voxel_group`. Vertices are in grid coordinates (with the per-instance center of voxel groups fixed at the
+ * origin). The terrain lies in the XZ plane: grid coordinates `(x, y)` map to `(x, 0, y)`.
+ *
+ * The tiered Perlin noise is baked into a texture per chunk (`noise_resolution` texels per tile) when the terrain is
+ * meshed, so the fragment shader (`voxel.fs.glsl`) only samples it, instead of evaluating the noise every frame.
+ */
+class voxel_terrain {
+public:
+  constexpr static int chunk_size = 32; //!< The width and height of a chunk (in tiles).
+  constexpr static float chunk_height = 0.5f; //!< The height (above and below the plane) of the bounds of a chunk.
+  constexpr static int noise_resolution = 8; //!< The amount of noise texels along each side of a tile.
+
+  /**
+   * @brief Structure holding the (CPU-side) mesh of a single chunk.
+   */
+  struct chunk_mesh {
+    std::vector<float> vertices; //!< The vertex data (position, background color, spot color, factor).
+    std::vector<unsigned int> indices; //!< The indices (triangles).
+    glm::vec3 min; //!< The minimal corner of the chunk's bounds.
+    glm::vec3 max; //!< The maximal corner of the chunk's bounds.
+    size_t merged; //!< The amount of quads of merged tiles in the chunk.
+    size_t patches; //!< The amount of (non-merged) tile patches in the chunk.
+    glm::vec2 origin; //!< The grid coordinates of the chunk's first tile.
+    std::vector<float> noise; //!< The baked noise, covering the whole chunk (see `bake_tiered_perlin`).
+  };
+
+  /**
+   * @brief Structure holding a meshed (but not yet uploaded) terrain.
+   */
+  struct decoded {
+    std::vector<chunk_mesh> chunks; //!< The meshes of the (non-empty) chunks.
+    glm::mat4x3 tiered_perlin; //!< The parameters for the tiered Perlin noise.
+  };
+
+  /**
+   * @brief Meshes a terrain, and bakes its noise, without touching OpenGL.
+   * @param tiles The tiles (if several tiles have the same coordinates, the last one wins).
+   * @param tiered_perlin The parameters for the tiered Perlin noise (see `tiered_perlin`).
+   * @return The meshed terrain.
+   *
+   * Chunks are meshed and baked in parallel on the shared worker pool, so this should not be called from a job on that
+   * pool itself.
+   */
+  static decoded decode(std::span<const voxel_tile> tiles, const glm::mat4x3 &tiered_perlin);
+
+  /**
+   * @brief Uploads a meshed terrain to the GPU.
+   * @param d The meshed terrain.
+   * @return The terrain.
+   */
+  static voxel_terrain from_decoded(decoded &&d);
+
+  /**
+   * @brief Constructs a new voxel terrain.
+   * @param tiles The tiles.
+   * @param tiered_perlin The parameters for the tiered Perlin noise.
+   */
+  voxel_terrain(const std::span<const voxel_tile> tiles, const glm::mat4x3 &tiered_perlin)
+    : voxel_terrain(decode(tiles, tiered_perlin)) {}
+  voxel_terrain(const voxel_terrain &other) = delete;
+  voxel_terrain(voxel_terrain &&other) noexcept {
+    std::swap(chunks, other.chunks);
+    std::swap(tiered_perlin, other.tiered_perlin);
+  }
+
+  /**
+   * @brief Renders the chunks of the terrain in the view frustum.
+   * @param s The shader to use (typically `voxel`, which samples the baked noise).
+   * @param view The view frustum (see `camera::view_frustum`).
+   * @return The amount of chunks drawn.
+   */
+  size_t draw(const shader &s, const frustum &view) const;
+
+  /**
+   * @brief Gets the amount of (non-empty) chunks in the terrain.
+   * @return The amount of chunks.
+   */
+  [[nodiscard]] size_t chunk_count() const { return chunks.size(); }
+
+  voxel_terrain &operator=(const voxel_terrain &other) = delete;
+  voxel_terrain &operator=(voxel_terrain &&other) = delete;
+
+  ~voxel_terrain();
+
+  glm::mat4x3 tiered_perlin{}; //!< The parameters for the tiered Perlin noise.
+private:
+  explicit voxel_terrain(decoded &&d);
+
+  /**
+   * @brief Structure holding the buffers and bounds of an uploaded chunk.
+   */
+  struct chunk {
+    unsigned int vao = 0; //!< The VAO of the chunk.
+    unsigned int vbo = 0; //!< The VBO of the chunk.
+    unsigned int ebo = 0; //!< The EBO of the chunk.
+    unsigned int noise = 0; //!< The texture holding the baked noise of the chunk.
+    size_t elements = 0; //!< The amount of indices.
+    glm::vec2 origin{}; //!< The grid coordinates of the chunk's first tile.
+    glm::vec3 min{}; //!< The minimal corner of the chunk's bounds.
+    glm::vec3 max{}; //!< The maximal corner of the chunk's bounds.
+  };
+
+  std::vector<chunk> chunks{};
+};
 }
 
 #endif //OBJECT_HPP
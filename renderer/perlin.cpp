@@ -0,0 +1,180 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#include <algorithm>
+#include <cmath>
+
+#if __has_include(<experimental/simd>)
+#include <experimental/simd>
+#define OPENVTT_PERLIN_SIMD
+#endif
+
+#include "perlin.hpp"
+
+using namespace openvtt::renderer;
+
+namespace {
+#ifdef OPENVTT_PERLIN_SIMD
+namespace stdx = std::experimental;
+using floatv = stdx::native_simd<float>; //!< A SIMD register of floats.
+constexpr size_t lanes = floatv::size(); //!< The amount of points evaluated at once.
+
+floatv step(const floatv &edge, const floatv &x) {
+  floatv res = 1.0f;
+  stdx::where(x < edge, res) = 0.0f;
+  return res;
+}
+#else
+constexpr size_t lanes = 1;
+#endif
+
+float step(const float edge, const float x) { return x < edge ? 0.0f : 1.0f; }
+
+// the helpers below are written once for both `float` and `floatv`, following perlin.fs.glsl
+
+template <typename F>
+F fract(const F &x) {
+  using std::floor;
+  return x - floor(x);
+}
+
+template <typename F>
+F mod289(const F &x) {
+  using std::floor;
+  return x - floor(x * (1.0f / 289.0f)) * 289.0f;
+}
+
+template <typename F>
+F permute(const F &x) {
+  return mod289((x * 34.0f + 1.0f) * x);
+}
+
+template <typename F>
+F fade(const F &t) {
+  return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+}
+
+template <typename F>
+F mix(const F &x, const F &y, const F &a) {
+  return x * (1.0f - a) + y * a;
+}
+
+/**
+ * @brief Computes the contribution of a single corner: the dot product of its (hashed) gradient and the offset.
+ */
+template <typename F>
+F corner(const F &hash, const F &dx, const F &dy, const F &dz) {
+  using std::abs, std::floor, std::sqrt;
+  F gx = hash * (1.0f / 7.0f);
+  F gy = fract(F(floor(gx) * (1.0f / 7.0f))) - 0.5f;
+  gx = fract(gx);
+  const F gz = 0.5f - abs(gx) - abs(gy);
+  const F sz = step(gz, F(0.0f));
+  gx -= sz * (step(F(0.0f), gx) - 0.5f);
+  gy -= sz * (step(F(0.0f), gy) - 0.5f);
+
+  // the shader scales the gradient by its length
+  const F norm = sqrt(gx * gx + gy * gy + gz * gz);
+  return gx * norm * dx + gy * norm * dy + gz * norm * dz;
+}
+
+template <typename F>
+F perlin_at(const F &x, const F &y, const F &z) {
+  using std::floor;
+  const F ix = floor(x), iy = floor(y), iz = floor(z);
+  const F fx = x - ix, fy = y - iy, fz = z - iz;
+  const F fx1 = fx - 1.0f, fy1 = fy - 1.0f, fz1 = fz - 1.0f;
+
+  const F ix0 = mod289(ix), ix1 = mod289(F(ix + 1.0f));
+  const F iy0 = mod289(iy), iy1 = mod289(F(iy + 1.0f));
+  const F iz0 = mod289(iz), iz1 = iz0 + 1.0f;
+
+  const F px0 = permute(ix0), px1 = permute(ix1);
+  const F h00 = permute(F(px0 + iy0)), h10 = permute(F(px1 + iy0));
+  const F h01 = permute(F(px0 + iy1)), h11 = permute(F(px1 + iy1));
+
+  const F n000 = corner(permute(F(h00 + iz0)), fx, fy, fz);
+  const F n100 = corner(permute(F(h10 + iz0)), fx1, fy, fz);
+  const F n010 = corner(permute(F(h01 + iz0)), fx, fy1, fz);
+  const F n110 = corner(permute(F(h11 + iz0)), fx1, fy1, fz);
+  const F n001 = corner(permute(F(h00 + iz1)), fx, fy, fz1);
+  const F n101 = corner(permute(F(h10 + iz1)), fx1, fy, fz1);
+  const F n011 = corner(permute(F(h01 + iz1)), fx, fy1, fz1);
+  const F n111 = corner(permute(F(h11 + iz1)), fx1, fy1, fz1);
+
+  const F tx = fade(fx), ty = fade(fy), tz = fade(fz);
+  const F z00 = mix(n000, n001, tz), z10 = mix(n100, n101, tz);
+  const F z01 = mix(n010, n011, tz), z11 = mix(n110, n111, tz);
+  return 2.2f * mix(mix(z00, z01, ty), mix(z10, z11, ty), tx);
+}
+
+/**
+ * @brief Evaluates Perlin noise for points given as separate coordinate arrays.
+ */
+void perlin_soa(const float *xs, const float *ys, const float *zs, float *out, const size_t count) {
+  size_t i = 0;
+#ifdef OPENVTT_PERLIN_SIMD
+  for (; i + lanes <= count; i += lanes) {
+    const floatv x(xs + i, stdx::element_aligned), y(ys + i, stdx::element_aligned), z(zs + i, stdx::element_aligned);
+    perlin_at(x, y, z).copy_to(out + i, stdx::element_aligned);
+  }
+#endif
+  for (; i < count; i++) out[i] = perlin_at(xs[i], ys[i], zs[i]);
+}
+}
+
+float openvtt::renderer::perlin(const glm::vec3 &p) {
+  return perlin_at(p.x, p.y, p.z);
+}
+
+void openvtt::renderer::perlin(const std::span<const glm::vec3> points, const std::span<float> out) {
+  std::vector<float> xs(points.size()), ys(points.size()), zs(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    xs[i] = points[i].x;
+    ys[i] = points[i].y;
+    zs[i] = points[i].z;
+  }
+  perlin_soa(xs.data(), ys.data(), zs.data(), out.data(), points.size());
+}
+
+float openvtt::renderer::tiered_perlin(const glm::mat4x3 &tiers, const glm::vec2 &p) {
+  float total = 0.0f, weights = 0.0f;
+  for (int i = 0; i < 4; i++) {
+    const glm::vec3 &tier = tiers[i]; // (alpha, beta, delta)
+    if (tier.x == 0.0f) continue;
+    total += tier.x * perlin(glm::vec3{tier.y * p + tier.z, tiered_perlin_z});
+    weights += tier.x;
+  }
+  return weights == 0.0f ? 0.0f : total / weights;
+}
+
+std::vector<float> openvtt::renderer::bake_tiered_perlin(
+  const glm::mat4x3 &tiers, const glm::vec2 &from, const float extent, const int texels
+) {
+  const auto size = static_cast<size_t>(texels);
+  std::vector<float> res(size * size, 0.0f);
+  const float texel = extent / static_cast<float>(texels);
+
+  float weights = 0.0f;
+  std::vector<float> xs(size), ys(size), zs(size, tiered_perlin_z), noise(size);
+  for (int i = 0; i < 4; i++) {
+    const glm::vec3 &tier = tiers[i];
+    const float alpha = tier.x, beta = tier.y, delta = tier.z;
+    if (alpha == 0.0f) continue;
+    weights += alpha;
+
+    for (size_t col = 0; col < size; col++) xs[col] = beta * (from.x + (static_cast<float>(col) + 0.5f) * texel) + delta;
+    for (size_t row = 0; row < size; row++) {
+      std::ranges::fill(ys, beta * (from.y + (static_cast<float>(row) + 0.5f) * texel) + delta);
+      perlin_soa(xs.data(), ys.data(), zs.data(), noise.data(), size);
+      float *out = res.data() + row * size;
+      for (size_t col = 0; col < size; col++) out[col] += alpha * noise[col];
+    }
+  }
+
+  if (weights != 0.0f) {
+    for (float &v : res) v /= weights;
+  }
+  return res;
+}
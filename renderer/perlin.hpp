@@ -0,0 +1,65 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef PERLIN_HPP
+#define PERLIN_HPP
+
+#include <span>
+#include <vector>
+#include <glm/glm.hpp>
+
+namespace openvtt::renderer {
+/**
+ * @brief Evaluates 3D Perlin noise on the CPU.
+ * @param p The point to evaluate the noise at.
+ * @return The noise value (roughly in `[-1, 1]`).
+ *
+ * This is a port of `perlin()` in `perlin.fs.glsl`, operation by operation, so it matches the shader up to
+ * floating-point rounding (on the GPU, and from contracted multiply-adds).
+ */
+float perlin(const glm::vec3 &p);
+
+/**
+ * @brief Evaluates 3D Perlin noise on the CPU, for many points at once.
+ * @param points The points to evaluate the noise at.
+ * @param out The noise values (at least as many as there are points).
+ *
+ * The points are evaluated in SIMD lanes (where the standard library supports `std::experimental::simd`); the results
+ * match `perlin(const glm::vec3 &)` up to rounding.
+ */
+void perlin(std::span<const glm::vec3> points, std::span<float> out);
+
+/**
+ * @brief The Z coordinate at which tiered noise samples the (3D) Perlin noise.
+ *
+ * Like the `perlin_z` uniform of `perlin.fs.glsl`, this is fixed; it lies between two lattice planes, so the gradients
+ * of both planes contribute.
+ */
+constexpr float tiered_perlin_z = 0.5f;
+
+/**
+ * @brief Evaluates tiered Perlin noise (several octaves of noise, mixed) on the CPU.
+ * @param tiers The parameters of the tiers; column `i` holds `(alpha_i, beta_i, delta_i)` for tier `i`.
+ * @param p The (2D) point to evaluate the noise at.
+ * @return The noise value: `sum(alpha_i * perlin(vec3(beta_i * p + delta_i, tiered_perlin_z))) / sum(alpha_i)`, or 0
+ * if the alpha values sum to 0.
+ *
+ * Tiers with an alpha value of 0 are skipped. See also `voxel` in `map_visitor.hpp`.
+ */
+float tiered_perlin(const glm::mat4x3 &tiers, const glm::vec2 &p);
+
+/**
+ * @brief Bakes tiered Perlin noise into a (single-channel) texture covering a square area.
+ * @param tiers The parameters of the tiers (see `tiered_perlin`).
+ * @param from The minimal corner of the area.
+ * @param extent The width and height of the area.
+ * @param texels The width and height of the texture.
+ * @return The texels (row by row, starting at `from`), each sampled at its center.
+ *
+ * This is thread-safe, so textures can be baked on worker threads.
+ */
+std::vector<float> bake_tiered_perlin(const glm::mat4x3 &tiers, const glm::vec2 &from, float extent, int texels);
+}
+
+#endif //PERLIN_HPP
@@ -4,6 +4,7 @@
 
 #include "gl_macros.hpp"
 #include <imgui.h>
+#include <ranges>
 
 #include "render_cache.hpp"
 
@@ -15,20 +16,22 @@ void render_cache::detail_window() {
   ImGui::Text("%d objects\n%d shaders\n%d textures", objects.size(), shaders.size(), textures.size());
   ImGui::SameLine();
   ImGui::Checkbox("Render Colliders", &render_colliders);
+  ImGui::Text("Asset loads: %zu hits, %zu misses", load_hits, load_misses);
 
 
   int i = 0;
   if (ImGui::BeginChild("Renderables")) {
     if (ImGui::CollapsingHeader("Single objects")) {
       ImGui::Indent(16.0f);
-      for (auto &r: renderables) {
+      for (const auto [_, r]: renderables) {
         ImGui::PushID(i);
         if (ImGui::CollapsingHeader(r.name.empty() ? "(nameless object)" : r.name.c_str())) {
           ImGui::Indent(16.0f);
           ImGui::Checkbox("Active", &r.active);
-          ImGui::InputFloat3("Position", &r.position.x);
-          ImGui::InputFloat3("Rotation", &r.rotation.x);
-          ImGui::InputFloat3("Scale", &r.scale.x);
+          glm::vec3 pos = r.xform.position(), rot = r.xform.rotation(), scale = r.xform.scale();
+          if (ImGui::InputFloat3("Position", &pos.x)) r.xform.set_position(pos);
+          if (ImGui::InputFloat3("Rotation", &rot.x)) r.xform.set_rotation(rot);
+          if (ImGui::InputFloat3("Scale", &scale.x)) r.xform.set_scale(scale);
           ImGui::Unindent(16.0f);
         }
         ImGui::PopID();
@@ -39,7 +42,7 @@ void render_cache::detail_window() {
 
     if (ImGui::CollapsingHeader("Instanced objects")) {
       ImGui::Indent(16.0f);
-      for (auto &r: instanced_renderables) {
+      for (const auto [_, r]: instanced_renderables) {
         ImGui::PushID(i);
         if (ImGui::CollapsingHeader(r.name.empty() ? "(nameless object)" : r.name.c_str())) {
           ImGui::Indent(16.0f);
@@ -65,22 +68,39 @@ void render_cache::detail_window() {
 render_ref render_cache::duplicate(const render_ref &ref, const std::string &name, const std::optional<glm::vec3> &pos,
                                    const std::optional<glm::vec3> &rot, const std::optional<glm::vec3> &scale) {
   const auto &r = *ref;
-  auto &out = renderables.emplace_back(
+  const auto res = construct<renderable>(
     name, r.obj, r.sh,
     uniforms{r.model_loc, r.view_loc, r.proj_loc, r.model_inv_t_loc},
     r.textures
   );
 
-  if (pos.has_value()) out.position = *pos;
-  if (rot.has_value()) out.rotation = *rot;
-  if (scale.has_value()) out.scale = *scale;
+  auto &out = *res;
+  out.xform = r.xform;
+  if (pos.has_value()) out.xform.set_position(*pos);
+  if (rot.has_value()) out.xform.set_rotation(*rot);
+  if (scale.has_value()) out.xform.set_scale(*scale);
 
-  if (r.coll.has_value()) {
-    colliders.emplace_back(**r.coll);
-    out.coll = collider_ref{colliders.size() - 1};
-  }
+  if (r.coll.has_value()) out.coll = construct<collider>(**r.coll);
+
+  return res;
+}
 
-  return render_ref{renderables.size() - 1};
+size_t render_cache::evict_unused() {
+  std::unordered_set<size_t> used_objects, used_instanced, used_textures;
+  const auto mark = [&used_textures]<typename T>(const slot_map<T> &live, std::unordered_set<size_t> &used) {
+    for (const auto [_, r] : live) {
+      used.insert(r.obj.raw());
+      for (const auto &t : r.textures | std::views::values) used_textures.insert(t.raw());
+    }
+  };
+  mark(renderables, used_objects);
+  mark(instanced_renderables, used_instanced);
+
+  const size_t evicted = evict_from<render_object>(used_objects) + evict_from<instanced_object>(used_instanced) +
+    evict_from<texture>(used_textures) + evict_colliders<collider>(used_colliders<renderable>()) +
+    evict_colliders<instanced_collider>(used_colliders<instanced_renderable>());
+  if (evicted > 0) log<log_type::DEBUG>("render_cache", std::format("Evicted {} unused assets", evicted));
+  return evicted;
 }
 
 void render_cache::draw_colliders(const camera &cam) {
@@ -109,7 +129,7 @@ void render_cache::draw_colliders(const camera &cam) {
   sh.activate();
   cam.set_matrices(sh, view_loc, proj_loc);
 
-  for (const auto &r : renderables) {
+  for (const auto [_, r] : renderables) {
     if (r.active && r.coll.has_value()) {
       sh.set_mat4(model_loc, r.model());
       sh.set_bool(highlighted_loc, (*r.coll)->is_hovered);
@@ -120,7 +140,7 @@ void render_cache::draw_colliders(const camera &cam) {
   i_sh.activate();
   cam.set_matrices(i_sh, view_loc_inst, proj_loc_inst);
 
-  for (const auto &r : instanced_renderables) {
+  for (const auto [_, r] : instanced_renderables) {
     if (r.active && r.coll.has_value()) {
       i_sh.set_bool(highlighted_loc_inst, (*r.coll)->is_hovered);
       i_sh.set_uint(highlight_idx_loc, (*r.coll)->highlighted_instance);
@@ -173,13 +193,13 @@ render_cache::collision_res render_cache::mouse_over(const camera &cam) {
   // --- Check for collisions ---
   std::optional<render_ref> res = std::nullopt;
   float t_dist = INFINITY;
-  for (size_t i = 0; i < renderables.size(); i++) {
-    if (renderables[i].active && renderables[i].coll.has_value()) {
-      const float d = (*renderables[i].coll)->ray_intersect(r, renderables[i].model());
+  for (const auto [key, rr] : renderables) {
+    if (rr.active && rr.coll.has_value()) {
+      const float d = (*rr.coll)->ray_intersect(r, rr.model());
 
       if (d < t_dist) {
         t_dist = d;
-        res = render_ref{i};
+        res = render_ref{key};
       }
     }
   }
@@ -187,14 +207,14 @@ render_cache::collision_res render_cache::mouse_over(const camera &cam) {
   // --- Check for collisions with instanced colliders ---
   std::optional<instanced_render_ref> inst_res = std::nullopt;
   size_t inst_idx = 0;
-  for (size_t i = 0; i < instanced_renderables.size(); i++) {
-    if (instanced_renderables[i].active && instanced_renderables[i].coll.has_value()) {
+  for (const auto [key, ir] : instanced_renderables) {
+    if (ir.active && ir.coll.has_value()) {
       // ReSharper disable once CppTooWideScopeInitStatement
-      const auto [d, idx] = (*instanced_renderables[i].coll)->ray_intersect_any(r);
+      const auto [d, idx] = (*ir.coll)->ray_intersect_any(r);
 
       if (d < t_dist) {
         t_dist = d;
-        inst_res = instanced_render_ref{i};
+        inst_res = instanced_render_ref{key};
         inst_idx = idx;
       }
     }
@@ -6,8 +6,19 @@
 #define RENDER_CACHE_HPP
 
 #include <vector>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <limits>
+#include <future>
+#include <span>
+#include <ranges>
 
 #include "util.hpp"
+#include "slot_map.hpp"
+#include "worker_pool.hpp"
 #include "camera.hpp"
 #include "window.hpp"
 #include "object.hpp"
@@ -49,12 +60,15 @@ public:
   /**
    * @brief Gets the raw value of the reference.
    * @return The raw value of the reference.
+   *
+   * The raw value is the key to the slot in the cache (see `slot_map`), so it is unique: a reference to a released
+   * value never has the same raw value as a reference to the value that reuses its slot.
    */
   [[nodiscard]] constexpr size_t raw() const { return idx; }
 
 private:
   constexpr explicit t_ref(const size_t idx) : idx{idx} {}
-  size_t idx;
+  size_t idx; //!< The key to the slot in the cache.
   friend class render_cache;
 };
 
@@ -127,14 +141,86 @@ concept loadable = requires(Args &&... args)
 {
   { T::load_from(std::forward<Args>(args)...) } -> std::same_as<T>;
 };
+
+/**
+ * @brief Concept for checking if a type can be loaded in two steps: decoding (on any thread) and uploading (on the GL
+ * thread).
+ *
+ * For this, the type must have a nested `decoded` type, a static member function `decode` that takes the arguments
+ * provided and returns a `decoded`, and a static member function `from_decoded` that turns a `decoded` into the type.
+ */
+template <typename T, typename ... Args>
+concept decodable = requires(Args &&... args, typename T::decoded &&d)
+{
+  { T::decode(std::forward<Args>(args)...) } -> std::same_as<typename T::decoded>;
+  { T::from_decoded(std::move(d)) } -> std::same_as<T>;
+};
+
+/**
+ * @brief Helper to turn an argument into a value that owns its data (so it can be passed to a worker thread).
+ * @tparam T The (decayed) argument type.
+ *
+ * Most types are simply copied; spans are copied into a vector.
+ */
+template <typename T> struct owned_arg {
+  using type = T; //!< The owning type.
+  static type make(const T &x) { return x; } //!< Creates an owning copy.
+};
+template <typename T, size_t N> struct owned_arg<std::span<T, N>> {
+  using type = std::vector<std::remove_const_t<T>>;
+  static type make(const std::span<T, N> &x) { return {x.begin(), x.end()}; }
+};
+
+/**
+ * @brief Appends a (length-prefixed) string to a cache key.
+ * @param key The key to append to.
+ * @param s The string to append.
+ */
+inline void append_key(std::string &key, const std::string_view s) {
+  const size_t len = s.size();
+  key.append(reinterpret_cast<const char *>(&len), sizeof(len));
+  key.append(s);
+}
+
+/**
+ * @brief Appends the raw contents of a span to a cache key.
+ * @tparam T The element type (should be trivially copyable).
+ * @param key The key to append to.
+ * @param s The span to append.
+ */
+template <typename T, size_t N> requires(std::is_trivially_copyable_v<T>)
+void append_key(std::string &key, const std::span<T, N> s) {
+  const auto bytes = std::as_bytes(s);
+  append_key(key, std::string_view{reinterpret_cast<const char *>(bytes.data()), bytes.size()});
+}
+
+/**
+ * @brief Concept for checking if a set of arguments can be turned into a cache key (using `append_key`).
+ */
+template <typename ... Args>
+concept keyable = requires(std::string &key, const std::remove_cvref_t<Args> &... args)
+{
+  (append_key(key, args), ...);
+};
+
+/**
+ * @brief Checks if cached objects of a type can be shared by everyone loading the same asset.
+ *
+ * This only holds for types that are immutable once loaded. Colliders track their own hover state, so every load of a
+ * collider gets its own copy.
+ */
+template <typename T>
+constexpr bool shareable = cvr_same<T, render_object> || cvr_same<T, instanced_object> || cvr_same<T, shader> ||
+                           cvr_same<T, texture>;
 }
 
 /**
  * @brief A cache of render objects, shaders, textures, colliders, and renderables.
  *
- * Each of the types is stored contiguously in memory, and can be accessed using a reference to the cache. Pointers and
- * references to any object, shader, texture, or renderable can be invalidated if the cache is modified, so it is
- * recommended to not store them. Use the references from the cache instead.
+ * Each of the types is stored in a `slot_map`, and can be accessed using a reference to the cache. Values never move, so
+ * pointers and references to a value stay valid until the value is released (see `release` and `evict_unused`).
+ * References from the cache are generation-checked: dereferencing a reference to a released value throws, and
+ * `contains` can be used to check whether a reference is still live.
  */
 class render_cache {
 public:
@@ -148,23 +234,52 @@ public:
    * @tparam T The type of object to dereference.
    * @param ref The reference (`t_ref<T>`) to the object.
    * @return A reference (`T &`) to the object in the cache.
+   *
+   * Throws a `traced_exception` if the object was released.
    */
   template <typename T>
   constexpr static T &operator[](const t_ref<T> &ref) {
+    flush_until<T>(ref.idx);
     return cache_for<T>()[ref.idx];
   }
 
+  /**
+   * @brief Checks whether a reference refers to a live value in the cache.
+   * @tparam T The type of object to check.
+   * @param ref The reference to check.
+   * @return `true` if the value exists (or is still being loaded), `false` if it was released or evicted.
+   */
+  template <typename T>
+  static bool contains(const t_ref<T> &ref) {
+    flush_until<T>(ref.idx);
+    return cache_for<T>().contains(ref.idx);
+  }
+
   /**
    * @brief Constructs a new value in the cache.
    * @tparam T The type of object to construct.
    * @tparam Args The types of the arguments to pass to the constructor.
    * @param args The arguments to pass to the constructor.
    * @return A reference to the newly constructed object.
+   *
+   * If a slot of the same type was released earlier (see `release`), that slot is reused.
    */
   template <typename T, typename ... Args> requires(std::constructible_from<T, Args...>)
   constexpr static t_ref<T> construct(Args &&... args) {
-    cache_for<T>().emplace_back(std::forward<Args>(args)...);
-    return last_for<T>();
+    return t_ref<T>{cache_for<T>().emplace(std::forward<Args>(args)...)};
+  }
+
+  /**
+   * @brief Releases (destroys) a (spawned) value, so its slot can be reused by a later `construct`.
+   * @tparam T The type of the value (renderable or instanced renderable).
+   * @param ref The reference to the value; it (and any copy of it) becomes stale.
+   *
+   * This is O(1). Releasing a stale reference does nothing. The collider of the value (if any) is destroyed by the next
+   * `evict_unused`, unless another live renderable still uses it.
+   */
+  template <typename T> requires(type_traits::cvr_same<T, renderable> || type_traits::cvr_same<T, instanced_renderable>)
+  static void release(const t_ref<T> &ref) {
+    cache_for<T>().erase(ref.idx);
   }
 
   /**
@@ -173,13 +288,98 @@ public:
    * @tparam Args The types of the arguments to pass to the `load_from` function.
    * @param args The arguments to pass to the `load_from` function.
    * @return A reference to the loaded object.
+   *
+   * If the type is `decodable`, this function returns immediately: decoding (file reads, image decoding, mesh import)
+   * is pushed onto the shared worker pool, and the object is only uploaded (on the calling thread, which should be the
+   * GL thread) once it is first dereferenced, or when `flush` is called. Objects are uploaded in the order in which
+   * they were loaded, so references stay stable.
+   *
+   * Loads of `shareable` types are deduplicated: loading the same asset with the same arguments (e.g. the same model with
+   * the same instance transforms) returns the reference from the first load, instead of loading (and uploading) the
+   * asset again. The amount of hits and misses is shown in the `detail_window`.
+   *
+   * Other (mutable) types can't be shared, but loads from the previous generation (see `begin_generation`) can be
+   * reclaimed: the first load with the same arguments takes over the old object, instead of loading the asset again.
    */
   template <typename T, typename ... Args> requires(type_traits::loadable<T, Args...>)
   constexpr static t_ref<T> load(Args &&... args) {
-    cache_for<T>().emplace_back(T::load_from(std::forward<Args>(args)...));
-    return last_for<T>();
+    if constexpr (type_traits::shareable<T> && type_traits::keyable<Args...>) {
+      std::string key;
+      (type_traits::append_key(key, args), ...);
+
+      auto &index = index_for<T>();
+      if (const auto it = index.find(key); it != index.end()) {
+        load_hits++;
+        return it->second;
+      }
+
+      load_misses++;
+      const auto ref = load_uncached<T>(std::forward<Args>(args)...);
+      index.emplace(std::move(key), ref);
+      return ref;
+    }
+    else if constexpr (type_traits::keyable<Args...>) {
+      std::string key;
+      (type_traits::append_key(key, args), ...);
+
+      auto &[current, previous] = generations_for<T>();
+      for (auto [it, end] = previous.equal_range(key); it != end; it = previous.erase(it)) {
+        if (!contains(it->second)) continue; // destroyed since, so it can't be reclaimed (and is forgotten)
+        load_hits++;
+        const auto ref = it->second;
+        previous.erase(it);
+        current.emplace(std::move(key), ref);
+        return ref;
+      }
+
+      load_misses++;
+      const auto ref = load_uncached<T>(std::forward<Args>(args)...);
+      current.emplace(std::move(key), ref);
+      return ref;
+    }
+    else {
+      return load_uncached<T>(std::forward<Args>(args)...);
+    }
+  }
+
+  /**
+   * @brief Starts a new load generation (for reloading a map).
+   *
+   * All non-shareable objects (colliders) loaded so far become reclaimable by the next loads with the same arguments.
+   * Objects from the previous generation which weren't reclaimed are no longer part of the map, and are destroyed
+   * (unless a live renderable still uses them).
+   */
+  static void begin_generation() {
+    next_generation<collider>(used_colliders<renderable>());
+    next_generation<instanced_collider>(used_colliders<instanced_renderable>());
+  }
+
+  /**
+   * @brief Uploads all objects that are still being loaded in the background.
+   *
+   * This blocks until all pending decoding jobs are finished, and should be called on the GL thread.
+   */
+  static void flush() {
+    constexpr auto all = std::numeric_limits<size_t>::max();
+    flush_until<render_object>(all);
+    flush_until<instanced_object>(all);
+    flush_until<shader>(all);
+    flush_until<texture>(all);
+    flush_until<collider>(all);
+    flush_until<instanced_collider>(all);
   }
 
+  /**
+   * @brief Frees the GPU memory of the assets which aren't used by any live (instanced) renderable.
+   * @return The amount of evicted assets.
+   *
+   * Objects, instanced objects, textures, and (instanced) colliders are considered; shaders are small, and are never
+   * evicted. Evicted assets are destroyed and removed from the deduplication index (or the load generations, for
+   * colliders), so loading them again decodes and uploads them anew. Their slots are freed, so references to them
+   * become stale (see `contains`).
+   */
+  static size_t evict_unused();
+
   /**
    * @brief Duplicate a renderable in the cache.
    * @param ref The reference to the renderable to duplicate.
@@ -273,6 +473,20 @@ public:
     }
   }
 
+  /**
+   * @brief Gets the amount of load hits and misses so far (see `load`).
+   * @return A pair (hits, misses).
+   */
+  static std::pair<size_t, size_t> load_stats() { return {load_hits, load_misses}; }
+
+  /**
+   * @brief Gets the amount of slots used for a type (live, free, and retired; see `slot_map::slot_count`).
+   * @tparam T The type of object.
+   * @return The amount of slots.
+   */
+  template <typename T>
+  static size_t slot_count() { return cache_for<T>().slot_count(); }
+
   /**
    * @brief Checks whether we should render the colliders.
    * @return Whether we should render the colliders.
@@ -281,7 +495,7 @@ public:
 
 private:
   template <typename T>
-  static constexpr std::vector<T> &cache_for() {
+  static constexpr slot_map<T> &cache_for() {
     if constexpr(type_traits::cvr_same<T, render_object>) return objects;
     else if constexpr(type_traits::cvr_same<T, instanced_object>) return instanced_objects;
     else if constexpr(type_traits::cvr_same<T, shader>) return shaders;
@@ -297,23 +511,139 @@ private:
     }
   }
 
+  /**
+   * @brief Loads a value into the cache, without looking for an earlier load of the same asset.
+   */
+  template <typename T, typename ... Args>
+  static t_ref<T> load_uncached(Args &&... args) {
+    if constexpr (type_traits::decodable<T, Args...>) {
+      const auto key = cache_for<T>().reserve(); // filled in by `flush_until`
+      pending_for<T>().emplace_back(key, worker_pool::shared().submit(
+        [...owned = type_traits::owned_arg<std::decay_t<Args>>::make(args)] { return T::decode(owned...); }
+      ));
+      return t_ref<T>{key};
+    }
+    else {
+      return t_ref<T>{cache_for<T>().emplace(T::load_from(std::forward<Args>(args)...))};
+    }
+  }
+
+  template <typename T>
+  static std::unordered_map<std::string, t_ref<T>> &index_for() {
+    static std::unordered_map<std::string, t_ref<T>> index{};
+    return index;
+  }
+
+  /**
+   * @brief Structure holding the keys of the non-shareable objects loaded in the current and the previous generation.
+   */
+  template <typename T>
+  struct generations {
+    std::unordered_multimap<std::string, t_ref<T>> current; //!< The objects loaded in the current generation.
+    std::unordered_multimap<std::string, t_ref<T>> previous; //!< The objects from the previous generation, not yet reclaimed.
+  };
+
+  template <typename T>
+  static generations<T> &generations_for() {
+    static generations<T> gens{};
+    return gens;
+  }
+
   template <typename T>
-  static constexpr t_ref<T> last_for() {
-    return t_ref<T>{cache_for<T>().size() - 1};
+  static void next_generation(const std::unordered_set<size_t> &used) {
+    flush_until<T>(std::numeric_limits<size_t>::max());
+    auto &[current, previous] = generations_for<T>();
+    for (const auto &ref : previous | std::views::values) {
+      if (!used.contains(ref.raw())) cache_for<T>().erase(ref.idx);
+    }
+    previous = std::move(current);
+    current.clear();
+  }
+
+  /**
+   * @brief Gets the decoding jobs of a type, each with the key to the slot reserved for the result.
+   */
+  template <typename T>
+  static std::deque<std::pair<size_t, std::future<typename T::decoded>>> &pending_for() {
+    static std::deque<std::pair<size_t, std::future<typename T::decoded>>> pending{};
+    return pending;
+  }
+
+  /**
+   * @brief Uploads pending objects of a type (in order), until the object with the given key is available.
+   */
+  template <typename T>
+  static void flush_until(const size_t key) {
+    if constexpr (requires { typename T::decoded; }) {
+      auto &cache = cache_for<T>();
+      auto &pending = pending_for<T>();
+      while (!pending.empty() && !cache.contains(key)) {
+        auto &[slot, job] = pending.front();
+        cache.fill(slot, T::from_decoded(job.get()));
+        pending.pop_front();
+      }
+    }
+  }
+
+  /**
+   * @brief Evicts the assets of a type which are in the deduplication index, but not in the given set.
+   */
+  template <typename T>
+  static size_t evict_from(const std::unordered_set<size_t> &used) {
+    flush_until<T>(std::numeric_limits<size_t>::max());
+    return std::erase_if(index_for<T>(), [&used](const auto &entry) {
+      if (used.contains(entry.second.idx)) return false;
+      cache_for<T>().erase(entry.second.idx);
+      return true;
+    });
+  }
+
+  /**
+   * @brief Collects the (raw references to the) colliders used by the live renderables of a type.
+   */
+  template <typename R>
+  static std::unordered_set<size_t> used_colliders() {
+    std::unordered_set<size_t> used;
+    for (const auto [_, r] : cache_for<R>()) {
+      if (r.coll.has_value()) used.insert(r.coll->raw());
+    }
+    return used;
+  }
+
+  /**
+   * @brief Evicts the colliders of a type which are not in the given set, and forgets their load keys.
+   */
+  template <typename T>
+  static size_t evict_colliders(const std::unordered_set<size_t> &used) {
+    flush_until<T>(std::numeric_limits<size_t>::max());
+    auto &cache = cache_for<T>();
+    std::vector<size_t> dying;
+    for (const auto [key, _] : cache) {
+      if (!used.contains(key)) dying.push_back(key);
+    }
+    for (const size_t key : dying) cache.erase(key);
+
+    auto &[current, previous] = generations_for<T>();
+    const auto stale = [&cache](const auto &entry) { return !cache.contains(entry.second.idx); };
+    std::erase_if(current, stale);
+    std::erase_if(previous, stale);
+    return dying.size();
   }
 
   static inline std::optional<shader_ref> collider_shader{}; //!< The shader to render the colliders with, if any.
   static inline std::optional<shader_ref> collider_instanced_shader{}; //!< The instanced shader to render the colliders with, if any.
-  static inline std::vector<render_object> objects{}; //!< The list of objects in the cache.
-  static inline std::vector<instanced_object> instanced_objects{}; //!< The list of instanced objects in the cache.
-  static inline std::vector<voxel_group> voxels{}; //!< The list of voxel groups in the cache.
-  static inline std::vector<shader> shaders{}; //!< The list of shaders in the cache.
-  static inline std::vector<texture> textures{}; //!< The list of textures in the cache.
-  static inline std::vector<renderable> renderables{}; //!< The list of renderables in the cache.
-  static inline std::vector<instanced_renderable> instanced_renderables{}; //!< The list of instanced renderables in the cache.
-  static inline std::vector<collider> colliders{}; //!< The list of colliders in the cache.
-  static inline std::vector<instanced_collider> instanced_colliders{}; //!< The list of instanced colliders in the cache.
+  static inline slot_map<render_object> objects{}; //!< The objects in the cache.
+  static inline slot_map<instanced_object> instanced_objects{}; //!< The instanced objects in the cache.
+  static inline slot_map<voxel_group> voxels{}; //!< The voxel groups in the cache.
+  static inline slot_map<shader> shaders{}; //!< The shaders in the cache.
+  static inline slot_map<texture> textures{}; //!< The textures in the cache.
+  static inline slot_map<renderable> renderables{}; //!< The renderables in the cache.
+  static inline slot_map<instanced_renderable> instanced_renderables{}; //!< The instanced renderables in the cache.
+  static inline slot_map<collider> colliders{}; //!< The colliders in the cache.
+  static inline slot_map<instanced_collider> instanced_colliders{}; //!< The instanced colliders in the cache.
   static inline bool render_colliders = false; //!< Whether to render the colliders.
+  static inline size_t load_hits = 0; //!< The amount of loads that were served by an earlier load of the same asset.
+  static inline size_t load_misses = 0; //!< The amount of (deduplicated) loads that actually loaded an asset.
 };
 
 /**
@@ -14,6 +14,7 @@
 #include "gizmos.hpp"
 #include "glm_wrapper.hpp"
 #include "log_view.hpp"
+#include "transform.hpp"
 
 namespace openvtt::renderer {
 struct renderable;
@@ -60,8 +61,8 @@ struct uniforms {
  * A renderable is an object, together with its shader and textures, that can be drawn to the screen. It also features
  * a rudimentary transform (position, rotation (using yaw-pitch-roll), and scale), and a name.
  *
- * Each of the fields in this struct can be edited at will. Use the `draw` function to draw the renderable to the
- * screen.
+ * Each of the fields in this struct can be edited at will; the transform is changed through its setters, so its
+ * matrices are only recomputed when needed. Use the `draw` function to draw the renderable to the screen.
  */
 struct renderable {
   /**
@@ -94,18 +95,13 @@ struct renderable {
       model_inv_t_loc{uniforms.model_inv_t} {}
 
   /**
-   * @brief Computes the model matrix for the renderable.
-   * @return The model matrix for the renderable.
+   * @brief Gets the model matrix for the renderable.
+   * @return The model matrix for the renderable (see `transform::world`).
    *
-   * The transform of the object is applied in the following order:
-   * 1. Rotate around the Y-axis (yaw).
-   * 2. Rotate around the X-axis (pitch).
-   * 3. Rotate around the Z-axis (roll).
-   * 4. Scale.
-   * 5. Translate.
+   * The matrix is cached, and only recomputed when the transform changes.
    */
-  [[nodiscard]] inline glm::mat4 model() const {
-    return glm::mat4(1.0f) | translation(position) | rescale(scale) | roll(rotation.z) | pitch(rotation.x) | yaw(rotation.y);
+  [[nodiscard]] inline const glm::mat4 &model() const {
+    return xform.world();
   }
 
   /**
@@ -138,10 +134,9 @@ struct renderable {
 
     sh->activate();
 
-    const auto m = model();
-    sh->set_mat4(model_loc, m);
+    sh->set_mat4(model_loc, xform.world());
     cam.set_matrices(*sh, view_loc, proj_loc);
-    sh->set_mat3(model_inv_t_loc, glm::mat3(transpose(inverse(m))));
+    sh->set_mat3(model_inv_t_loc, xform.normal());
     f(sh, *this);
     int i = 0;
     for (const auto &[loc, tex] : textures) {
@@ -158,9 +153,7 @@ struct renderable {
 
   bool active = true; //!< Whether the renderable is active (i.e. should be rendered).
   std::string name; //!< The name of the renderable.
-  glm::vec3 position{0,0,0}; //!< The position of the renderable.
-  glm::vec3 rotation{0, 0, 0}; //!< The rotation of the renderable.
-  glm::vec3 scale{1,1,1}; //!< The scale of the renderable.
+  transform xform{}; //!< The position, rotation, and scale of the renderable.
 
   std::optional<collider_ref> coll = std::nullopt; //!< The collider for the renderable, if any.
 
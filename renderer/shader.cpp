@@ -15,13 +15,13 @@
 using namespace openvtt::renderer;
 
 shader::shader(const std::string &vs, const std::string &fs) {
-  window::get(); // force initialized
+  gl_backend::ensure_context();
 
-  const auto v = glCreateShader(GL_VERTEX_SHADER);
+  const auto v = GL_createShader(GL_VERTEX_SHADER);
   const auto *str = vs.c_str();
   GL_shaderSource(v, 1, &str, nullptr);
   GL_compileShader(v);
-  int ok;
+  int ok = GL_TRUE; // stays true on the null backend
   GL_getShaderiv(v, GL_COMPILE_STATUS, &ok);
   if (!ok) {
     int len;
@@ -32,7 +32,7 @@ shader::shader(const std::string &vs, const std::string &fs) {
     delete[] data;
   }
 
-  const auto f = glCreateShader(GL_FRAGMENT_SHADER);
+  const auto f = GL_createShader(GL_FRAGMENT_SHADER);
   str = fs.c_str();
   GL_shaderSource(f, 1, &str, nullptr);
   GL_compileShader(f);
@@ -46,7 +46,7 @@ shader::shader(const std::string &vs, const std::string &fs) {
     delete[] data;
   }
 
-  program = glCreateProgram();
+  program = GL_createProgram();
   GL_attachShader(program, v);
   GL_attachShader(program, f);
   GL_linkProgram(program);
@@ -64,7 +64,7 @@ shader::shader(const std::string &vs, const std::string &fs) {
   GL_deleteShader(f);
 }
 
-shader shader::load_from(const std::string &vsf, const std::string &fsf) {
+shader::decoded shader::decode(const std::string &vsf, const std::string &fsf) {
   auto vs_path = asset_path<asset_type::VERT_SHADER>(vsf);
   log<log_type::DEBUG>("shader", std::format("Loading vertex shader from '{}'", vs_path));
 
@@ -93,7 +93,7 @@ shader shader::load_from(const std::string &vsf, const std::string &fsf) {
     f_src = strm.str();
   }
 
-  return {v_src, f_src};
+  return {std::move(v_src), std::move(f_src)};
 }
 
 void shader::set_bool(const unsigned int loc, const bool b) const {
@@ -136,5 +136,5 @@ shader::~shader() {
 }
 
 unsigned int shader::loc_for(const std::string &name) const {
-  return glGetUniformLocation(program, name.c_str());
+  return GL_getUniformLocation(program, name.c_str());
 }
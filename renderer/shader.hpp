@@ -14,6 +14,14 @@ namespace openvtt::renderer {
  */
 class shader {
 public:
+  /**
+   * @brief Structure holding the (not yet compiled) source code of a shader.
+   */
+  struct decoded {
+    std::string vs; //!< The vertex shader source code.
+    std::string fs; //!< The fragment shader source code.
+  };
+
   /**
    * Creates a shader from the given vertex and fragment shader source code.
    * @param vs The vertex shader source code.
@@ -36,7 +44,25 @@ public:
    *
    * The shader files are resolved using @ref asset_path.
    */
-  static shader load_from(const std::string &vsf, const std::string &fsf);
+  static shader load_from(const std::string &vsf, const std::string &fsf) { return from_decoded(decode(vsf, fsf)); }
+
+  /**
+   * @brief Reads the source code of a shader pair, without touching OpenGL.
+   * @param vsf The path to the vertex shader file.
+   * @param fsf The path to the fragment shader file.
+   * @return The source code (empty if a file could not be read).
+   *
+   * This function is thread-safe, so it can be run on a worker thread (see `render_cache::load`). The shader files are
+   * resolved using @ref asset_path.
+   */
+  static decoded decode(const std::string &vsf, const std::string &fsf);
+
+  /**
+   * @brief Compiles and links a shader from its source code.
+   * @param d The source code.
+   * @return The shader.
+   */
+  static shader from_decoded(decoded &&d) { return {d.vs, d.fs}; }
 
   /**
    * @brief Returns the location of the uniform with the given name.
@@ -0,0 +1,213 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef SLOT_MAP_HPP
+#define SLOT_MAP_HPP
+
+#include <cstdint>
+#include <deque>
+#include <format>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "traced_exception.hpp"
+
+namespace openvtt::renderer {
+/**
+ * @brief A container with stable slots, addressed by generation-checked keys.
+ * @tparam T The type of values to store.
+ *
+ * Each value lives in a slot which never moves, so references to values stay valid until the value itself is erased
+ * (inserting other values doesn't invalidate them). Erasing a value frees its slot for reuse, and bumps the slot's
+ * generation. Keys hold both the slot index and the generation, so a key to an erased value is never mistaken for the
+ * value that reuses its slot.
+ *
+ * Inserting, erasing, and looking up values are all O(1).
+ */
+template <typename T>
+class slot_map {
+public:
+  using key = size_t; //!< A key to a value: the generation in the upper 32 bits, the slot index in the lower 32 bits.
+
+  /**
+   * @brief Structure representing a live value, together with its key (see `begin` and `end`).
+   */
+  struct entry {
+    key k; //!< The key to the value.
+    T &value; //!< The value itself.
+  };
+
+  /**
+   * @brief Structure representing a live value in a constant slot map.
+   */
+  struct const_entry {
+    key k; //!< The key to the value.
+    const T &value; //!< The value itself.
+  };
+
+  /**
+   * @brief An iterator over the live values; empty slots are skipped.
+   */
+  template <bool Const>
+  class iterator_t {
+  public:
+    using slots_t = std::conditional_t<Const, const std::deque<typename slot_map::slot>, std::deque<typename slot_map::slot>>;
+    using value_type = std::conditional_t<Const, typename slot_map::const_entry, entry>;
+    using difference_type = std::ptrdiff_t;
+
+    iterator_t() = default;
+    iterator_t(slots_t *slots, const size_t at) : slots{slots}, at{at} { skip(); }
+
+    value_type operator*() const {
+      auto &s = (*slots)[at];
+      return {make_key(at, s.generation), *s.value};
+    }
+    iterator_t &operator++() { at++; skip(); return *this; }
+    iterator_t operator++(int) { auto cpy = *this; ++*this; return cpy; }
+    bool operator==(const iterator_t &other) const { return at == other.at; }
+
+  private:
+    void skip() { while (at < slots->size() && !(*slots)[at].value.has_value()) at++; }
+
+    slots_t *slots = nullptr;
+    size_t at = 0;
+  };
+
+  using iterator = iterator_t<false>; //!< Iterator type over the live values.
+  using const_iterator = iterator_t<true>; //!< Iterator type over the (constant) live values.
+
+  /**
+   * @brief Constructs a value in a free slot (or a new one, if all slots are taken).
+   * @tparam Args The types of the arguments to pass to the constructor.
+   * @param args The arguments to pass to the constructor.
+   * @return The key to the new value.
+   */
+  template <typename ... Args>
+  key emplace(Args &&... args) {
+    const key k = reserve();
+    fill(k, std::forward<Args>(args)...);
+    return k;
+  }
+
+  /**
+   * @brief Reserves a slot, to be filled later (see `fill`).
+   * @return The key to the (not yet existing) value.
+   *
+   * Until the slot is filled, `contains` returns `false` for the key.
+   */
+  key reserve() {
+    if (!free.empty()) {
+      const uint32_t idx = free.back();
+      free.pop_back();
+      return make_key(idx, slots[idx].generation);
+    }
+    slots.emplace_back();
+    return make_key(slots.size() - 1, 0);
+  }
+
+  /**
+   * @brief Constructs a value in a reserved slot.
+   * @tparam Args The types of the arguments to pass to the constructor.
+   * @param k The key returned by `reserve`.
+   * @param args The arguments to pass to the constructor.
+   * @return A reference to the new value.
+   */
+  template <typename ... Args>
+  T &fill(const key k, Args &&... args) {
+    auto &s = slots[index_of(k)];
+    s.value.emplace(std::forward<Args>(args)...);
+    count++;
+    return *s.value;
+  }
+
+  /**
+   * @brief Erases a value, and frees its slot.
+   * @param k The key to the value.
+   * @return `true` if the value was erased, `false` if the key was stale or invalid (in which case nothing happens).
+   */
+  bool erase(const key k) {
+    if (!contains(k)) return false;
+    const uint32_t idx = index_of(k);
+    auto &s = slots[idx];
+    s.value.reset();
+    count--;
+    // a slot whose generation would wrap around is retired, so its old keys can never become valid again
+    if (++s.generation != 0) free.push_back(idx);
+    return true;
+  }
+
+  /**
+   * @brief Checks whether a key refers to a live value.
+   * @param k The key to check.
+   * @return `true` if the value exists, and hasn't been erased since the key was handed out.
+   */
+  [[nodiscard]] bool contains(const key k) const {
+    const uint32_t idx = index_of(k);
+    return idx < slots.size() && slots[idx].generation == generation_of(k) && slots[idx].value.has_value();
+  }
+
+  /**
+   * @brief Looks up a value.
+   * @param k The key to the value.
+   * @return A pointer to the value, or `nullptr` if the key is stale or invalid.
+   */
+  [[nodiscard]] T *find(const key k) { return contains(k) ? &*slots[index_of(k)].value : nullptr; }
+  /**
+   * @brief Looks up a value (in a constant slot map).
+   * @param k The key to the value.
+   * @return A pointer to the value, or `nullptr` if the key is stale or invalid.
+   */
+  [[nodiscard]] const T *find(const key k) const { return contains(k) ? &*slots[index_of(k)].value : nullptr; }
+
+  /**
+   * @brief Gets a value.
+   * @param k The key to the value.
+   * @return A reference to the value.
+   *
+   * Throws a `traced_exception` if the key is stale or invalid.
+   */
+  T &operator[](const key k) {
+    if (T *v = find(k); v != nullptr) [[likely]] return *v;
+    throw traced_exception(std::format("Stale or invalid key (slot {}, generation {})", index_of(k), generation_of(k)));
+  }
+
+  /**
+   * @brief Gets the amount of live values.
+   * @return The amount of live values.
+   */
+  [[nodiscard]] size_t size() const { return count; }
+  /**
+   * @brief Gets the amount of slots (live, reserved, free, and retired).
+   * @return The amount of slots.
+   */
+  [[nodiscard]] size_t slot_count() const { return slots.size(); }
+
+  iterator begin() { return {&slots, 0}; } //!< Gets an iterator to the first live value.
+  iterator end() { return {&slots, slots.size()}; } //!< Gets an iterator past the last slot.
+  const_iterator begin() const { return {&slots, 0}; } //!< Gets an iterator to the first live value.
+  const_iterator end() const { return {&slots, slots.size()}; } //!< Gets an iterator past the last slot.
+
+private:
+  /**
+   * @brief Structure representing a single slot.
+   */
+  struct slot {
+    std::optional<T> value{}; //!< The value in the slot, if any.
+    uint32_t generation = 0; //!< The amount of times a value in this slot has been erased.
+  };
+
+  static constexpr key make_key(const size_t idx, const uint32_t generation) {
+    return static_cast<key>(generation) << 32 | static_cast<uint32_t>(idx);
+  }
+  static constexpr uint32_t index_of(const key k) { return static_cast<uint32_t>(k); }
+  static constexpr uint32_t generation_of(const key k) { return static_cast<uint32_t>(k >> 32); }
+
+  std::deque<slot> slots{}; //!< The slots; a deque never moves its elements when growing.
+  std::vector<uint32_t> free{}; //!< The indices of the free slots.
+  size_t count = 0; //!< The amount of live values.
+};
+}
+
+#endif //SLOT_MAP_HPP
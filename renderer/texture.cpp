@@ -10,28 +10,35 @@
 
 using namespace openvtt::renderer;
 
-texture::texture(const std::string &asset) {
+texture::texture(const std::string &asset) : texture{load_from(asset)} {}
+
+texture::decoded texture::decode(const std::string &asset) {
   log<log_type::DEBUG>("texture", std::format("Loading texture '{}'", asset));
 
-  const std::string path = asset_path<asset_type::TEXTURE_PNG>(asset);
-  int w, h, c;
-  unsigned char *data = stbi_load(path.c_str(), &w, &h, &c, 4);
-  if (!data) {
-    log<log_type::ERROR>("texture", std::format("Failed to load texture '{}'", path));
-    return;
+  decoded res{.path = asset_path<asset_type::TEXTURE_PNG>(asset)};
+  int c;
+  res.pixels = {stbi_load(res.path.c_str(), &res.width, &res.height, &c, 4), stbi_image_free};
+  if (!res.pixels) {
+    log<log_type::ERROR>("texture", std::format("Failed to load texture '{}'", res.path));
   }
+  return res;
+}
 
+texture texture::from_decoded(decoded &&d) {
+  texture res;
+  if (!d.pixels) return res;
+
+  auto &id = res.id;
   GL_genTextures(1, &id);
   GL_bindTexture(GL_TEXTURE_2D, id);
   GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
   GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
   GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
   GL_texParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-  GL_texImage2D(GL_TEXTURE_2D, 0, GL_RGBA, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+  GL_texImage2D(GL_TEXTURE_2D, 0, GL_RGBA, d.width, d.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, d.pixels.get());
   GL_generateMipmap(GL_TEXTURE_2D);
   GL_bindTexture(GL_TEXTURE_2D, 0);
-
-  stbi_image_free(data);
+  return res;
 }
 
 void texture::bind(const unsigned int slot) const {
@@ -6,6 +6,7 @@
 #define TEXTURE_HPP
 
 #include <string>
+#include <memory>
 
 namespace openvtt::renderer {
 /**
@@ -13,6 +14,16 @@ namespace openvtt::renderer {
  */
 class texture {
 public:
+  /**
+   * @brief Structure holding a decoded (but not yet uploaded) texture.
+   */
+  struct decoded {
+    std::string path; //!< The path of the texture file (for error messages).
+    int width = 0; //!< The width of the texture (in pixels).
+    int height = 0; //!< The height of the texture (in pixels).
+    std::unique_ptr<unsigned char, void (*)(void *)> pixels{nullptr, nullptr}; //!< The RGBA pixel data, or `nullptr` if decoding failed.
+  };
+
   /**
    * @brief Creates a texture from an asset.
    * @param asset The path to the asset.
@@ -27,6 +38,29 @@ public:
   texture &operator=(const texture &other) = delete;
   texture &operator=(texture &&other) = delete;
 
+  /**
+   * @brief Decodes a texture from an asset, without touching OpenGL.
+   * @param asset The path to the asset.
+   * @return The decoded texture.
+   *
+   * This function is thread-safe, so it can be run on a worker thread (see `render_cache::load`).
+   */
+  static decoded decode(const std::string &asset);
+
+  /**
+   * @brief Uploads a decoded texture to the GPU.
+   * @param d The decoded texture.
+   * @return The texture (with ID 0 if decoding failed).
+   */
+  static texture from_decoded(decoded &&d);
+
+  /**
+   * @brief Loads a texture from an asset (decoding and uploading it in one go).
+   * @param asset The path to the asset.
+   * @return The texture.
+   */
+  static texture load_from(const std::string &asset) { return from_decoded(decode(asset)); }
+
   /**
    * @brief Binds the texture to a slot.
    * @param slot The slot to bind the texture to.
@@ -38,6 +72,7 @@ public:
 
   ~texture();
 private:
+  texture() = default;
   unsigned int id = 0; ///< The OpenGL ID of the texture.
 };
 }
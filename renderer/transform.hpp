@@ -0,0 +1,107 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef TRANSFORM_HPP
+#define TRANSFORM_HPP
+
+#include <glm/glm.hpp>
+
+#include "glm_wrapper.hpp"
+
+namespace openvtt::renderer {
+/**
+ * @brief A transform (position, rotation (using yaw-pitch-roll), and scale), with cached matrices.
+ *
+ * The world (model) matrix and its inverse-transpose (the normal matrix) are only recomputed when they are requested
+ * after the transform changed, so objects which don't move cost no matrix math.
+ */
+class transform {
+public:
+  /**
+   * @brief Gets the position.
+   * @return The position.
+   */
+  [[nodiscard]] const glm::vec3 &position() const { return pos; }
+  /**
+   * @brief Gets the rotation (in degrees: pitch around X, yaw around Y, roll around Z).
+   * @return The rotation.
+   */
+  [[nodiscard]] const glm::vec3 &rotation() const { return rot; }
+  /**
+   * @brief Gets the scale.
+   * @return The scale.
+   */
+  [[nodiscard]] const glm::vec3 &scale() const { return scl; }
+
+  /**
+   * @brief Sets the position.
+   * @param p The new position.
+   */
+  void set_position(const glm::vec3 &p) { pos = p; dirty = true; }
+  /**
+   * @brief Sets the rotation.
+   * @param r The new rotation (in degrees).
+   */
+  void set_rotation(const glm::vec3 &r) { rot = r; dirty = true; }
+  /**
+   * @brief Sets the scale.
+   * @param s The new scale.
+   */
+  void set_scale(const glm::vec3 &s) { scl = s; dirty = true; }
+  /**
+   * @brief Sets the position, rotation, and scale at once.
+   * @param p The new position.
+   * @param r The new rotation (in degrees).
+   * @param s The new scale.
+   */
+  void set(const glm::vec3 &p, const glm::vec3 &r, const glm::vec3 &s) {
+    pos = p; rot = r; scl = s;
+    dirty = true;
+  }
+
+  /**
+   * @brief Gets the world (model) matrix.
+   * @return The world matrix.
+   *
+   * The transform is applied in the following order:
+   * 1. Rotate around the Y-axis (yaw).
+   * 2. Rotate around the X-axis (pitch).
+   * 3. Rotate around the Z-axis (roll).
+   * 4. Scale.
+   * 5. Translate.
+   */
+  [[nodiscard]] const glm::mat4 &world() const {
+    if (dirty) update();
+    return world_m;
+  }
+
+  /**
+   * @brief Gets the inverse-transpose of the upper 3x3 part of the world matrix (to transform normals).
+   * @return The normal matrix.
+   */
+  [[nodiscard]] const glm::mat3 &normal() const {
+    if (dirty) update();
+    return normal_m;
+  }
+
+private:
+  void update() const {
+    world_m = glm::mat4(1.0f) | translation(pos) | rescale(scl) | roll(rot.z) | pitch(rot.x) | yaw(rot.y);
+    // the upper 3x3 part is S * R, so its inverse-transpose is S^-1 * R: row i of the world matrix, divided by scale_i^2
+    const glm::vec3 inv_sq = 1.0f / (scl * scl);
+    for (int col = 0; col < 3; col++) normal_m[col] = glm::vec3(world_m[col]) * inv_sq;
+    dirty = false;
+  }
+
+  glm::vec3 pos{0, 0, 0}; //!< The position.
+  glm::vec3 rot{0, 0, 0}; //!< The rotation (in degrees).
+  glm::vec3 scl{1, 1, 1}; //!< The scale.
+
+  mutable glm::mat4 world_m{1.0f}; //!< The cached world matrix.
+  mutable glm::mat3 normal_m{1.0f}; //!< The cached normal matrix.
+  mutable bool dirty = false; //!< Whether the cached matrices are out of date.
+};
+}
+
+#endif //TRANSFORM_HPP
@@ -22,6 +22,10 @@ window &window::get() {
   return w;
 }
 
+void gl_backend::ensure_context() {
+  if (!null) window::get();
+}
+
 window::window() {
   log<log_type::DEBUG>("window", "Initializing GLFW/GLAD/ImGUI");
   if (!glfwInit()) {
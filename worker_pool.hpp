@@ -0,0 +1,113 @@
+//
+// Created by jay on 10/16/26.
+//
+
+#ifndef WORKER_POOL_HPP
+#define WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace openvtt {
+/**
+ * @brief A fixed-size pool of worker threads executing submitted jobs in FIFO order.
+ *
+ * Jobs should not touch the OpenGL context (which is only current on the main thread); they are meant for CPU-bound
+ * work such as decoding assets. Destroying the pool finishes all queued jobs before joining the workers.
+ */
+class worker_pool {
+public:
+  /**
+   * @brief Creates a new pool.
+   * @param threads The amount of worker threads (at least one).
+   */
+  explicit worker_pool(const size_t threads = default_threads()) {
+    workers.reserve(std::max<size_t>(threads, 1));
+    for (size_t i = 0; i < std::max<size_t>(threads, 1); i++) {
+      workers.emplace_back([this] { work(); });
+    }
+  }
+
+  worker_pool(const worker_pool &) = delete;
+  worker_pool(worker_pool &&) = delete;
+  worker_pool &operator=(const worker_pool &) = delete;
+  worker_pool &operator=(worker_pool &&) = delete;
+
+  /**
+   * @brief Submits a job to the pool.
+   * @tparam F The type of the job (with signature `() -> R`).
+   * @param f The job.
+   * @return A future for the result of the job (exceptions are propagated through the future).
+   */
+  template <std::invocable<> F>
+  auto submit(F &&f) -> std::future<std::invoke_result_t<F>> {
+    using res_t = std::invoke_result_t<F>;
+    auto task = std::make_shared<std::packaged_task<res_t()>>(std::forward<F>(f));
+    auto fut = task->get_future();
+    {
+      std::scoped_lock guard{lock};
+      jobs.emplace_back([task] { (*task)(); });
+    }
+    wake.notify_one();
+    return fut;
+  }
+
+  /**
+   * @brief Gets the amount of worker threads.
+   * @return The amount of worker threads.
+   */
+  [[nodiscard]] size_t size() const { return workers.size(); }
+
+  /**
+   * @brief Gets the shared pool (for asset decoding and other background work).
+   * @return The shared pool.
+   */
+  static worker_pool &shared() {
+    static worker_pool pool;
+    return pool;
+  }
+
+  ~worker_pool() {
+    {
+      std::scoped_lock guard{lock};
+      stopping = true;
+    }
+    wake.notify_all();
+    for (auto &w : workers) w.join();
+  }
+
+private:
+  static size_t default_threads() {
+    const size_t hw = std::thread::hardware_concurrency();
+    return hw > 1 ? hw - 1 : 1; // leave a core for the main (GL) thread
+  }
+
+  void work() {
+    while (true) {
+      std::function<void()> job;
+      {
+        std::unique_lock guard{lock};
+        wake.wait(guard, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty()) return; // stopping, and nothing left to do
+        job = std::move(jobs.front());
+        jobs.pop_front();
+      }
+      job();
+    }
+  }
+
+  std::mutex lock;
+  std::condition_variable wake;
+  std::deque<std::function<void()>> jobs;
+  std::vector<std::thread> workers;
+  bool stopping = false;
+};
+}
+
+#endif //WORKER_POOL_HPP